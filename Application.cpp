@@ -13,21 +13,45 @@
 #include "gift.h"
 #include "bushes.h"
 #include "DrawableObject.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "SceneGenerator.h"
+#include "SceneFile.h"
+#include "Picking.h"
+#include "SoftwareRasterizer.h"
 
 Application* Application::instance = nullptr;
 
-Application::Application() : mainWindow(nullptr), camera(nullptr), controller(nullptr), currentSceneIndex(0), deltaTime(0.0f), lastFrameTime(0.0) {
+Application::Application() : mainWindow(nullptr), sceneLoader(resources), currentSceneIndex(0), camera(nullptr), controller(nullptr), pendingInputTimestamp(0.0), deltaTime(0.0f), lastFrameTime(0.0), mainLight(nullptr), shadowMap(nullptr), depthPrepass(nullptr), dynamicResolution(nullptr), impostors(nullptr), frameCapture(nullptr), captureFps(60), materialTable(nullptr),
+    jobSystem(nullptr), jobThreads(0), shadowsEnabled(true), depthPrepassMode(PREPASS_AUTO), overdrawView(false),
+    resolutionTargetMs(0.0), resolutionMinScale(0.5f), resolutionMaxScale(1.0f), impostorDistance(20.0f), impostorsEnabled(true), lastStatsReport(0.0),
+    drawListsEnabled(true), recordedSceneId(0), recordedChangeRevision(0), worldStreamer(nullptr), streamedSceneIndex(-1), multiViewCount(0), benchmarkSettings(nullptr), framesInFlight(2), frameIndex(0), viewportWidth(800), viewportHeight(600),
+    onDemandRendering(true), redrawRequested(true), drawnSceneIndex(-1), drawnCameraRevision(0), drawnLightRevision(0),
+    drawnSceneRevision(0), drawnChangeRevision(0), renderedFrames(0), idleWaits(0) {
     instance = this;
 }
 
 Application::~Application() {
-    for (auto shader : shaderPrograms) delete shader;
-    for (auto model : modelList) delete model;
-    for (auto scene : scenes) delete scene;
+    // Generátory dlaždic se zastaví dřív, než zaniknou modely
+    if (worldStreamer) delete worldStreamer;
+
+    // Scény, modely a shadery - ještě s platným GL kontextem
+    sceneLoader.clear();
+    resources.clear();
 
     if (camera) delete camera;
     if (controller) delete controller;
     if (mainLight) delete mainLight;
+    if (shadowMap) delete shadowMap;
+    if (depthPrepass) delete depthPrepass;
+    if (dynamicResolution) delete dynamicResolution;
+    if (impostors) delete impostors;
+    // Dopíše frontu snímků (PBO už uvolnil finish() na konci run)
+    if (frameCapture) delete frameCapture;
+    if (materialTable) delete materialTable;
+    if (jobSystem) delete jobSystem;
+    if (benchmarkSettings) delete benchmarkSettings;
+    RenderStats::closeCsv();
 
     if (mainWindow) {
         glfwDestroyWindow(mainWindow);
@@ -38,6 +62,14 @@ Application::~Application() {
 void Application::initialization() {
     glfwSetErrorCallback(error_callback);
 
+    bool headless = benchmarkSettings != nullptr;
+#ifdef GLFW_PLATFORM_NULL
+    // GLFW 3.4+: null platforma nepotřebuje displej (OSMesa / EGL surfaceless)
+    if (headless && benchmarkSettings->contextApi != "native") {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
+#endif
+
     if (!glfwInit()) {
         fprintf(stderr, "Can not start GLFW3\n");
         exit(EXIT_FAILURE);
@@ -48,14 +80,29 @@ void Application::initialization() {
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    mainWindow = glfwCreateWindow(800, 600, "OpenGL Application", NULL, NULL);
+    int windowWidth = 800;
+    int windowHeight = 600;
+    if (headless) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        if (benchmarkSettings->contextApi == "osmesa") {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        }
+        else if (benchmarkSettings->contextApi == "egl") {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        }
+        windowWidth = benchmarkSettings->width;
+        windowHeight = benchmarkSettings->height;
+    }
+
+    mainWindow = glfwCreateWindow(windowWidth, windowHeight, "OpenGL Application", NULL, NULL);
     if (!mainWindow) {
+        fprintf(stderr, "Can not create window/context\n");
         glfwTerminate();
         exit(EXIT_FAILURE);
     }
 
     glfwMakeContextCurrent(mainWindow);
-    glfwSwapInterval(1);
+    glfwSwapInterval(headless ? 0 : 1);
 
     // Set callbacks
     glfwSetKeyCallback(mainWindow, key_callback);
@@ -64,6 +111,7 @@ void Application::initialization() {
     glfwSetWindowFocusCallback(mainWindow, window_focus_callback);
     glfwSetWindowIconifyCallback(mainWindow, window_iconify_callback);
     glfwSetWindowSizeCallback(mainWindow, window_size_callback);
+    glfwSetWindowRefreshCallback(mainWindow, window_refresh_callback);
 
     glewExperimental = GL_TRUE;
     glewInit();
@@ -77,24 +125,39 @@ void Application::initialization() {
     int width, height;
     glfwGetFramebufferSize(mainWindow, &width, &height);
     glViewport(0, 0, width, height);
+    viewportWidth = width;
+    viewportHeight = height;
     glEnable(GL_DEPTH_TEST); // Pro 3D objekty
 
     // Vytvoření kamery a controlleru
     camera = new Camera();
     controller = new Controller(camera);
     camera->setProjectionMatrix(static_cast<float>(width), static_cast<float>(height));
+    if (multiViewCount > 1) {
+        setupMultiView();
+    }
 
     lastFrameTime = glfwGetTime();
 
     mainLight = new Light(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f));
 
+    // Hlavní vlákno je worker 0 a zapojuje se do práce
+    jobSystem = new JobSystem(jobThreads > 0 ? jobThreads - 1 : JobSystem::getDefaultWorkerCount());
+    printf("Job system: %d threads\n", jobSystem->getThreadCount());
+
     printf("Camera initialized\n");
     printf("Camera initialized\n");
     printf("Controls: WSAD = movement, Right Mouse Button + Move = look around\n");
-    printf("Keys 1-7: Switch scenes, F1-F4 a G: Switch shaders\n");
+    printf("Keys 1-7: Switch scenes, F1-F4 a G: Switch shaders, K: Toggle shadows, L: Toggle draw lists\n");
 }
 
 void Application::createShaders() {
+    // Tabulka materiálů - shadery si blok Materials připojí při linkování
+    materialTable = new MaterialTable();
+    if (!materialTable->initialize()) {
+        printf("Material table initialization failed\n");
+    }
+
     ShaderProgram* originalShader = new ShaderProgram();
     ShaderProgram* constantShader = new ShaderProgram();
     ShaderProgram* lambertShader = new ShaderProgram();
@@ -106,12 +169,11 @@ void Application::createShaders() {
         "#version 330 core\n"
         "layout(location=0) in vec3 vp;"
         "layout(location=1) in vec3 color;"
-        "uniform mat4 modelMatrix;"
-        "uniform mat4 viewMatrix;"
-        "uniform mat4 projectionMatrix;"
+        "uniform mat4 mvpMatrix;"
         "out vec3 vertexColor;"
+        "invariant gl_Position;"
         "void main() {"
-        "    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vp, 1.0);"
+        "    gl_Position = mvpMatrix * vec4(vp, 1.0);"
         "    vertexColor = color;"
         "}";
 
@@ -123,7 +185,7 @@ void Application::createShaders() {
 
     originalShader->loadMainShader(original_vertex_shader, original_fragment_shader);
     originalShader->setCamera(camera);
-    addShader(originalShader);
+    addShader("original", originalShader);
 
     // F2: CONSTANT SHADER
     if (!constantShader->loadShaderFromFiles("phong.vert", "constant.frag")) {
@@ -134,15 +196,16 @@ void Application::createShaders() {
             "layout(location=0) in vec3 vp;"
             "layout(location=1) in vec3 vn;"
             "uniform mat4 modelMatrix;"
-            "uniform mat4 viewMatrix;"
-            "uniform mat4 projectionMatrix;"
+            "uniform mat4 mvpMatrix;"
+            "uniform mat3 normalMatrix;"
             "out vec3 worldPosition;"
             "out vec3 worldNormal;"
+            "invariant gl_Position;"
             "void main() {"
             "    vec4 wp = modelMatrix * vec4(vp, 1.0);"
             "    worldPosition = wp.xyz;"
-            "    worldNormal = mat3(transpose(inverse(modelMatrix))) * vn;"
-            "    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vp, 1.0);"
+            "    worldNormal = normalMatrix * vn;"
+            "    gl_Position = mvpMatrix * vec4(vp, 1.0);"
             "}";
 
         const char* fragment_shader =
@@ -150,12 +213,12 @@ void Application::createShaders() {
             "in vec3 worldPosition;"
             "in vec3 worldNormal;"
             "out vec4 fragColor;"
-            "void main() { fragColor = vec4(0.385, 0.647, 0.812, 1.0); }";
+            "void main() { fragColor = materials[materialIndex].diffuse; }";
 
-        constantShader->loadMainShader(vertex_shader, fragment_shader);
+        constantShader->loadMainShader(vertex_shader, fragment_shader, true);
     }
     constantShader->setCamera(camera);
-    addShader(constantShader);
+    addShader("constant", constantShader);
 
     // F3: LAMBERT SHADER
     if (!lambertShader->loadShaderFromFiles("phong.vert", "lambert.frag")) {
@@ -165,15 +228,16 @@ void Application::createShaders() {
             "layout(location=0) in vec3 vp;"
             "layout(location=1) in vec3 vn;"
             "uniform mat4 modelMatrix;"
-            "uniform mat4 viewMatrix;"
-            "uniform mat4 projectionMatrix;"
+            "uniform mat4 mvpMatrix;"
+            "uniform mat3 normalMatrix;"
             "out vec3 worldPosition;"
             "out vec3 worldNormal;"
+            "invariant gl_Position;"
             "void main() {"
             "    vec4 wp = modelMatrix * vec4(vp, 1.0);"
             "    worldPosition = wp.xyz;"
-            "    worldNormal = mat3(transpose(inverse(modelMatrix))) * vn;"
-            "    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vp, 1.0);"
+            "    worldNormal = normalMatrix * vn;"
+            "    gl_Position = mvpMatrix * vec4(vp, 1.0);"
             "}";
 
         const char* fragment_shader =
@@ -183,8 +247,9 @@ void Application::createShaders() {
             "uniform vec3 lightPosition;"
             "out vec4 fragColor;"
             "void main() {"
-            "    vec4 objectColor = vec4(0.385, 0.647, 0.812, 1.0);"
-            "    vec4 ambient = vec4(0.1, 0.1, 0.1, 1.0);"
+            "    Material material = materials[materialIndex];"
+            "    vec4 objectColor = material.diffuse;"
+            "    vec4 ambient = material.ambient;"
             "    vec3 norm = normalize(worldNormal);"
             "    vec3 lightDir = normalize(lightPosition - worldPosition);"
             "    float diff = max(dot(norm, lightDir), 0.0);"
@@ -192,10 +257,10 @@ void Application::createShaders() {
             "    fragColor = ambient + diffuse;"
             "}";
 
-        lambertShader->loadMainShader(vertex_shader, fragment_shader);
+        lambertShader->loadMainShader(vertex_shader, fragment_shader, true);
     }
     lambertShader->setCamera(camera);
-    addShader(lambertShader);
+    addShader("lambert", lambertShader);
 
     // F4: PHONG SHADER
     if (!phongShader->loadShaderFromFiles("phong.vert", "phong.frag")) {
@@ -205,15 +270,16 @@ void Application::createShaders() {
             "layout(location=0) in vec3 vp;"
             "layout(location=1) in vec3 vn;"
             "uniform mat4 modelMatrix;"
-            "uniform mat4 viewMatrix;"
-            "uniform mat4 projectionMatrix;"
+            "uniform mat4 mvpMatrix;"
+            "uniform mat3 normalMatrix;"
             "out vec3 worldPosition;"
             "out vec3 worldNormal;"
+            "invariant gl_Position;"
             "void main() {"
             "    vec4 wp = modelMatrix * vec4(vp, 1.0);"
             "    worldPosition = wp.xyz;"
-            "    worldNormal = mat3(transpose(inverse(modelMatrix))) * vn;"
-            "    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vp, 1.0);"
+            "    worldNormal = normalMatrix * vn;"
+            "    gl_Position = mvpMatrix * vec4(vp, 1.0);"
             "}";
 
         const char* fragment_shader =
@@ -224,23 +290,24 @@ void Application::createShaders() {
             "uniform vec3 cameraPosition;"
             "out vec4 fragColor;"
             "void main() {"
-            "    vec4 objectColor = vec4(0.385, 0.647, 0.812, 1.0);"
-            "    vec4 ambient = vec4(0.1, 0.1, 0.1, 1.0);"
+            "    Material material = materials[materialIndex];"
+            "    vec4 objectColor = material.diffuse;"
+            "    vec4 ambient = material.ambient;"
             "    vec3 norm = normalize(worldNormal);"
             "    vec3 lightDir = normalize(lightPosition - worldPosition);"
             "    float diff = max(dot(norm, lightDir), 0.0);"
             "    vec4 diffuse = diff * objectColor;"
             "    vec3 viewDir = normalize(cameraPosition - worldPosition);"
             "    vec3 reflectDir = reflect(-lightDir, norm);"
-            "    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);"
-            "    vec4 specular = spec * vec4(1.0, 1.0, 1.0, 1.0);"
+            "    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.specular.w);"
+            "    vec4 specular = spec * vec4(material.specular.rgb, 1.0);"
             "    fragColor = ambient + diffuse + specular;"
             "}";
 
-        phongShader->loadMainShader(vertex_shader, fragment_shader);
+        phongShader->loadMainShader(vertex_shader, fragment_shader, true);
     }
     phongShader->setCamera(camera);
-    addShader(phongShader);
+    addShader("phong", phongShader);
 
     // F6: BLINN-PHONG SHADER
     if (!blinnShader->loadShaderFromFiles("phong.vert", "blinn.frag")) {
@@ -250,15 +317,16 @@ void Application::createShaders() {
             "layout(location=0) in vec3 vp;"
             "layout(location=1) in vec3 vn;"
             "uniform mat4 modelMatrix;"
-            "uniform mat4 viewMatrix;"
-            "uniform mat4 projectionMatrix;"
+            "uniform mat4 mvpMatrix;"
+            "uniform mat3 normalMatrix;"
             "out vec3 worldPosition;"
             "out vec3 worldNormal;"
+            "invariant gl_Position;"
             "void main() {"
             "    vec4 wp = modelMatrix * vec4(vp, 1.0);"
             "    worldPosition = wp.xyz;"
-            "    worldNormal = mat3(transpose(inverse(modelMatrix))) * vn;"
-            "    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vp, 1.0);"
+            "    worldNormal = normalMatrix * vn;"
+            "    gl_Position = mvpMatrix * vec4(vp, 1.0);"
             "}";
 
         const char* fragment_shader =
@@ -269,29 +337,125 @@ void Application::createShaders() {
             "uniform vec3 cameraPosition;"
             "out vec4 fragColor;"
             "void main() {"
-            "    vec4 objectColor = vec4(0.385, 0.647, 0.812, 1.0);"
-            "    vec4 ambient = vec4(0.1, 0.1, 0.1, 1.0);"
+            "    Material material = materials[materialIndex];"
+            "    vec4 objectColor = material.diffuse;"
+            "    vec4 ambient = material.ambient;"
             "    vec3 norm = normalize(worldNormal);"
             "    vec3 lightDir = normalize(lightPosition - worldPosition);"
             "    float diff = max(dot(norm, lightDir), 0.0);"
             "    vec4 diffuse = diff * objectColor;"
             "    vec3 viewDir = normalize(cameraPosition - worldPosition);"
             "    vec3 halfDir = normalize(lightDir + viewDir);"
-            "    float spec = pow(max(dot(norm, halfDir), 0.0), 32.0);"
-            "    vec4 specular = spec * vec4(1.0, 1.0, 1.0, 1.0);"
+            "    float spec = pow(max(dot(norm, halfDir), 0.0), material.specular.w);"
+            "    vec4 specular = spec * vec4(material.specular.rgb, 1.0);"
             "    fragColor = ambient + diffuse + specular;"
             "}";
 
-        blinnShader->loadMainShader(vertex_shader, fragment_shader);
+        blinnShader->loadMainShader(vertex_shader, fragment_shader, true);
     }
     blinnShader->setCamera(camera);
-    addShader(blinnShader);
+    addShader("blinn", blinnShader);
+
+    // Multi-view varianty (stejné fragment shadery, všechny pohledy jedním voláním)
+    const char* multiViewShaders[][2] = {
+        { "constant", "constant.frag" },
+        { "lambert", "lambert.frag" },
+        { "phong", "phong.frag" },
+        { "blinn", "blinn.frag" }
+    };
+    for (const auto& entry : multiViewShaders) {
+        ShaderProgram* variant = new ShaderProgram();
+        if (!variant->loadShaderFromFiles("multiview.vert", entry[1])) {
+            printf("Multi-view variant of %s not available, using per-view fallback\n", entry[0]);
+            delete variant;
+            continue;
+        }
+        resources.addShader(string(entry[0]) + "_multiview", variant);
+        multiView.registerVariant(resources.get(resources.findShader(entry[0])), variant);
+    }
+
+    // Stínová mapa pro hlavní světlo
+    shadowMap = new ShadowMap(1024, 50.0f);
+    if (!shadowMap->initialize()) {
+        printf("Shadow map initialization failed, shadows disabled\n");
+        delete shadowMap;
+        shadowMap = nullptr;
+    }
+
+    // Hloubkový předprůchod a měření overdraw
+    depthPrepass = new DepthPrepass();
+    if (!depthPrepass->initialize()) {
+        printf("Depth pre-pass initialization failed, pre-pass disabled\n");
+        delete depthPrepass;
+        depthPrepass = nullptr;
+    }
+
+    // Zmenšené offscreen rozlišení, aby se držel cílový čas snímku
+    if (resolutionTargetMs > 0.0) {
+        dynamicResolution = new DynamicResolution(resolutionTargetMs, resolutionMinScale, resolutionMaxScale);
+        if (!dynamicResolution->initialize(viewportWidth, viewportHeight)) {
+            printf("Dynamic resolution initialization failed, rendering at window resolution\n");
+            delete dynamicResolution;
+            dynamicResolution = nullptr;
+        }
+    }
+
+    // Impostory vzdálené vegetace, atlasy se upečou v createModels
+    impostors = new Impostors();
+    if (!impostors->initialize()) {
+        printf("Impostor initialization failed, distant vegetation uses full geometry\n");
+        delete impostors;
+        impostors = nullptr;
+    }
+
+    // Záznam snímků (jen interaktivní režim); video potřebuje snímek v každém kroku
+    if (!capturePath.empty() && !benchmarkSettings) {
+        frameCapture = new FrameCapture(capturePath, captureFps);
+        if (!frameCapture->initialize()) {
+            printf("Frame capture initialization failed, recording disabled\n");
+            delete frameCapture;
+            frameCapture = nullptr;
+        }
+        else {
+            onDemandRendering = false;
+        }
+    }
+}
+
+void Application::setupMultiView() {
+    // 0: hlavní kamera, 1: shora, 2: z boku, 3: zrcadlo hlavní kamery
+    multiView.clearViews();
+    int count = multiViewCount > RenderSnapshot::MAX_VIEWS ? RenderSnapshot::MAX_VIEWS : multiViewCount;
+    if (count == 2) {
+        multiView.addCameraView(camera, glm::vec4(0.0f, 0.0f, 0.5f, 1.0f));
+        multiView.addFixedView(glm::vec3(0.0f, 20.0f, 0.01f), glm::vec3(0.0f), glm::vec4(0.5f, 0.0f, 0.5f, 1.0f));
+    }
+    else {
+        multiView.addCameraView(camera, glm::vec4(0.0f, 0.5f, 0.5f, 0.5f));
+        multiView.addFixedView(glm::vec3(0.0f, 20.0f, 0.01f), glm::vec3(0.0f), glm::vec4(0.5f, 0.5f, 0.5f, 0.5f));
+        multiView.addFixedView(glm::vec3(15.0f, 5.0f, 0.0f), glm::vec3(0.0f), glm::vec4(0.0f, 0.0f, 0.5f, 0.5f));
+        if (count == 4) {
+            multiView.addCameraView(camera, glm::vec4(0.5f, 0.0f, 0.5f, 0.5f));
+        }
+    }
+    multiView.setEnabled(true);
+    printf("Multi-view: %d views\n", multiView.getViewCount());
+}
+
+void Application::toggleMultiView() {
+    if (multiView.getViewCount() < 2) {
+        multiViewCount = 4;
+        setupMultiView();
+        return;
+    }
+    multiView.setEnabled(!multiView.isEnabled());
+    printf("Multi-view %s\n", multiView.isEnabled() ? "ON" : "OFF");
 }
 
 void Application::setupCamera() {
     // Nastavení kamery do shader programu
     if (camera && !shaderPrograms.empty()) {
-        shaderPrograms[0]->setCamera(camera);
+        getShader(0)->setCamera(camera);
         printf("Camera connected to shader\n");
     }
 }
@@ -302,7 +466,7 @@ void Application::createModels() {
          0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,
         -0.5f, -0.5f, 0.0f,   1.0f, 0.0f, 1.0f
     };
-    addModel(new Model(triangle, 18));
+    addModel("triangle", new Model(triangle, 18));
 
     float square[] = {
          0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,
@@ -312,7 +476,7 @@ void Application::createModels() {
          0.9f,  0.9f, 0.0f,   1.0f, 1.0f, 0.0f,
          0.5f,  0.9f, 0.0f,   1.0f, 1.0f, 0.0f
     };
-    addModel(new Model(square, 36));
+    addModel("square", new Model(square, 36));
 
     float rectangle[] = {
         -0.9f,  0.1f, 0.0f,   1.0f, 0.0f, 1.0f,
@@ -322,7 +486,7 @@ void Application::createModels() {
         -0.3f,  0.3f, 0.0f,   0.0f, 1.0f, 0.0f,
         -0.9f,  0.3f, 0.0f,   1.0f, 1.0f, 0.0f
     };
-    addModel(new Model(rectangle, 36));
+    addModel("rectangle", new Model(rectangle, 36));
 
     float anotherSquare[] = {
          -1.0f,  1.0f, 0.0f,   1.0f, 0.0f, 0.0f,
@@ -332,7 +496,7 @@ void Application::createModels() {
          -0.6f,  0.6f, 0.0f,   1.0f, 0.0f, 0.0f,
          -1.0f,  0.6f, 0.0f,   1.0f, 0.0f, 0.0f
     };
-    addModel(new Model(anotherSquare, 36));
+    addModel("anotherSquare", new Model(anotherSquare, 36));
 
     const int segments = 20;
     vector<float> ballVertices;
@@ -356,389 +520,914 @@ void Application::createModels() {
         ballVertices.push_back(0.0f);
         ballVertices.push_back(0.0f); ballVertices.push_back(0.0f); ballVertices.push_back(1.0f);
     }
-    addModel(new Model(ballVertices.data(), ballVertices.size()));
-
-    addModel(new Model((float*)plain, 36));
-    addModel(new Model((float*)sphere, 17280));
-    addModel(new Model((float*)suziFlat, 17424));
-    addModel(new Model((float*)suziSmooth, 17424));
-    addModel(new Model((float*)tree, 92814));
-    addModel(new Model((float*)gift, 66624));
-    addModel(new Model((float*)bushes, 8730));
+    addModel("ball", new Model(ballVertices.data(), ballVertices.size()));
+
+    // Statická pole z hlaviček se nekopírují, při znovunahrání se čtou přímo
+    addModel("plain", new Model((float*)plain, 36, false));
+    addModel("sphere", new Model((float*)sphere, 17280, false));
+    addModel("suziFlat", new Model((float*)suziFlat, 17424, false));
+    addModel("suziSmooth", new Model((float*)suziSmooth, 17424, false));
+    addModel("tree", new Model((float*)tree, 92814, false));
+    addModel("gift", new Model((float*)gift, 66624, false));
+    addModel("bushes", new Model((float*)bushes, 8730, false));
+
+    // Pohledy vegetace do atlasů - za impostorDistance stojí jeden čtverec místo tisíců trojúhelníků
+    if (impostors) {
+        impostors->addModel(resources.getModel("tree"));
+        impostors->addModel(resources.getModel("bushes"));
+    }
 }
 
 void Application::createScenes() {
-    // Rotující objekty
-    Scene* scene1 = new Scene("Rotating Objects");
+    // Modely a shader podle jména ze správce prostředků
+    Model* triangleModel = resources.getModel("triangle");
+    Model* squareModel = resources.getModel("square");
+    Model* rectangleModel = resources.getModel("rectangle");
+    Model* cornerSquareModel = resources.getModel("anotherSquare");
+    Model* ballModel = resources.getModel("ball");
+    Model* plainModel = resources.getModel("plain");
+    Model* sphereModel = resources.getModel("sphere");
+    Model* suziFlatModel = resources.getModel("suziFlat");
+    Model* suziSmoothModel = resources.getModel("suziSmooth");
+    Model* treeModel = resources.getModel("tree");
+    Model* giftModel = resources.getModel("gift");
+    Model* bushModel = resources.getModel("bushes");
+    ShaderProgram* originalShader = resources.get(resources.findShader("original"));
+
+    // Materiály sdílené scénami (původní shader je ignoruje, projeví se po F2-F4/G)
+    unsigned short grassMaterial = materialTable->add("grass", MaterialTable::makeMaterial(glm::vec3(0.32f, 0.52f, 0.22f), 0.1f, 0.1f, 8.0f));
+    unsigned short foliageMaterial = materialTable->add("foliage", MaterialTable::makeMaterial(glm::vec3(0.18f, 0.48f, 0.20f), 0.08f, 0.2f, 16.0f));
+    unsigned short bushMaterial = materialTable->add("bush", MaterialTable::makeMaterial(glm::vec3(0.25f, 0.40f, 0.12f), 0.08f, 0.15f, 12.0f));
+    unsigned short giftMaterial = materialTable->add("gift", MaterialTable::makeMaterial(glm::vec3(0.80f, 0.12f, 0.15f), 0.1f, 0.6f, 48.0f));
+    unsigned short goldMaterial = materialTable->add("gold", MaterialTable::makeMaterial(glm::vec3(0.83f, 0.65f, 0.22f), 0.1f, 1.0f, 96.0f));
+    unsigned short lightMaterial = materialTable->add("light", MaterialTable::makeMaterial(glm::vec3(1.0f, 0.9f, 0.3f), 0.9f, 0.0f, 1.0f));
 
-    // TRIANGLE s rotací
-    Transform* t1 = new Transform();
-    t1->addTransform(new Rotation(0.0f, glm::vec3(0.0f, 0.0f, 1.0f)));
-    DrawableObject* tri1 = new DrawableObject(modelList[0], shaderPrograms[0], t1);
-    scene1->addObject(tri1);
-
-
-    // SQUARE s rotací a škálováním
-    Transform* t2 = new Transform();
-    t2->addTransform(new Rotation(0.0f, glm::vec3(0.0f, 0.0f, 1.0f)));
-    t2->addTransform(new Scale(0.8f));
-    DrawableObject* sq1 = new DrawableObject(modelList[1], shaderPrograms[0], t2);
-    scene1->addObject(sq1);
-
-    addScene(scene1);
+    // Rotující objekty
+    addSceneFactory("Rotating Objects", [=]() {
+        Scene* scene1 = new Scene("Rotating Objects");
+
+        // TRIANGLE s rotací
+        Transform* t1 = new Transform();
+        t1->addTransform(new Rotation(0.0f, glm::vec3(0.0f, 0.0f, 1.0f)));
+        DrawableObject* tri1 = new DrawableObject(triangleModel, originalShader, t1);
+        scene1->addObject(tri1);
+        scene1->adoptTransform(t1);
+
+
+        // SQUARE s rotací a škálováním
+        Transform* t2 = new Transform();
+        t2->addTransform(new Rotation(0.0f, glm::vec3(0.0f, 0.0f, 1.0f)));
+        t2->addTransform(new Scale(0.8f));
+        DrawableObject* sq1 = new DrawableObject(squareModel, originalShader, t2);
+        scene1->addObject(sq1);
+        scene1->adoptTransform(t2);
+        return scene1;
+    });
 
     // Statické objekty
-    Scene* scene2 = new Scene("Static Positions");
-
-    // TRIANGLE
-    Transform* s2t1 = new Transform();
-    s2t1->addTransform(new Translation(-0.5f, 0.5f, 0.0f));
-    s2t1->addTransform(new Scale(0.5f));
-    DrawableObject* tri2 = new DrawableObject(modelList[0], shaderPrograms[0], s2t1);
-    scene2->addObject(tri2);
-
-    // SQUARE
-    Transform* s2t2 = new Transform();
-    s2t2->addTransform(new Translation(0.5f, 0.5f, 0.0f));
-    s2t2->addTransform(new Scale(0.5f));
-    DrawableObject* sq2 = new DrawableObject(modelList[1], shaderPrograms[0], s2t2);
-    scene2->addObject(sq2);
-
-    // RECTANGLE
-    Transform* s2t3 = new Transform();
-    s2t3->addTransform(new Translation(-0.5f, -0.5f, 0.0f));
-    s2t3->addTransform(new Scale(0.5f));
-    DrawableObject* rect1 = new DrawableObject(modelList[2], shaderPrograms[0], s2t3);
-    scene2->addObject(rect1);
-
-    // SQUARE
-    Transform* s2t4 = new Transform();
-    s2t4->addTransform(new Translation(0.5f, -0.5f, 0.0f));
-    s2t4->addTransform(new Scale(0.5f));
-    DrawableObject* sq3 = new DrawableObject(modelList[3], shaderPrograms[0], s2t4);
-    scene2->addObject(sq3);
-
-    addScene(scene2);
+    addSceneFactory("Static Positions", [=]() {
+        Scene* scene2 = new Scene("Static Positions");
+
+        // TRIANGLE
+        Transform* s2t1 = new Transform();
+        s2t1->addTransform(new Translation(-0.5f, 0.5f, 0.0f));
+        s2t1->addTransform(new Scale(0.5f));
+        DrawableObject* tri2 = new DrawableObject(triangleModel, originalShader, s2t1);
+        scene2->addObject(tri2);
+        scene2->adoptTransform(s2t1);
+
+        // SQUARE
+        Transform* s2t2 = new Transform();
+        s2t2->addTransform(new Translation(0.5f, 0.5f, 0.0f));
+        s2t2->addTransform(new Scale(0.5f));
+        DrawableObject* sq2 = new DrawableObject(squareModel, originalShader, s2t2);
+        scene2->addObject(sq2);
+        scene2->adoptTransform(s2t2);
+
+        // RECTANGLE
+        Transform* s2t3 = new Transform();
+        s2t3->addTransform(new Translation(-0.5f, -0.5f, 0.0f));
+        s2t3->addTransform(new Scale(0.5f));
+        DrawableObject* rect1 = new DrawableObject(rectangleModel, originalShader, s2t3);
+        scene2->addObject(rect1);
+        scene2->adoptTransform(s2t3);
+
+        // SQUARE
+        Transform* s2t4 = new Transform();
+        s2t4->addTransform(new Translation(0.5f, -0.5f, 0.0f));
+        s2t4->addTransform(new Scale(0.5f));
+        DrawableObject* sq3 = new DrawableObject(cornerSquareModel, originalShader, s2t4);
+        scene2->addObject(sq3);
+        scene2->adoptTransform(s2t4);
+        return scene2;
+    });
 
     // Komplexní transformace
-    Scene* scene3 = new Scene("Complex Transforms");
+    addSceneFactory("Complex Transforms", [=]() {
+        Scene* scene3 = new Scene("Complex Transforms");
+
+        // Rotující a posunující TRIANGLE
+        Transform* s3t1 = new Transform();
+        s3t1->addTransform(new Translation(-0.6f, 0.2f, 0.0f));
+        s3t1->addTransform(new Rotation(0.0f, glm::vec3(0.0f, 0.0f, 1.0f)));
+        s3t1->addTransform(new Scale(0.5f));
+        DrawableObject* tri3 = new DrawableObject(triangleModel, originalShader, s3t1);
+        scene3->addObject(tri3);
+        scene3->adoptTransform(s3t1);
+
+        // Vnořená transformace SQUARE
+        Transform* inner = new Transform();
+        inner->addTransform(new Rotation(0.0f, glm::vec3(0.0f, 0.0f, 1.0f)));
+        inner->addTransform(new Scale(0.6f));
+
+        Transform* outer = new Transform();
+        outer->addTransform(new Translation(0.6f, -0.3f, 0.0f));
+        outer->addTransform(inner);
+        DrawableObject* sq4 = new DrawableObject(squareModel, originalShader, outer);
+        scene3->addObject(sq4);
+        scene3->adoptTransform(outer);
+        return scene3;
+    });
 
-    // Rotující a posunující TRIANGLE
-    Transform* s3t1 = new Transform();
-    s3t1->addTransform(new Translation(-0.6f, 0.2f, 0.0f));
-    s3t1->addTransform(new Rotation(0.0f, glm::vec3(0.0f, 0.0f, 1.0f)));
-    s3t1->addTransform(new Scale(0.5f));
-    DrawableObject* tri3 = new DrawableObject(modelList[0], shaderPrograms[0], s3t1);
-    scene3->addObject(tri3);
+    // ROTATED TRIANGLE
+    addSceneFactory("Rotated Triangle", [=]() {
+        Scene* rotatingTriangleScene = new Scene("Rotated Triangle");
+
+        Transform* triangleTransform = new Transform();
+        // Nulový úhel, úhel se mění v run()
+        triangleTransform->addTransform(new Rotation(0.0f, glm::vec3(0.0f, 0.0f, 1.0f)));
+        DrawableObject* rotTri = new DrawableObject(triangleModel, originalShader, triangleTransform);
+        rotTri->setStatic(false); // transformace se mění každý snímek
+        rotatingTriangleScene->setAnimated(true);
+        rotatingTriangleScene->addObject(rotTri);
+        rotatingTriangleScene->adoptTransform(triangleTransform);
+        return rotatingTriangleScene;
+    });
 
-    // Vnořená transformace SQUARE
-    Transform* inner = new Transform();
-    inner->addTransform(new Rotation(0.0f, glm::vec3(0.0f, 0.0f, 1.0f)));
-    inner->addTransform(new Scale(0.6f));
+    // CIRCLE
+    addSceneFactory("Four Balls", [=]() {
+        Scene* ballScene = new Scene("Four Balls");
+
+        int ballModelIndex = 4; // index
+
+        // levá
+        Transform* b1 = new Transform();
+        b1->addTransform(new Translation(-0.5f, 0.0f, 0.0f));
+        DrawableObject* ball1 = new DrawableObject(ballModel, originalShader, b1);
+        ballScene->addObject(ball1);
+        ballScene->adoptTransform(b1);
+
+        // pravá
+        Transform* b2 = new Transform();
+        b2->addTransform(new Translation(0.5f, 0.0f, 0.0f));
+        DrawableObject* ball2 = new DrawableObject(ballModel, originalShader, b2);
+        ballScene->addObject(ball2);
+        ballScene->adoptTransform(b2);
+
+        // horní
+        Transform* b3 = new Transform();
+        b3->addTransform(new Translation(0.0f, 0.5f, 0.0f));
+        DrawableObject* ball3 = new DrawableObject(ballModel, originalShader, b3);
+        ballScene->addObject(ball3);
+        ballScene->adoptTransform(b3);
+
+        // dolní
+        Transform* b4 = new Transform();
+        b4->addTransform(new Translation(0.0f, -0.5f, 0.0f));
+        DrawableObject* ball4 = new DrawableObject(ballModel, originalShader, b4);
+        ballScene->addObject(ball4);
+        ballScene->adoptTransform(b4);
+        return ballScene;
+    });
+
+    addSceneFactory("Complex Scene with 20 Objects", [=]() {
+        Scene* scene6 = new Scene("Complex Scene with 20 Objects");
+
+        // Terén
+        Transform* terrain = new Transform();
+        terrain->addTransform(new Translation(0.0f, -0.8f, 0.0f));
+        terrain->addTransform(new Scale(2.0f, 0.1f, 2.0f));
+        DrawableObject* terrainObj = new DrawableObject(plainModel, originalShader, terrain);
+        terrainObj->setMaterial(grassMaterial);
+        scene6->addObject(terrainObj);
+        scene6->adoptTransform(terrain);
+
+        // 4 stromy v rohu
+        glm::vec3 treePositions[] = {
+            glm::vec3(-1.5f, -0.5f, 0.0f),
+            glm::vec3(1.5f, -0.5f, 0.0f),
+            glm::vec3(0.0f, -0.5f, -1.5f),
+            glm::vec3(0.0f, -0.5f, 1.5f)
+        };
+
+        for (int i = 0; i < 4; i++) {
+            Transform* tree = new Transform();
+            tree->addTransform(new Translation(treePositions[i].x, treePositions[i].y, treePositions[i].z));
+            tree->addTransform(new Scale(0.3f));
+            DrawableObject* treeObj = new DrawableObject(treeModel, originalShader, tree);
+            treeObj->setMaterial(foliageMaterial);
+            scene6->addObject(treeObj);
+            scene6->adoptTransform(tree);
+        }
 
-    Transform* outer = new Transform();
-    outer->addTransform(new Translation(0.6f, -0.3f, 0.0f));
-    outer->addTransform(inner);
-    DrawableObject* sq4 = new DrawableObject(modelList[1], shaderPrograms[0], outer);
-    scene3->addObject(sq4);
+        // 4 koule v rohu
+        glm::vec3 spherePositions[] = {
+            glm::vec3(-0.8f, -0.3f, -0.8f),
+            glm::vec3(0.8f, -0.3f, -0.8f),
+            glm::vec3(-0.8f, -0.3f, 0.8f),
+            glm::vec3(0.8f, -0.3f, 0.8f)
+        };
+
+        for (int i = 0; i < 4; i++) {
+            Transform* sphere = new Transform();
+            sphere->addTransform(new Translation(spherePositions[i].x, spherePositions[i].y, spherePositions[i].z));
+            sphere->addTransform(new Scale(0.2f));
+            DrawableObject* sphereObj = new DrawableObject(sphereModel, originalShader, sphere);
+            scene6->addObject(sphereObj);
+            scene6->adoptTransform(sphere);
+        }
 
-    addScene(scene3);
+        // 2 suzi flat s rotací
+        float suziRotations[] = { 45.0f, -45.0f };
+        for (int i = 0; i < 2; i++) {
+            Transform* suziFlat = new Transform();
+            suziFlat->addTransform(new Translation(-1.0f + i * 2.0f, -0.5f, 0.0f));
+            suziFlat->addTransform(new Rotation(glm::radians(suziRotations[i]), glm::vec3(0.0f, 1.0f, 0.0f)));
+            suziFlat->addTransform(new Scale(0.4f));
+            DrawableObject* suziObj = new DrawableObject(suziFlatModel, originalShader, suziFlat);
+            suziObj->setMaterial(goldMaterial);
+            scene6->addObject(suziObj);
+            scene6->adoptTransform(suziFlat);
+        }
 
-    // ROTATED TRIANGLE
-    Scene* rotatingTriangleScene = new Scene("Rotated Triangle");
+        // 2 suzi smooth s rotací
+        float suziSmoothRotations[] = { 90.0f, -90.0f };
+        for (int i = 0; i < 2; i++) {
+            Transform* suziSmooth = new Transform();
+            suziSmooth->addTransform(new Translation(0.0f, -0.5f, -1.0f + i * 2.0f));
+            suziSmooth->addTransform(new Rotation(glm::radians(suziSmoothRotations[i]), glm::vec3(0.0f, 1.0f, 0.0f)));
+            suziSmooth->addTransform(new Scale(0.4f));
+            DrawableObject* suziSmoothObj = new DrawableObject(suziSmoothModel, originalShader, suziSmooth);
+            suziSmoothObj->setMaterial(goldMaterial);
+            scene6->addObject(suziSmoothObj);
+            scene6->adoptTransform(suziSmooth);
+        }
 
-    Transform* triangleTransform = new Transform();
-    // Nulový úhel, úhel se mění v run()
-    triangleTransform->addTransform(new Rotation(0.0f, glm::vec3(0.0f, 0.0f, 1.0f)));
-    DrawableObject* rotTri = new DrawableObject(modelList[0], shaderPrograms[0], triangleTransform);
-    rotatingTriangleScene->addObject(rotTri);
+        // 4 dárky v rohu
+        glm::vec3 giftPositions[] = {
+            glm::vec3(-0.5f, -0.5f, -0.5f),
+            glm::vec3(0.5f, -0.5f, -0.5f),
+            glm::vec3(-0.5f, -0.5f, 0.5f),
+            glm::vec3(0.5f, -0.5f, 0.5f)
+        };
+
+        for (int i = 0; i < 4; i++) {
+            Transform* gift = new Transform();
+            gift->addTransform(new Translation(giftPositions[i].x, giftPositions[i].y, giftPositions[i].z));
+            gift->addTransform(new Scale(0.2f));
+            DrawableObject* giftObj = new DrawableObject(giftModel, originalShader, gift);
+            giftObj->setMaterial(giftMaterial);
+            scene6->addObject(giftObj);
+            scene6->adoptTransform(gift);
+        }
 
-    addScene(rotatingTriangleScene);
+        // 3 křoviny
+        glm::vec3 bushPositions[] = {
+            glm::vec3(-1.2f, -0.5f, 1.2f),
+            glm::vec3(1.2f, -0.5f, 1.2f),
+            glm::vec3(0.0f, -0.5f, 1.5f)
+        };
+
+        for (int i = 0; i < 3; i++) {
+            Transform* bush = new Transform();
+            bush->addTransform(new Translation(bushPositions[i].x, bushPositions[i].y, bushPositions[i].z));
+            bush->addTransform(new Scale(0.25f));
+            DrawableObject* bushObj = new DrawableObject(bushModel, originalShader, bush);
+            bushObj->setMaterial(bushMaterial);
+            scene6->addObject(bushObj);
+            scene6->adoptTransform(bush);
+        }
+        return scene6;
+    });
+
+    if (worldStreamer) {
+        // Neomezený les - dlaždice kolem kamery generuje WorldStreamer (--stream-world)
+        worldStreamer->setModels(treeModel, bushModel, plainModel, originalShader);
+        worldStreamer->setMaterials(foliageMaterial, bushMaterial, grassMaterial);
+        worldStreamer->start();
+        streamedSceneIndex = getSceneCount();
+        sceneLoader.registerScene("Forest - Streamed World", []() {
+            return new Scene("Forest - Streamed World");
+        });
+    }
+    else {
+        addSceneFactory("Forest - 50 Trees & 50 Bushes", [=]() {
+            Scene* scene7 = new Scene("Forest - 50 Trees & 50 Bushes");
 
-    // CIRCLE
-    Scene* ballScene = new Scene("Four Balls");
-
-    int ballModelIndex = 4; // index
-
-    // levá
-    Transform* b1 = new Transform();
-    b1->addTransform(new Translation(-0.5f, 0.0f, 0.0f));
-    DrawableObject* ball1 = new DrawableObject(modelList[4], shaderPrograms[0], b1);
-    ballScene->addObject(ball1);
-
-    // pravá
-    Transform* b2 = new Transform();
-    b2->addTransform(new Translation(0.5f, 0.0f, 0.0f));
-    DrawableObject* ball2 = new DrawableObject(modelList[4], shaderPrograms[0], b2);
-    ballScene->addObject(ball2);
-
-    // horní
-    Transform* b3 = new Transform();
-    b3->addTransform(new Translation(0.0f, 0.5f, 0.0f));
-    DrawableObject* ball3 = new DrawableObject(modelList[4], shaderPrograms[0], b3);
-    ballScene->addObject(ball3);
-
-    // dolní
-    Transform* b4 = new Transform();
-    b4->addTransform(new Translation(0.0f, -0.5f, 0.0f));
-    DrawableObject* ball4 = new DrawableObject(modelList[4], shaderPrograms[0], b4);
-    ballScene->addObject(ball4);
-
-    addScene(ballScene);
-
-    Scene* scene6 = new Scene("Complex Scene with 20 Objects");
-
-    // Terén
-    Transform* terrain = new Transform();
-    terrain->addTransform(new Translation(0.0f, -0.8f, 0.0f));
-    terrain->addTransform(new Scale(2.0f, 0.1f, 2.0f));
-    DrawableObject* terrainObj = new DrawableObject(modelList[5], shaderPrograms[0], terrain);
-    scene6->addObject(terrainObj);
-
-    // 4 stromy v rohu
-    glm::vec3 treePositions[] = {
-        glm::vec3(-1.5f, -0.5f, 0.0f),
-        glm::vec3(1.5f, -0.5f, 0.0f),
-        glm::vec3(0.0f, -0.5f, -1.5f),
-        glm::vec3(0.0f, -0.5f, 1.5f)
-    };
+            srand(42);
 
-    for (int i = 0; i < 4; i++) {
-        Transform* tree = new Transform();
-        tree->addTransform(new Translation(treePositions[i].x, treePositions[i].y, treePositions[i].z));
-        tree->addTransform(new Scale(0.3f));
-        DrawableObject* treeObj = new DrawableObject(modelList[9], shaderPrograms[0], tree);
-        scene6->addObject(treeObj);
-    }
+            Transform* forestTerrain = new Transform();
+            forestTerrain->addTransform(new Translation(0.0f, -1.0f, 0.0f));
+            forestTerrain->addTransform(new Scale(50.0f, 0.5f, 50.0f));
 
-    // 4 koule v rohu
-    glm::vec3 spherePositions[] = {
-        glm::vec3(-0.8f, -0.3f, -0.8f),
-        glm::vec3(0.8f, -0.3f, -0.8f),
-        glm::vec3(-0.8f, -0.3f, 0.8f),
-        glm::vec3(0.8f, -0.3f, 0.8f)
-    };
+            DrawableObject* forestTerrainObj = new DrawableObject(plainModel, originalShader, forestTerrain);
+            forestTerrainObj->setMaterial(grassMaterial);
+            scene7->addObject(forestTerrainObj);
+            scene7->adoptTransform(forestTerrain);
 
-    for (int i = 0; i < 4; i++) {
-        Transform* sphere = new Transform();
-        sphere->addTransform(new Translation(spherePositions[i].x, spherePositions[i].y, spherePositions[i].z));
-        sphere->addTransform(new Scale(0.2f));
-        DrawableObject* sphereObj = new DrawableObject(modelList[6], shaderPrograms[0], sphere);
-        scene6->addObject(sphereObj);
-    }
-
-    // 2 suzi flat s rotací
-    float suziRotations[] = { 45.0f, -45.0f };
-    for (int i = 0; i < 2; i++) {
-        Transform* suziFlat = new Transform();
-        suziFlat->addTransform(new Translation(-1.0f + i * 2.0f, -0.5f, 0.0f));
-        suziFlat->addTransform(new Rotation(glm::radians(suziRotations[i]), glm::vec3(0.0f, 1.0f, 0.0f)));
-        suziFlat->addTransform(new Scale(0.4f));
-        DrawableObject* suziObj = new DrawableObject(modelList[7], shaderPrograms[0], suziFlat);
-        scene6->addObject(suziObj);
-    }
-
-    // 2 suzi smooth s rotací
-    float suziSmoothRotations[] = { 90.0f, -90.0f };
-    for (int i = 0; i < 2; i++) {
-        Transform* suziSmooth = new Transform();
-        suziSmooth->addTransform(new Translation(0.0f, -0.5f, -1.0f + i * 2.0f));
-        suziSmooth->addTransform(new Rotation(glm::radians(suziSmoothRotations[i]), glm::vec3(0.0f, 1.0f, 0.0f)));
-        suziSmooth->addTransform(new Scale(0.4f));
-        DrawableObject* suziSmoothObj = new DrawableObject(modelList[8], shaderPrograms[0], suziSmooth);
-        scene6->addObject(suziSmoothObj);
-    }
-
-    // 4 dárky v rohu
-    glm::vec3 giftPositions[] = {
-        glm::vec3(-0.5f, -0.5f, -0.5f),
-        glm::vec3(0.5f, -0.5f, -0.5f),
-        glm::vec3(-0.5f, -0.5f, 0.5f),
-        glm::vec3(0.5f, -0.5f, 0.5f)
-    };
+            for (int i = 0; i < 50; i++) {
+                // (-20 až 20) x (-20 až 20)
+                float posX = (rand() % 4000) / 100.0f - 20.0f;
+                float posZ = (rand() % 4000) / 100.0f - 20.0f;
 
-    for (int i = 0; i < 4; i++) {
-        Transform* gift = new Transform();
-        gift->addTransform(new Translation(giftPositions[i].x, giftPositions[i].y, giftPositions[i].z));
-        gift->addTransform(new Scale(0.2f));
-        DrawableObject* giftObj = new DrawableObject(modelList[10], shaderPrograms[0], gift);
-        scene6->addObject(giftObj);
-    }
+                // Osa Y
+                float rotationY = (rand() % 360) * 3.14159f / 180.0f;
 
-    // 3 křoviny
-    glm::vec3 bushPositions[] = {
-        glm::vec3(-1.2f, -0.5f, 1.2f),
-        glm::vec3(1.2f, -0.5f, 1.2f),
-        glm::vec3(0.0f, -0.5f, 1.5f)
-    };
+                // velikost (0.2 až 0.4)
+                float scale = 0.2f + (rand() % 20) / 100.0f;
 
-    for (int i = 0; i < 3; i++) {
-        Transform* bush = new Transform();
-        bush->addTransform(new Translation(bushPositions[i].x, bushPositions[i].y, bushPositions[i].z));
-        bush->addTransform(new Scale(0.25f));
-        DrawableObject* bushObj = new DrawableObject(modelList[11], shaderPrograms[0], bush);
-        scene6->addObject(bushObj);
-    }
+                Transform* tree = new Transform();
+                tree->addTransform(new Translation(posX, -0.5f, posZ));
+                tree->addTransform(new Rotation(rotationY, glm::vec3(0.0f, 1.0f, 0.0f)));
+                tree->addTransform(new Scale(scale));
 
-    addScene(scene6);
+                DrawableObject* treeObj = new DrawableObject(treeModel, originalShader, tree);
+                treeObj->setMaterial(foliageMaterial);
+                scene7->addObject(treeObj);
+                scene7->adoptTransform(tree);
+            }
 
-    Scene* scene7 = new Scene("Forest - 50 Trees & 50 Bushes");
+            for (int i = 0; i < 50; i++) {
+                // (-20 až 20) x (-20 až 20)
+                float posX = (rand() % 4000) / 100.0f - 20.0f;
+                float posZ = (rand() % 4000) / 100.0f - 20.0f;
 
-    srand(42);
+                // Osa Y
+                float rotationY = (rand() % 360) * 3.14159f / 180.0f;
 
-    Transform* forestTerrain = new Transform();
-    forestTerrain->addTransform(new Translation(0.0f, -1.0f, 0.0f));
-    forestTerrain->addTransform(new Scale(50.0f, 0.5f, 50.0f));
+                // velikost (0.15 až 0.35)
+                float scale = 0.15f + (rand() % 20) / 100.0f;
 
-    DrawableObject* forestTerrainObj = new DrawableObject(modelList[5], shaderPrograms[0], forestTerrain);
-    scene7->addObject(forestTerrainObj);
+                Transform* bush = new Transform();
+                bush->addTransform(new Translation(posX, -0.5f, posZ));
+                bush->addTransform(new Rotation(rotationY, glm::vec3(0.0f, 1.0f, 0.0f)));
+                bush->addTransform(new Scale(scale));
 
-    for (int i = 0; i < 50; i++) {
-        // (-20 až 20) x (-20 až 20)
-        float posX = (rand() % 4000) / 100.0f - 20.0f;
-        float posZ = (rand() % 4000) / 100.0f - 20.0f;
+                DrawableObject* bushObj = new DrawableObject(bushModel, originalShader, bush);
+                bushObj->setMaterial(bushMaterial);
+                scene7->addObject(bushObj);
+                scene7->adoptTransform(bush);
+            }
+            return scene7;
+        });
+    }
 
-        // Osa Y
-        float rotationY = (rand() % 360) * 3.14159f / 180.0f;
+    addSceneFactory("Test Scene 1 - Four Spheres", [=]() {
+        Scene* testScene1 = new Scene("Test Scene 1 - Four Spheres");
+
+        // Přidaní malé žluté koule uprostřed pro světlo
+        Transform* lightVis = new Transform();
+        lightVis->addTransform(new Scale(0.1f));
+        DrawableObject* lightSphere = new DrawableObject(sphereModel, originalShader, lightVis);
+        lightSphere->setMaterial(lightMaterial);
+        lightSphere->setCastsShadow(false); // světlo je uvnitř koule
+        testScene1->addObject(lightSphere);
+        testScene1->adoptTransform(lightVis);
+
+        glm::vec3 testSpherePositions[] = {
+            glm::vec3(-0.7f, 0.0f, 0.0f),   // levá
+            glm::vec3(0.7f, 0.0f, 0.0f),    // pravá  
+            glm::vec3(0.0f, 0.7f, 0.0f),    // horní
+            glm::vec3(0.0f, -0.7f, 0.0f)    // dolní
+        };
+
+        for (int i = 0; i < 4; i++) {
+            Transform* sphereTransform = new Transform();
+            sphereTransform->addTransform(new Translation(testSpherePositions[i]));
+            sphereTransform->addTransform(new Scale(0.3f));
+
+            DrawableObject* sphere = new DrawableObject(sphereModel, originalShader, sphereTransform);
+            testScene1->addObject(sphere);
+            testScene1->adoptTransform(sphereTransform);
+        }
+        return testScene1;
+    });
 
-        // velikost (0.2 až 0.4)
-        float scale = 0.2f + (rand() % 20) / 100.0f;
+    // Sestaví se jen první scéna, ostatní při přepnutí nebo předpřípravou
+    printf("Registered %d scenes\n", getSceneCount());
+    sceneLoader.start();
+    switchScene(currentSceneIndex);
+}
 
-        Transform* tree = new Transform();
-        tree->addTransform(new Translation(posX, -0.5f, posZ));
-        tree->addTransform(new Rotation(rotationY, glm::vec3(0.0f, 1.0f, 0.0f)));
-        tree->addTransform(new Scale(scale));
+void Application::buildSnapshot(RenderSnapshot& snapshot, float angle) {
+    PROFILE_SCOPE("Application::buildSnapshot");
+    // Předchozí snímek už z arény nic nepoužívá
+    updateArena.reset();
+
+    snapshot.items.clear();
+    snapshot.scene = nullptr;
+    snapshot.sceneId = 0;
+    snapshot.sceneRevision = 0;
+    snapshot.lightPosition = mainLight->getPosition();
+    snapshot.cameraPosition = camera->getEye();
+    snapshot.viewportWidth = viewportWidth;
+    snapshot.viewportHeight = viewportHeight;
+    snapshot.viewProjection = camera->getProjectionMatrix() * camera->getViewMatrix();
+    snapshot.shadowsEnabled = shadowsEnabled;
+    snapshot.depthPrepassMode = depthPrepassMode;
+    snapshot.showOverdraw = overdrawView;
+    snapshot.impostorDistance = impostorsEnabled ? impostorDistance : 0.0f;
+    snapshot.recordDrawList = false;
+    snapshot.replayDrawList = false;
+    snapshot.frameTime = lastFrameTime;
+    snapshot.frameIndex = frameIndex++;
+    snapshot.objectsVisited = 0;
+    snapshot.objectsCulled = 0;
+    snapshot.inputTimestamp = 0.0;
+    snapshot.viewCount = 1;
+
+    if (currentSceneIndex < 0 || currentSceneIndex >= getSceneCount()) {
+        recordedSceneId = 0;
+        return;
+    }
 
-        DrawableObject* treeObj = new DrawableObject(modelList[9], shaderPrograms[0], tree);
-        scene7->addObject(treeObj);
+    Scene* currentScene = getScene(currentSceneIndex);
+    ObjectStorage& storage = currentScene->getStorage();
+    const auto& objects = storage.getObjects();
+    snapshot.scene = currentScene;
+    snapshot.sceneId = currentScene->getId();
+    sceneLoader.markActive(currentSceneIndex, snapshot.frameIndex);
+    // Dlaždice kolem kamery - vkládá a odebírá objekty, proto před revizí scény
+    if (worldStreamer && currentSceneIndex == streamedSceneIndex) {
+        worldStreamer->update(currentScene, snapshot.cameraPosition);
+    }
+    snapshot.sceneRevision = currentScene->getRevision();
+
+    // Statická scéna beze změny - žádné procházení, render vlákno přehraje záznam
+    bool multi = multiView.isEnabled();
+    bool staticScene = drawListsEnabled && !multi && currentScene->isStatic();
+    if (staticScene && recordedSceneId == currentScene->getId() &&
+        recordedChangeRevision == currentScene->getChangeRevision()) {
+        snapshot.replayDrawList = true;
+        return;
+    }
+    snapshot.recordDrawList = staticScene;
+    recordedSceneId = staticScene ? currentScene->getId() : 0;
+    recordedChangeRevision = currentScene->getChangeRevision();
+
+    // Speciální pro scénu 3 - rotace se mění každý snímek (platí jen do konce buildSnapshot)
+    Rotation* dynamicTransform = nullptr;
+    if (currentSceneIndex == 3) {
+        dynamicTransform = updateArena.create<Rotation>(angle, glm::vec3(0.0f, 0.0f, 1.0f));
+        for (unsigned int i = 0; i < storage.size(); i++) {
+            storage.setTransform(i, dynamicTransform);
+        }
     }
 
-    for (int i = 0; i < 50; i++) {
-        // (-20 až 20) x (-20 až 20)
-        float posX = (rand() % 4000) / 100.0f - 20.0f;
-        float posZ = (rand() % 4000) / 100.0f - 20.0f;
+    // World matice jen pro změněné objekty, pak MVP a normálové matice najednou
+    storage.updateWorldMatrices(jobSystem);
+    matrixBatch.compute(storage, snapshot.viewProjection, jobSystem);
+    snapshot.objectsVisited = static_cast<int>(objects.size());
+
+    // Položky se skládají přímo z hustých polí úložiště
+    const auto& models = storage.getModels();
+    const auto& shaders = storage.getShaders();
+    const auto& materials = storage.getMaterials();
+    const auto& flags = storage.getFlags();
+    const auto& revisions = storage.getRevisions();
+    for (size_t i = 0; i < objects.size(); i++) {
+        RenderItem item;
+        item.object = objects[i];
+        item.model = models[i];
+        item.shader = shaders[i];
+        item.material = materials[i];
+        item.matrices = matrixBatch.get(i);
+        item.staticObject = (flags[i] & ObjectStorage::FLAG_STATIC) != 0;
+        item.castsShadow = (flags[i] & ObjectStorage::FLAG_CASTS_SHADOW) != 0;
+        item.revision = revisions[i];
+        item.viewMask = 1;
+        snapshot.items.push_back(item);
+    }
 
-        // Osa Y
-        float rotationY = (rand() % 360) * 3.14159f / 180.0f;
+    // Ořez proti všem pohledům najednou, maska pohledů do položek
+    if (multi) {
+        multiView.prepare(snapshot);
+    }
 
-        // velikost (0.15 až 0.35)
-        float scale = 0.15f + (rand() % 20) / 100.0f;
+    if (dynamicTransform) {
+        for (unsigned int i = 0; i < storage.size(); i++) {
+            storage.setTransform(i, nullptr);
+        }
+    }
+}
 
-        Transform* bush = new Transform();
-        bush->addTransform(new Translation(posX, -0.5f, posZ));
-        bush->addTransform(new Rotation(rotationY, glm::vec3(0.0f, 1.0f, 0.0f)));
-        bush->addTransform(new Scale(scale));
+void Application::renderFrame(const RenderSnapshot& snapshot) {
+    PROFILE_SCOPE("Application::renderFrame");
+    PROFILE_GPU_SCOPE("Frame");
+    // Multi-view počítá viewporty pohledů z velikosti okna - kreslí se přímo do něj
+    bool scaled = dynamicResolution && snapshot.viewCount == 1;
+    if (scaled) {
+        dynamicResolution->begin(snapshot.viewportWidth, snapshot.viewportHeight);
+    }
+    RenderStats::objects(snapshot.objectsVisited, snapshot.objectsCulled);
+    // Změněné materiály (jinak jen porovnání revize)
+    materialTable->upload();
 
-        DrawableObject* bushObj = new DrawableObject(modelList[11], shaderPrograms[0], bush);
-        scene7->addObject(bushObj);
+    if (snapshot.recordDrawList) {
+        drawList.record(snapshot);
+        printf("Recorded draw list: %d commands\n", drawList.getCommandCount());
+    }
+    else if (!snapshot.replayDrawList) {
+        drawList.clear();
     }
+    bool useDrawList = drawList.isRecorded();
 
-    addScene(scene7);
+    // Stínová mapa - statické vrhače jsou v cache
+    if (shadowMap) {
+        if (shadowMap->isEnabled() != snapshot.shadowsEnabled) {
+            shadowMap->setEnabled(snapshot.shadowsEnabled);
+        }
+        shadowMap->update(snapshot, useDrawList ? drawList.getItems() : snapshot.items);
+    }
 
-    Scene* testScene1 = new Scene("Test Scene 1 - Four Spheres");
+    // Až po stínové mapě - ta na konci vrací framebuffer 0
+    if (scaled) {
+        dynamicResolution->bind();
+    }
+    else {
+        glViewport(0, 0, snapshot.viewportWidth, snapshot.viewportHeight);
+    }
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Vzdálená vegetace jako impostory - první, takže je jejich hloubka i v předprůchodu
+    const Impostors* replaced = nullptr;
+    if (impostors) {
+        impostors->beginFrame(snapshot);
+        impostors->render(snapshot, useDrawList ? drawList.getItems() : snapshot.items);
+        if (impostors->isActive()) replaced = impostors;
+    }
 
-    // Přidaní malé žluté koule uprostřed pro světlo
-    Transform* lightVis = new Transform();
-    lightVis->addTransform(new Scale(0.1f));
-    DrawableObject* lightSphere = new DrawableObject(modelList[6], shaderPrograms[0], lightVis);
-    testScene1->addObject(lightSphere);
+    // Hloubka napřed, stínování pak jen viditelných fragmentů (GL_EQUAL); jen jeden pohled
+    bool prepass = depthPrepass && snapshot.viewCount == 1;
+    if (useDrawList && snapshot.viewCount == 1) {
+        // Kamera se mohla pohnout - přepočítají se jen MVP v souvislém poli
+        drawList.updateViewProjection(snapshot.viewProjection);
+    }
+    if (prepass) {
+        depthPrepass->begin(snapshot, snapshot.items, useDrawList ? &drawList : nullptr, replaced);
+    }
 
-    glm::vec3 testSpherePositions[] = {
-        glm::vec3(-0.7f, 0.0f, 0.0f),   // levá
-        glm::vec3(0.7f, 0.0f, 0.0f),    // pravá  
-        glm::vec3(0.0f, 0.7f, 0.0f),    // horní
-        glm::vec3(0.0f, -0.7f, 0.0f)    // dolní
-    };
+    if (snapshot.viewCount > 1) {
+        multiView.render(snapshot, shadowMap);
+    }
+    else if (useDrawList) {
+        drawList.replay(snapshot, shadowMap, replaced);
+    }
+    else {
+        for (const auto& item : snapshot.items) {
+            // Nastavení shader matric
+            if (item.shader) {
+                if (replaced && replaced->replaces(item.model, item.matrices.model)) continue;
+                ShaderProgram* shader = item.shader;
+                shader->use(shader->getProgram());
+
+                // Nastav lighting uniformy (pro Lambert a Phong shadery)
+                if (shader->hasUniform("lightPosition")) {
+                    shader->SetUniform("lightPosition", snapshot.lightPosition);
+                }
+                if (shader->hasUniform("cameraPosition")) {
+                    shader->SetUniform("cameraPosition", snapshot.cameraPosition);
+                }
 
-    for (int i = 0; i < 4; i++) {
-        Transform* sphereTransform = new Transform();
-        sphereTransform->addTransform(new Translation(testSpherePositions[i]));
-        sphereTransform->addTransform(new Scale(0.3f));
+                if (shadowMap) {
+                    shadowMap->applyUniforms(shader);
+                }
 
-        DrawableObject* sphere = new DrawableObject(modelList[6], shaderPrograms[0], sphereTransform);
-        testScene1->addObject(sphere);
+                DrawableObject::draw(item.model, shader, item.matrices, item.material);
+            }
+        }
     }
 
-    addScene(testScene1);
+    if (prepass) {
+        depthPrepass->end();
+    }
+    if (scaled) {
+        dynamicResolution->end();
+    }
 
-    printf("Created %d scenes\n", getSceneCount());
+    if (snapshot.frameTime - lastStatsReport >= 5.0) {
+        if (shadowMap) shadowMap->printStats();
+        if (depthPrepass) depthPrepass->printStats();
+        if (dynamicResolution) dynamicResolution->printStats();
+        if (impostors) impostors->printStats();
+        if (frameCapture) frameCapture->printStats();
+        if (snapshot.viewCount > 1) multiView.printStats();
+        RenderStats::printSummary();
+        resources.printStats();
+        lastStatsReport = snapshot.frameTime;
+    }
 }
 
 void Application::run() {
     float angle = 0.0f;
-    glm::vec3 lightPosition(0.0f, 0.0f, 0.0f); // Světlo na pozici [0,0,0]
+    double lastUpdateReport = glfwGetTime();
+    lastStatsReport = lastUpdateReport;
+    PROFILE_THREAD_NAME("Main");
+
+    // Render vlákno přebírá GL kontext, hlavní vlákno dělá vstup a update
+    FramePipeline* pipeline = nullptr;
+    RenderSnapshot localSnapshot;
+    sceneLoader.setFramesInFlight(framesInFlight);
+    if (framesInFlight > 0) {
+        pipeline = new FramePipeline(framesInFlight);
+        glfwMakeContextCurrent(NULL);
+        pipeline->start(
+            [this]() {
+                glfwMakeContextCurrent(mainWindow);
+                PROFILE_GPU_INITIALIZE();
+            },
+            [this](const RenderSnapshot& snapshot) {
+                renderFrame(snapshot);
+                if (frameCapture) frameCapture->capture(snapshot.viewportWidth, snapshot.viewportHeight);
+                {
+                    PROFILE_SCOPE("glfwSwapBuffers");
+                    glfwSwapBuffers(mainWindow);
+                }
+                if (snapshot.inputTimestamp > 0.0) {
+                    RenderStats::inputLatency(FramePipeline::now() - snapshot.inputTimestamp);
+                }
+                frameLimiter.frameSubmitted();
+                PROFILE_GPU_COLLECT();
+                RenderStats::endFrame(snapshot.frameIndex);
+                resources.endFrame();
+            },
+            [this]() {
+                if (frameCapture) frameCapture->finish();
+                frameLimiter.release();
+                PROFILE_GPU_SHUTDOWN();
+                glfwMakeContextCurrent(NULL);
+            });
+        printf("Render thread started (%d frames in flight)\n", pipeline->getFramesInFlight());
+    }
+    else {
+        PROFILE_GPU_INITIALIZE();
+    }
 
     while (!glfwWindowShouldClose(mainWindow)) {
+        PROFILE_SCOPE("Application::run frame");
+
+        glfwPollEvents();
+        consumeInput();
+
+        // Nic se nezměnilo - čeká se na událost, timeout kvůli výpisům a zavření okna
+        if (onDemandRendering && !needsRedraw()) {
+            idleWaits++;
+            glfwWaitEventsTimeout(0.5);
+            // Doba čekání se nepočítá do deltaTime (skok kamery po probuzení)
+            lastFrameTime = glfwGetTime();
+            continue;
+        }
+
+        // Volný slot - může čekat na render vlákno, vstup se proto čte až potom
+        RenderSnapshot* snapshot = pipeline ? pipeline->acquire() : &localSnapshot;
+        double updateStart = FramePipeline::now();
+
         // Výpočet delta time
         double currentFrame = glfwGetTime();
         deltaTime = static_cast<float>(currentFrame - lastFrameTime);
         lastFrameTime = currentFrame;
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // Zpracování vstupu co nejpozději před updatem kamery
+        double inputTimestamp = 0.0;
+        {
+            PROFILE_SCOPE("Controller::processInput");
+            glfwPollEvents();
+            consumeInput();
+            inputTimestamp = pendingInputTimestamp;
+            pendingInputTimestamp = 0.0;
+            if (controller) {
+                controller->processInput(deltaTime);
+            }
+        }
+
+        glm::vec3 pickOrigin, pickDirection;
+        if (controller && controller->takePick(pickOrigin, pickDirection)) {
+            pickObject(pickOrigin, pickDirection);
+        }
 
         angle += 0.01f; // rotace
 
-        // Zpracování vstupu
-        if (controller) {
-            controller->processInput(deltaTime);
+        buildSnapshot(*snapshot, angle);
+        snapshot->inputTimestamp = inputTimestamp;
+        markDrawn();
+
+        if (pipeline) {
+            pipeline->recordUpdate(updateStart, FramePipeline::now());
+            pipeline->submit(snapshot);
+        }
+        else {
+            renderFrame(*snapshot);
         }
 
-        // Vykreslení aktuální scény
-        if (currentSceneIndex >= 0 && currentSceneIndex < getSceneCount()) {
-            Scene* currentScene = scenes[currentSceneIndex];
-
-            for (const auto& drawable : currentScene->getObjects()) {
-                // Nastavení shader matric
-                if (camera && drawable->getShader()) {
-                    ShaderProgram* shader = drawable->getShader();
-                    shader->use(shader->getProgram());
-
-                    // Nastav matice
-                    shader->SetUniform("viewMatrix", camera->getViewMatrix());
-                    shader->SetUniform("projectionMatrix", camera->getProjectionMatrix());
-
-                    // Nastav lighting uniformy (pro Lambert a Phong shadery)
-                    shader->SetUniform("lightPosition", lightPosition);
-                    shader->SetUniform("cameraPosition", camera->getEye());
-
-                    if (currentSceneIndex == 3) {
-                        // Speciální pro scénu 3
-                        Transform* dynamicTransform = new Transform();
-                        dynamicTransform->addTransform(new Rotation(angle, glm::vec3(0.0f, 0.0f, 1.0f)));
-                        drawable->setTransform(dynamicTransform);
-                        drawable->draw();
-                        delete dynamicTransform;
-                    }
-                    else {
-                        // Ostatní
-                        drawable->draw();
-                    }
-                }
+        if (currentFrame - lastUpdateReport >= 5.0) {
+            if (pipeline) pipeline->printStats();
+            updateArena.printStats();
+            sceneLoader.printStats();
+            if (worldStreamer) worldStreamer->printStats();
+            if (onDemandRendering) {
+                printf("On-demand: %d frames rendered, %d idle waits\n", renderedFrames, idleWaits);
             }
+            if (frameLimiter.getMaxQueued() > 0) {
+                printf("Frame limiter: max %d queued, %lld waits, %.1f ms waited\n",
+                    frameLimiter.getMaxQueued(), frameLimiter.getWaits(), frameLimiter.getWaitTotalMs());
+            }
+            lastUpdateReport = currentFrame;
         }
 
-        glfwPollEvents();
-        glfwSwapBuffers(mainWindow);
+        if (!pipeline) {
+            if (frameCapture) frameCapture->capture(snapshot->viewportWidth, snapshot->viewportHeight);
+            glfwSwapBuffers(mainWindow);
+            if (inputTimestamp > 0.0) {
+                RenderStats::inputLatency(FramePipeline::now() - inputTimestamp);
+            }
+            frameLimiter.frameSubmitted();
+            PROFILE_GPU_COLLECT();
+            RenderStats::endFrame(snapshot->frameIndex);
+            resources.endFrame();
+        }
+    }
+
+    if (pipeline) {
+        pipeline->stop();
+        delete pipeline;
+        // Zpět do hlavního vlákna kvůli uvolnění GL objektů
+        glfwMakeContextCurrent(mainWindow);
+    }
+    else {
+        if (frameCapture) frameCapture->finish();
+        frameLimiter.release();
+        PROFILE_GPU_SHUTDOWN();
     }
+
+#if ZPG_PROFILING
+    if (Profiler::isCapturing()) {
+        toggleProfiler();
+    }
+#endif
+}
+
+bool Application::needsRedraw() const {
+    if (redrawRequested || currentSceneIndex != drawnSceneIndex) return true;
+    // Jen vstup, který Controller použil (pohyb myši bez tlačítka nic nemění)
+    if (pendingInputTimestamp > 0.0 || (controller && controller->isActive())) return true;
+    if (camera && camera->getRevision() != drawnCameraRevision) return true;
+    if (mainLight && mainLight->getRevision() != drawnLightRevision) return true;
+
+    if (currentSceneIndex >= 0 && currentSceneIndex < getSceneCount()) {
+        Scene* scene = getScene(currentSceneIndex);
+        // Animace, přidané objekty a změny transformací, shaderů a příznaků
+        if (scene->isAnimated()) return true;
+        if (worldStreamer && currentSceneIndex == streamedSceneIndex && worldStreamer->hasPendingWork()) return true;
+        if (scene->getRevision() != drawnSceneRevision) return true;
+        if (scene->getChangeRevision() != drawnChangeRevision) return true;
+    }
+    return false;
 }
 
-void Application::addShader(ShaderProgram* shader) {
-    shaderPrograms.push_back(shader);
+void Application::consumeInput() {
+    if (controller) {
+        double acted = controller->consume(inputQueue);
+        if (acted > 0.0 && pendingInputTimestamp == 0.0) {
+            pendingInputTimestamp = acted;
+        }
+    }
+    inputQueue.clear();
 }
 
-void Application::addModel(Model* model) {
-    modelList.push_back(model);
+void Application::markDrawn() {
+    redrawRequested = false;
+    drawnSceneIndex = currentSceneIndex;
+    drawnCameraRevision = camera ? camera->getRevision() : 0;
+    drawnLightRevision = mainLight ? mainLight->getRevision() : 0;
+    if (currentSceneIndex >= 0 && currentSceneIndex < getSceneCount()) {
+        Scene* scene = getScene(currentSceneIndex);
+        drawnSceneRevision = scene->getRevision();
+        drawnChangeRevision = scene->getChangeRevision();
+    }
+    renderedFrames++;
+}
+
+void Application::addShader(const string& name, ShaderProgram* shader) {
+    shaderPrograms.push_back(resources.addShader(name, shader));
+}
+
+void Application::addModel(const string& name, Model* model) {
+    resources.addModel(name, model);
 }
 
 void Application::addScene(Scene* scene) {
-    scenes.push_back(scene);
+    sceneLoader.addScene(scene);
+}
+
+void Application::addSceneFactory(const string& name, SceneFactory factory) {
+    // Scéna ze souboru má přednost před sestavením v kódu (to zůstává jako záloha)
+    if (!sceneDirectory.empty()) {
+        string path = sceneDirectory + "/scene" + to_string(getSceneCount() + 1) + ".zpgs";
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file) {
+            fclose(file);
+            SceneFactory fallback = factory;
+            factory = [this, path, fallback]() {
+                Scene* scene = SceneFile::load(path.c_str(), resources);
+                return scene ? scene : fallback();
+            };
+        }
+    }
+    sceneLoader.registerScene(name, factory);
+}
+
+int Application::exportScenes(const char* directory, int forestObjects) {
+    int failed = 0;
+    for (int s = 0; s < getSceneCount(); s++) {
+        Scene* scene = sceneLoader.acquire(s);
+        string path = string(directory) + "/scene" + to_string(s + 1) + ".zpgs";
+        if (!SceneFile::save(*scene, resources, path.c_str())) failed++;
+    }
+
+    if (forestObjects > 0) {
+        // Velký les pro měření načítání
+        ShaderProgram* shader = resources.getShader("original");
+        Scene* forest = SceneGenerator::generateForest("Forest", forestObjects, 42,
+            resources.getModel("tree"), shader, resources.getModel("bushes"), shader);
+        string path = string(directory) + "/forest.zpgs";
+        if (!SceneFile::save(*forest, resources, path.c_str())) failed++;
+        delete forest;
+
+        double start = FramePipeline::now();
+        Scene* loaded = SceneFile::load(path.c_str(), resources);
+        double ms = FramePipeline::now() - start;
+        if (loaded) {
+            printf("Loaded %s: %d objects in %.1f ms\n", path.c_str(), loaded->getObjectCount(), ms);
+            delete loaded;
+        }
+        else {
+            failed++;
+        }
+    }
+    return failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+Scene* Application::getScene(int index) const {
+    return sceneLoader.get(index);
+}
+
+void Application::pickObject(const glm::vec3& origin, const glm::vec3& direction) {
+    Scene* scene = currentSceneIndex >= 0 && currentSceneIndex < getSceneCount() ? getScene(currentSceneIndex) : nullptr;
+    if (!scene) return;
+
+    // World matice z posledního snímku = to, na co uživatel klikl
+    PickResult result = Picker::pick(*scene, origin, direction);
+    if (result.hit) {
+        Model* model = scene->getStorage().getModel(result.objectIndex);
+        printf("Pick: object %u (%s), triangle %d, distance %.3f (%d candidates, %d tested, %.3f ms)\n",
+            result.objectIndex, resources.getName(model).c_str(), result.triangle, result.distance,
+            result.candidates, result.tested, result.ms);
+    }
+    else {
+        printf("Pick: nothing (%d candidates, %.3f ms)\n", result.candidates, result.ms);
+    }
+}
+
+void Application::setWorldStreaming(bool enabled) {
+    if (enabled && !worldStreamer) {
+        worldStreamer = new WorldStreamer();
+    }
+    else if (!enabled && worldStreamer) {
+        delete worldStreamer;
+        worldStreamer = nullptr;
+    }
+}
+
+void Application::setSceneBudget(size_t megabytes) {
+    sceneLoader.setBudget(megabytes * 1024 * 1024);
+}
+
+ShaderProgram* Application::getShader(int index) const {
+    return resources.get(shaderPrograms[index]);
+}
+
+void Application::setVramBudget(size_t megabytes) {
+    resources.setVramBudget(megabytes * 1024 * 1024);
 }
 
 void Application::switchScene(int sceneIndex) {
     if (sceneIndex >= 0 && sceneIndex < getSceneCount()) {
+        // Předpřipravená scéna je hned k dispozici, jinak se postaví teď
+        Scene* scene = sceneLoader.acquire(sceneIndex);
+        int previousIndex = currentSceneIndex;
         currentSceneIndex = sceneIndex;
-        printf("Switched to scene %d: %s\n", sceneIndex + 1,
-            scenes[sceneIndex]->getName().c_str());
+        sceneLoader.onSwitch(previousIndex, sceneIndex);
+        printf("Switched to scene %d: %s\n", sceneIndex + 1, scene->getName().c_str());
     }
 }
 
@@ -746,9 +1435,15 @@ void Application::switchShader(int shaderIndex) {
     if (shaderIndex >= 0 && shaderIndex < getShaderCount()) {
         // Změň shader pro všechny objekty
         if (currentSceneIndex >= 0 && currentSceneIndex < getSceneCount()) {
-            Scene* currentScene = scenes[currentSceneIndex];
-            for (auto& drawable : currentScene->getObjects()) {
-                drawable->setShader(shaderPrograms[shaderIndex]);
+            Scene* currentScene = getScene(currentSceneIndex);
+            ShaderProgram* shader = getShader(shaderIndex);
+            // Přes úložiště - i objekty bez fasády
+            currentScene->setShader(shader);
+            // Uvolněná a znovu sestavená scéna si volbu ponechá
+            sceneLoader.setShader(currentSceneIndex, shader);
+            // Dlaždice vkládané později dostanou stejný shader
+            if (worldStreamer && currentSceneIndex == streamedSceneIndex) {
+                worldStreamer->setShader(shader);
             }
             const char* shaderNames[] = { "Original Colors", "Constant", "Lambert", "Phong", "Blinn"};
             printf("Switched to %s shader\n", shaderNames[shaderIndex]);
@@ -756,8 +1451,242 @@ void Application::switchShader(int shaderIndex) {
     }
 }
 
+void Application::toggleShadows() {
+    if (shadowMap) {
+        // Render vlákno převezme nastavení z dalšího snímku
+        shadowsEnabled = !shadowsEnabled;
+        printf("Shadows %s\n", shadowsEnabled ? "ON" : "OFF");
+    }
+}
+
+void Application::cycleDepthPrepass() {
+    // Render vlákno převezme režim z dalšího snímku
+    depthPrepassMode = depthPrepassMode == PREPASS_AUTO ? PREPASS_ON :
+        depthPrepassMode == PREPASS_ON ? PREPASS_OFF : PREPASS_AUTO;
+    printf("Depth pre-pass: %s\n", DepthPrepass::getModeName(depthPrepassMode));
+}
+
+void Application::toggleOverdrawView() {
+    overdrawView = !overdrawView;
+    printf("Overdraw view %s\n", overdrawView ? "ON" : "OFF");
+}
+
+void Application::toggleImpostors() {
+    impostorsEnabled = !impostorsEnabled;
+    printf("Impostors %s (distance %.1f)\n", impostorsEnabled ? "ON" : "OFF", impostorDistance);
+}
+
+void Application::toggleDrawLists() {
+    drawListsEnabled = !drawListsEnabled;
+    recordedSceneId = 0;
+    printf("Draw lists %s\n", drawListsEnabled ? "ON" : "OFF");
+}
+
+void Application::toggleProfiler() {
+#if ZPG_PROFILING
+    // Export až po zastavení, zapisující vlákna už nic nepřidávají
+    if (Profiler::isCapturing()) {
+        Profiler::endCapture();
+        Profiler::exportChromeTrace("zpg_trace.json");
+    }
+    else {
+        Profiler::beginCapture();
+    }
+#else
+    printf("Profiler is compiled out (ZPG_PROFILING=0)\n");
+#endif
+}
+
+FrameAverages Application::getFrameAverages() const {
+    return RenderStats::getAverages();
+}
+
+FrameCounters Application::getLastFrameCounters() const {
+    return RenderStats::getLastFrame();
+}
+
+void Application::setStatsCsv(const char* path) {
+    RenderStats::openCsv(path);
+}
+
+void Application::setFramesInFlight(int frames) {
+    framesInFlight = frames;
+    sceneLoader.setFramesInFlight(frames);
+}
+
+void Application::setBenchmark(const BenchmarkSettings& settings) {
+    if (benchmarkSettings) delete benchmarkSettings;
+    benchmarkSettings = new BenchmarkSettings(settings);
+}
+
+int Application::runBenchmark() {
+    if (!benchmarkSettings) return EXIT_FAILURE;
+
+    const BenchmarkSettings& settings = *benchmarkSettings;
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    string rendererName = renderer ? renderer : "unknown";
+
+    // Softwarový backend: stejné snímky, GL kontext jen pro načtení prostředků
+    SoftwareRasterizer* rasterizer = nullptr;
+    if (settings.backend == "software") {
+        rasterizer = new SoftwareRasterizer(jobSystem);
+        const char* shadingNames[] = { "original", "constant", "lambert", "phong", "blinn" };
+        const SoftwareShading shadingModels[] = { SOFTWARE_ATTRIBUTE, SOFTWARE_CONSTANT, SOFTWARE_LAMBERT, SOFTWARE_PHONG, SOFTWARE_BLINN };
+        for (int i = 0; i < 5; i++) {
+            ShaderHandle handle = resources.findShader(shadingNames[i]);
+            if (!handle.isNull()) rasterizer->setShading(resources.get(handle), shadingModels[i]);
+        }
+        rasterizer->setMaterials(materialTable);
+        // Rasterizér potřebuje položky každý snímek, záznam se nepřehrává
+        drawListsEnabled = false;
+        char name[64];
+        snprintf(name, sizeof(name), "Software rasterizer (%d threads)", jobSystem->getThreadCount());
+        rendererName = name;
+    }
+    BenchmarkReport report(settings, rendererName);
+    RenderSnapshot snapshot;
+    float angle = 0.0f;
+
+    printf("Benchmark: %d warm-up + %d measured frames per scene\n", settings.warmupFrames, settings.measuredFrames);
+
+    PROFILE_THREAD_NAME("Main");
+    PROFILE_GPU_INITIALIZE();
+#if ZPG_PROFILING
+    if (!settings.tracePath.empty()) {
+        Profiler::beginCapture();
+    }
+#endif
+
+    for (int s = 0; s < getSceneCount(); s++) {
+        if (!settings.scenes.empty() && find(settings.scenes.begin(), settings.scenes.end(), s) == settings.scenes.end()) {
+            continue;
+        }
+        switchScene(s);
+        Scene* scene = getScene(s);
+
+        int drawCalls = 0;
+        long long triangles = 0;
+        const ObjectStorage& storage = scene->getStorage();
+        for (size_t i = 0; i < storage.size(); i++) {
+            Model* model = storage.getModels()[i];
+            if (model && storage.getShaders()[i]) {
+                drawCalls++;
+                triangles += model->getNumberOfVertices() / 3;
+            }
+        }
+        report.beginScene(scene->getName(), scene->getObjectCount(), drawCalls, triangles);
+
+        int totalFrames = settings.warmupFrames + settings.measuredFrames;
+        for (int f = 0; f < totalFrames; f++) {
+            double frameStart = FramePipeline::now();
+
+            // Pevný krok, aby animace byly mezi běhy stejné
+            lastFrameTime = glfwGetTime();
+            deltaTime = 1.0f / 60.0f;
+            glfwPollEvents();
+            if (controller) {
+                controller->processInput(deltaTime);
+            }
+            double inputEnd = FramePipeline::now();
+
+            buildSnapshot(snapshot, angle);
+            double updateEnd = FramePipeline::now();
+
+            if (rasterizer) {
+                rasterizer->render(snapshot);
+            }
+            else {
+                renderFrame(snapshot);
+            }
+            double renderEnd = FramePipeline::now();
+
+            if (!rasterizer) {
+                glfwSwapBuffers(mainWindow);
+                glFinish();
+                PROFILE_GPU_COLLECT();
+            }
+            RenderStats::endFrame(snapshot.frameIndex);
+            resources.endFrame();
+            double frameEnd = FramePipeline::now();
+
+            angle += 0.01f;
+
+            if (f >= settings.warmupFrames) {
+                BenchmarkFrame frame;
+                frame.frameMs = frameEnd - frameStart;
+                frame.inputMs = inputEnd - frameStart;
+                frame.updateMs = updateEnd - inputEnd;
+                frame.renderMs = renderEnd - updateEnd;
+                frame.swapMs = frameEnd - renderEnd;
+                report.addFrame(frame);
+            }
+        }
+        if (rasterizer) {
+            rasterizer->printStats();
+            if (!settings.imagePrefix.empty()) {
+                rasterizer->writePPM((settings.imagePrefix + to_string(s) + ".ppm").c_str());
+            }
+        }
+        else if (depthPrepass) {
+            report.setDepthPrepass(depthPrepass->getStats().overdraw, depthPrepass->getStats().active);
+        }
+    }
+    if (rasterizer) delete rasterizer;
+
+    PROFILE_GPU_SHUTDOWN();
+#if ZPG_PROFILING
+    if (!settings.tracePath.empty()) {
+        Profiler::endCapture();
+        Profiler::exportChromeTrace(settings.tracePath.c_str());
+    }
+#endif
+
+    report.printSummary();
+    return report.write(settings.outputPath) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void Application::setJobThreads(int threads) {
+    jobThreads = threads;
+}
+
+void Application::runJobScaling(int objectCount) {
+    // Les jako ve scéně 7, jen s objectCount objekty
+    Scene* forest = SceneGenerator::generateForest("Job scaling", objectCount, 42, nullptr, nullptr, nullptr, nullptr);
+    ObjectStorage& storage = forest->getStorage();
+    storage.updateWorldMatrices();
+
+    glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 4.0f / 3.0f, 0.1f, 100.0f) *
+        glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    int maxThreads = static_cast<int>(thread::hardware_concurrency());
+    if (maxThreads < 1) maxThreads = 1;
+
+    printf("Job scaling: %d objects, %d iterations per run\n", objectCount, 20);
+    double singleThreadMs = 0.0;
+    for (int threads = 1; threads <= maxThreads; threads++) {
+        JobSystem jobs(threads - 1);
+        MatrixBatch batch;
+
+        // Zahřátí
+        for (int i = 0; i < 3; i++) {
+            batch.compute(storage, viewProjection, &jobs);
+        }
+
+        double start = FramePipeline::now();
+        for (int i = 0; i < 20; i++) {
+            batch.compute(storage, viewProjection, &jobs);
+        }
+        double ms = (FramePipeline::now() - start) / 20.0;
+        if (threads == 1) singleThreadMs = ms;
+
+        printf("  threads %2d: %8.3f ms  speedup %.2fx\n", threads, ms, singleThreadMs / ms);
+    }
+
+    delete forest;
+}
+
 int Application::getModelCount() const {
-    return static_cast<int>(modelList.size());
+    return resources.getModelCount();
 }
 
 int Application::getShaderCount() const {
@@ -765,7 +1694,7 @@ int Application::getShaderCount() const {
 }
 
 int Application::getSceneCount() const {
-    return static_cast<int>(scenes.size());
+    return sceneLoader.getCount();
 }
 
 // Callback Functions
@@ -779,15 +1708,14 @@ void Application::key_callback(GLFWwindow* window, int key, int scancode, int ac
 
     // Přepínání scén pomocí číslic 1–6
     if (instance != nullptr) {
-        if (instance->controller) {
-            if (action == GLFW_PRESS) {
-                instance->controller->onKeyPress(key);
-            }
-            else if (action == GLFW_RELEASE) {
-                instance->controller->onKeyRelease(key);
-            }
+        // Controller klávesu uvidí až při zpracování fronty před updatem
+        if (action == GLFW_PRESS || action == GLFW_RELEASE) {
+            instance->inputQueue.pushKey(key, action);
         }
 
+        // Stisk i uvolnění mění stav (pohyb kamery, přepínače)
+        instance->requestRedraw();
+
         // Přepínání scén pomocí číslic 1–8
         if (action == GLFW_PRESS) {
             if (key == GLFW_KEY_1) instance->switchScene(0);
@@ -804,6 +1732,19 @@ void Application::key_callback(GLFWwindow* window, int key, int scancode, int ac
             else if (key == GLFW_KEY_F3) instance->switchShader(2);
             else if (key == GLFW_KEY_F4) instance->switchShader(3);
             else if (key == GLFW_KEY_G) instance->switchShader(4);
+            // Zapnutí/vypnutí stínů
+            else if (key == GLFW_KEY_K) instance->toggleShadows();
+            // Zapnutí/vypnutí draw listů
+            else if (key == GLFW_KEY_L) instance->toggleDrawLists();
+            // Multi-view (split-screen)
+            else if (key == GLFW_KEY_M) instance->toggleMultiView();
+            // Hloubkový předprůchod auto/zapnuto/vypnuto a teplotní mapa overdraw
+            else if (key == GLFW_KEY_Z) instance->cycleDepthPrepass();
+            else if (key == GLFW_KEY_O) instance->toggleOverdrawView();
+            // Impostory vzdálené vegetace
+            else if (key == GLFW_KEY_I) instance->toggleImpostors();
+            // Start/stop záznamu profileru (stop zapíše zpg_trace.json)
+            else if (key == GLFW_KEY_P) instance->toggleProfiler();
         }
     }
 }
@@ -812,20 +1753,34 @@ void Application::window_focus_callback(GLFWwindow* window, int focused) {}
 void Application::window_iconify_callback(GLFWwindow* window, int iconified) {}
 
 void Application::window_size_callback(GLFWwindow* window, int width, int height) {
-    glViewport(0, 0, width, height);
+    // glViewport (a přealokování offscreen cíle) volá render vlákno podle snímku
+    if (instance != nullptr) {
+        instance->viewportWidth = width;
+        instance->viewportHeight = height;
+        instance->requestRedraw();
+    }
     if (instance != nullptr && instance->camera) {
         instance->camera->setProjectionMatrix(static_cast<float>(width), static_cast<float>(height));
     }
 }
 
 void Application::cursor_callback(GLFWwindow* window, double x, double y) {
-    if (instance != nullptr && instance->controller) {
-        instance->controller->onMouseMove(x, y);
+    // Kamera se neotáčí přímo v callbacku, pohyb se zpracuje před updatem snímku
+    if (instance != nullptr) {
+        instance->inputQueue.pushMouseMove(x, y);
     }
 }
 
 void Application::button_callback(GLFWwindow* window, int button, int action, int mode) {
-    if (instance != nullptr && instance->controller) {
-        instance->controller->onMouseButton(button, action);
+    if (instance != nullptr) {
+        instance->inputQueue.pushMouseButton(button, action);
+        instance->requestRedraw();
+    }
+}
+
+void Application::window_refresh_callback(GLFWwindow* window) {
+    // Odkrytí nebo změna okna - obsah je potřeba vykreslit znovu
+    if (instance != nullptr) {
+        instance->requestRedraw();
     }
 }
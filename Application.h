@@ -12,23 +12,112 @@
 #include "Camera.h"
 #include "Controller.h"
 #include "Light.h"
+#include "ShadowMap.h"
+#include "DepthPrepass.h"
+#include "DynamicResolution.h"
+#include "Impostors.h"
+#include "FrameCapture.h"
+#include "MaterialTable.h"
+#include "MatrixBatch.h"
+#include "RenderSnapshot.h"
+#include "FramePipeline.h"
+#include "JobSystem.h"
+#include "DrawList.h"
+#include "Benchmark.h"
+#include "RenderStats.h"
+#include "FrameArena.h"
+#include "ResourceManager.h"
+#include "InputQueue.h"
+#include "FrameLimiter.h"
+#include "MultiView.h"
+#include "SceneLoader.h"
+#include "WorldStreamer.h"
 
 using namespace std;
 
 class Application {
 private:
     GLFWwindow* mainWindow;
-    vector<ShaderProgram*> shaderPrograms;
-    vector<Model*> modelList;
-    vector<Scene*> scenes;
+    ResourceManager resources;          // vlastní modely, shadery a scény
+    vector<ShaderHandle> shaderPrograms; // pořadí pro F1-F4/G
+    SceneLoader sceneLoader;             // pořadí pro klávesy 1-8, scény se staví až při použití
+    string sceneDirectory;               // binární scény sceneN.zpgs (prázdné = jen z kódu)
     int currentSceneIndex;
 
     Camera* camera;
     Controller* controller;
+    InputQueue inputQueue;       // události z callbacků do dalšího updatu
+    double pendingInputTimestamp; // nejstarší použitá událost, kterou ještě žádný snímek neukázal (0 = není)
+    FrameLimiter frameLimiter;   // fence po swapu, omezuje snímky ve frontě ovladače
     float deltaTime;
     double lastFrameTime;
 
     Light* mainLight;
+    ShadowMap* shadowMap;
+    DepthPrepass* depthPrepass;  // render vlákno, nullptr = bez předprůchodu
+    DynamicResolution* dynamicResolution;  // render vlákno, nullptr = přímo do okna
+    Impostors* impostors;        // atlasy se pečou při načtení modelů, kreslí render vlákno
+    FrameCapture* frameCapture;  // render vlákno před swapem, nullptr = nezaznamenává
+    string capturePath;          // prázdné = bez záznamu
+    int captureFps;
+    MaterialTable* materialTable;    // UBO materiálů sdílený všemi shadery, objekty nesou index
+    MatrixBatch matrixBatch;
+    FrameArena updateArena;  // dočasná data buildSnapshot (hlavní vlákno + joby)
+    JobSystem* jobSystem;
+    int jobThreads;          // 0 = podle počtu jader
+    bool shadowsEnabled;
+    DepthPrepassMode depthPrepassMode;
+    bool overdrawView;           // teplotní mapa overdraw místo scény (klávesa O)
+    double resolutionTargetMs;   // cílový GPU čas snímku, 0 = dynamické rozlišení vypnuto
+    float resolutionMinScale;
+    float resolutionMaxScale;
+    float impostorDistance;      // vzdálenost, od které se vegetace kreslí jako impostor
+    bool impostorsEnabled;       // klávesa I
+    double lastStatsReport;      // periodický výpis stínů a čítačů
+
+    // Draw listy statických scén (záznam vlastní render vlákno)
+    bool drawListsEnabled;
+    unsigned int recordedSceneId;    // Scene::getId, 0 = nic
+    unsigned int recordedChangeRevision;
+    DrawList drawList;
+
+    // Streamovaný les místo scény 7 (nullptr = pevný les)
+    WorldStreamer* worldStreamer;
+    int streamedSceneIndex;
+
+    // Více pohledů v jednom průchodu (--views N, klávesa M)
+    MultiView multiView;
+    int multiViewCount;
+
+    // Headless benchmark (nullptr = interaktivní režim)
+    BenchmarkSettings* benchmarkSettings;
+
+    // Pipeline (0 = vše v hlavním vlákně)
+    int framesInFlight;
+    long long frameIndex;
+    int viewportWidth;
+    int viewportHeight;
+
+    // Vykreslování jen při změně (kamera, světlo, scéna, vstup, animace)
+    bool onDemandRendering;
+    bool redrawRequested;
+    int drawnSceneIndex;
+    unsigned int drawnCameraRevision;
+    unsigned int drawnLightRevision;
+    unsigned int drawnSceneRevision;
+    unsigned int drawnChangeRevision;
+    int renderedFrames;
+    int idleWaits;
+
+    void setupMultiView();
+    bool needsRedraw() const;
+    void markDrawn();
+    // Předá frontu událostí Controlleru a zapamatuje si čas první použité
+    void consumeInput();
+
+    // Hlavní vlákno: update scény do snímku; render vlákno: odeslání do GL
+    void buildSnapshot(RenderSnapshot& snapshot, float angle);
+    void renderFrame(const RenderSnapshot& snapshot);
 
     // Callback Functions
     static void error_callback(int error, const char* description);
@@ -36,6 +125,7 @@ private:
     static void window_focus_callback(GLFWwindow* window, int focused);
     static void window_iconify_callback(GLFWwindow* window, int iconified);
     static void window_size_callback(GLFWwindow* window, int width, int height);
+    static void window_refresh_callback(GLFWwindow* window);
     static void cursor_callback(GLFWwindow* window, double x, double y);
     static void button_callback(GLFWwindow* window, int button, int action, int mode);
 
@@ -52,15 +142,74 @@ public:
     void setupCamera();
     void run();
 
-    void addShader(ShaderProgram* shader);
-    void addModel(Model* model);
+    void addShader(const string& name, ShaderProgram* shader);
+    void addModel(const string& name, Model* model);
     void addScene(Scene* scene);
+    // Scéna se sestaví při prvním přepnutí (nebo dřív ve vlákně předpřípravy)
+    void addSceneFactory(const string& name, SceneFactory factory);
+    // nullptr, pokud scéna ještě není sestavená (aktuální je vždy)
+    Scene* getScene(int index) const;
+    // Rozpočet paměti sestavených scén v MB (0 = bez omezení), neaktivní se uvolňují
+    void setSceneBudget(size_t megabytes);
+    // Scény se načítají z directory/sceneN.zpgs, pokud soubor existuje
+    void setSceneDirectory(const string& directory) { sceneDirectory = directory; }
+    // Zapíše všechny scény do directory/sceneN.zpgs (+ les s forestObjects objekty), vrací exit kód
+    int exportScenes(const char* directory, int forestObjects);
+    // Scéna 7 jako neomezený les po dlaždicích kolem kamery (před createScenes)
+    void setWorldStreaming(bool enabled);
+    ShaderProgram* getShader(int index) const;
+    // Rozpočet VRAM pro modely v MB (0 = bez omezení)
+    void setVramBudget(size_t megabytes);
+    ResourceManager& getResources() { return resources; }
+    MaterialTable* getMaterials() { return materialTable; }
     void switchScene(int sceneIndex);
 
     int getModelCount() const;
     int getShaderCount() const;
     int getSceneCount() const;
     void switchShader(int shaderIndex); // NEW: Switch shader for current scene
+    void toggleShadows();
+    // Předprůchod: auto -> zapnuto -> vypnuto (klávesa Z)
+    void cycleDepthPrepass();
+    void setDepthPrepassMode(DepthPrepassMode mode) { depthPrepassMode = mode; }
+    void toggleOverdrawView();
+    // Offscreen rozlišení podle GPU času snímku (před initialization(), 0 = vypnuto)
+    void setDynamicResolution(double targetMs) { resolutionTargetMs = targetMs; }
+    void setResolutionScale(float minScale, float maxScale) { resolutionMinScale = minScale; resolutionMaxScale = maxScale; }
+    // Vzdálená vegetace jako impostory (0 = vždy plná geometrie)
+    void setImpostorDistance(float distance) { impostorDistance = distance; }
+    void toggleImpostors();
+    // Záznam snímků do .y4m/.raw nebo PNG s prefixem (před initialization(), vypne on-demand kreslení)
+    void setCapture(const string& path, int fps) { capturePath = path; captureFps = fps; }
+    void toggleDrawLists();
+    void toggleProfiler();
+    void toggleMultiView();
+    // Výběr objektu paprskem (levé tlačítko myši), výsledek se vypíše
+    void pickObject(const glm::vec3& origin, const glm::vec3& direction);
+    // Počet pohledů (2-4) před initialization(); hlavní kamera je vždy první
+    void setViewCount(int views) { multiViewCount = views; }
+    // Vynutí vykreslení dalšího snímku (události, které nejsou vidět v revizích)
+    void requestRedraw() { redrawRequested = true; }
+    // false = vykreslovat každý snímek jako dřív
+    void setOnDemandRendering(bool enabled) { onDemandRendering = enabled; }
+    void setFramesInFlight(int frames);
+    // Maximální počet snímků ve frontě ovladače (0 = bez omezení)
+    void setMaxQueuedFrames(int frames) { frameLimiter.setMaxQueued(frames); }
+    void setJobThreads(int threads);
+
+    // Čítače vykreslování (průměr přes posledních RenderStats::HISTORY snímků)
+    FrameAverages getFrameAverages() const;
+    FrameCounters getLastFrameCounters() const;
+    // Každý snímek jako řádek CSV
+    void setStatsCsv(const char* path);
+
+    // Headless režim: skryté okno s offscreen kontextem, bez vsync
+    void setBenchmark(const BenchmarkSettings& settings);
+    // Projde všechny scény a zapíše JSON, vrací exit kód
+    int runBenchmark();
+
+    // Měření škálování MatrixBatch přes 1..N vláken (nepotřebuje okno)
+    void runJobScaling(int objectCount);
 
     Camera* getCamera() const { return camera; }
     Controller* getController() const { return controller; }
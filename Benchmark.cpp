@@ -0,0 +1,120 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+
+BenchmarkReport::BenchmarkReport(const BenchmarkSettings& settings, const string& renderer)
+    : renderer(renderer), settings(settings) {
+}
+
+void BenchmarkReport::beginScene(const string& name, int objects, int drawCalls, long long triangles) {
+    SceneResult scene;
+    scene.name = name;
+    scene.objects = objects;
+    scene.drawCalls = drawCalls;
+    scene.triangles = triangles;
+    scene.overdraw = 0.0;
+    scene.depthPrepass = false;
+    scene.frames.reserve(settings.measuredFrames);
+    scenes.push_back(scene);
+}
+
+void BenchmarkReport::addFrame(const BenchmarkFrame& frame) {
+    if (!scenes.empty()) {
+        scenes.back().frames.push_back(frame);
+    }
+}
+
+void BenchmarkReport::setDepthPrepass(double overdraw, bool active) {
+    if (!scenes.empty()) {
+        scenes.back().overdraw = overdraw;
+        scenes.back().depthPrepass = active;
+    }
+}
+
+double BenchmarkReport::percentile(const vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    // Nearest-rank
+    size_t rank = static_cast<size_t>(ceil(q * sorted.size()));
+    if (rank < 1) rank = 1;
+    if (rank > sorted.size()) rank = sorted.size();
+    return sorted[rank - 1];
+}
+
+string BenchmarkReport::escape(const string& text) {
+    string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+void BenchmarkReport::printSummary() const {
+    for (const auto& scene : scenes) {
+        vector<double> times;
+        for (const auto& f : scene.frames) times.push_back(f.frameMs);
+        sort(times.begin(), times.end());
+        double mean = 0.0;
+        for (double t : times) mean += t;
+        if (!times.empty()) mean /= times.size();
+
+        printf("%-36s mean %7.3f ms  p50 %7.3f  p95 %7.3f  p99 %7.3f  (%d draws, %lld tris, overdraw %.2fx%s)\n",
+            scene.name.c_str(), mean, percentile(times, 0.50), percentile(times, 0.95),
+            percentile(times, 0.99), scene.drawCalls, scene.triangles, scene.overdraw,
+            scene.depthPrepass ? ", pre-pass" : "");
+    }
+}
+
+bool BenchmarkReport::write(const string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        printf("Unable to open benchmark output file: %s\n", path.c_str());
+        return false;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"renderer\": \"%s\",\n", escape(renderer).c_str());
+    fprintf(file, "  \"context\": \"%s\",\n", escape(settings.contextApi).c_str());
+    fprintf(file, "  \"backend\": \"%s\",\n", escape(settings.backend).c_str());
+    fprintf(file, "  \"width\": %d,\n  \"height\": %d,\n", settings.width, settings.height);
+    fprintf(file, "  \"warmup_frames\": %d,\n  \"measured_frames\": %d,\n", settings.warmupFrames, settings.measuredFrames);
+    fprintf(file, "  \"scenes\": [\n");
+
+    for (size_t s = 0; s < scenes.size(); s++) {
+        const SceneResult& scene = scenes[s];
+
+        vector<double> times;
+        double sums[5] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+        for (const auto& f : scene.frames) {
+            times.push_back(f.frameMs);
+            sums[0] += f.frameMs;
+            sums[1] += f.inputMs;
+            sums[2] += f.updateMs;
+            sums[3] += f.renderMs;
+            sums[4] += f.swapMs;
+        }
+        sort(times.begin(), times.end());
+        double n = scene.frames.empty() ? 1.0 : static_cast<double>(scene.frames.size());
+
+        fprintf(file, "    {\n");
+        fprintf(file, "      \"index\": %d,\n", static_cast<int>(s));
+        fprintf(file, "      \"name\": \"%s\",\n", escape(scene.name).c_str());
+        fprintf(file, "      \"objects\": %d,\n", scene.objects);
+        fprintf(file, "      \"draw_calls\": %d,\n", scene.drawCalls);
+        fprintf(file, "      \"triangles\": %lld,\n", scene.triangles);
+        fprintf(file, "      \"overdraw\": %.3f,\n", scene.overdraw);
+        fprintf(file, "      \"depth_prepass\": %s,\n", scene.depthPrepass ? "true" : "false");
+        fprintf(file, "      \"frame_ms\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"min\": %.4f, \"max\": %.4f },\n",
+            sums[0] / n, percentile(times, 0.50), percentile(times, 0.95), percentile(times, 0.99),
+            times.empty() ? 0.0 : times.front(), times.empty() ? 0.0 : times.back());
+        fprintf(file, "      \"stage_cpu_ms\": { \"input\": %.4f, \"update\": %.4f, \"render\": %.4f, \"swap\": %.4f }\n",
+            sums[1] / n, sums[2] / n, sums[3] / n, sums[4] / n);
+        fprintf(file, "    }%s\n", s + 1 < scenes.size() ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    printf("Benchmark results written to %s\n", path.c_str());
+    return true;
+}
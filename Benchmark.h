@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Nastavení headless benchmarku (--benchmark)
+struct BenchmarkSettings {
+    int warmupFrames;
+    int measuredFrames;
+    int width;
+    int height;
+    string outputPath;
+    string contextApi;       // "osmesa", "egl" nebo "native"
+    string tracePath;        // Chrome trace celého běhu (prázdné = bez záznamu)
+    string backend;          // "gl" nebo "software" (SoftwareRasterizer místo GL)
+    vector<int> scenes;      // indexy měřených scén (prázdné = všechny)
+    string imagePrefix;      // software: poslední snímek scény do <prefix><index>.ppm
+
+    BenchmarkSettings()
+        : warmupFrames(60), measuredFrames(300), width(800), height(600),
+        outputPath("benchmark_results.json"), contextApi("osmesa"), backend("gl") {}
+};
+
+// Časy jednoho snímku v ms
+struct BenchmarkFrame {
+    double frameMs;
+    double inputMs;
+    double updateMs;
+    double renderMs;
+    double swapMs;           // swap + glFinish (čekání na GPU)
+};
+
+// Sběr výsledků po scénách a zápis do JSON
+class BenchmarkReport {
+private:
+    struct SceneResult {
+        string name;
+        int objects;
+        int drawCalls;
+        long long triangles;
+        double overdraw;         // 0 = neměřeno
+        bool depthPrepass;       // předprůchod na konci měření scény
+        vector<BenchmarkFrame> frames;
+    };
+
+    vector<SceneResult> scenes;
+    string renderer;
+    BenchmarkSettings settings;
+
+    static double percentile(const vector<double>& sorted, double q);
+    static string escape(const string& text);
+public:
+    BenchmarkReport(const BenchmarkSettings& settings, const string& renderer);
+
+    void beginScene(const string& name, int objects, int drawCalls, long long triangles);
+    void addFrame(const BenchmarkFrame& frame);
+    // Změřený overdraw a rozhodnutí předprůchodu pro aktuální scénu
+    void setDepthPrepass(double overdraw, bool active);
+
+    void printSummary() const;
+    bool write(const string& path) const;
+};
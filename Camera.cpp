@@ -11,7 +11,10 @@ Camera::Camera()
     alpha(glm::pi<float>() / 2.0f),     // 90 stupňů (pohled dolů)
     fi(3.0f * glm::pi<float>() / 2.0f), // 270° - kouká na k objektům)
     speed(5.0f),
-    sensitivity(0.005f) {
+    sensitivity(0.005f),
+    viewportWidth(800.0f),
+    viewportHeight(600.0f),
+    revision(0) {
 
     viewMatrix = glm::mat4(1.0f);
     projectionMatrix = glm::mat4(1.0f);
@@ -44,7 +47,11 @@ void Camera::clampAngles() {
 }
 
 void Camera::updateViewMatrix() {
-    viewMatrix = glm::lookAt(eye, eye + target, up);
+    glm::mat4 view = glm::lookAt(eye, eye + target, up);
+    if (view != viewMatrix) {
+        viewMatrix = view;
+        revision++;
+    }
 }
 
 void Camera::moveForward(float deltaTime) {
@@ -93,17 +100,34 @@ void Camera::rotate(float deltaX, float deltaY) {
 }
 
 void Camera::setProjectionMatrix(float width, float height) {
+    viewportWidth = width;
+    viewportHeight = height;
     float aspectRatio = width / height;
-    projectionMatrix = glm::perspective(
+    glm::mat4 projection = glm::perspective(
         glm::radians(60.0f),  // POV
         aspectRatio,           // průměr
         0.1f,                  // poblíž
         100.0f                 // Daleko
     );
+    if (projection != projectionMatrix) {
+        projectionMatrix = projection;
+        revision++;
+    }
 
     notify();
 }
 
+void Camera::getRay(double x, double y, glm::vec3& origin, glm::vec3& direction) const {
+    // Okno -> NDC -> world přes inverzi projection * view
+    float ndcX = static_cast<float>(2.0 * x / viewportWidth - 1.0);
+    float ndcY = static_cast<float>(1.0 - 2.0 * y / viewportHeight);
+    glm::mat4 inverseViewProjection = glm::inverse(projectionMatrix * viewMatrix);
+    glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+
+    origin = eye;
+    direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - eye);
+}
+
 void Camera::attach(Observer* observer) {
     if (observer) {
         observers.push_back(observer);
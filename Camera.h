@@ -21,8 +21,11 @@ private:
 
     glm::mat4 viewMatrix;
     glm::mat4 projectionMatrix;
+    float viewportWidth;     // rozměry z setProjectionMatrix (pro paprsek z myši)
+    float viewportHeight;
 
     vector<Observer*> observers;
+    unsigned int revision;   // zvyšuje se při skutečné změně view nebo projekční matice
 
     void updateViewMatrix();
     void updateTargetVector();
@@ -34,6 +37,7 @@ public:
 
     glm::mat4 getViewMatrix() const { return viewMatrix; }
     glm::mat4 getProjectionMatrix() const { return projectionMatrix; }
+    unsigned int getRevision() const { return revision; }
 
     void moveForward(float deltaTime);
     void moveBackward(float deltaTime);
@@ -55,4 +59,7 @@ public:
 
     // Nastavení
     void setProjectionMatrix(float width, float height);
+
+    // Paprsek z oka přes bod okna (x, y v pixelech, y shora)
+    void getRay(double x, double y, glm::vec3& origin, glm::vec3& direction) const;
 };
\ No newline at end of file
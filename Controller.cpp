@@ -1,10 +1,12 @@
 ﻿#include "Controller.h"
 #include "Camera.h"
+#include "InputQueue.h"
 #include <GLFW/glfw3.h>
 #include <cstring>
 
 Controller::Controller(Camera* cam)
-    : camera(cam), lastMouseX(0.0), lastMouseY(0.0), mousePressed(false) {
+    : camera(cam), lastMouseX(0.0), lastMouseY(0.0), mousePressed(false),
+    pendingDeltaX(0.0), pendingDeltaY(0.0), pickPending(false) {
 
     std::memset(keys, 0, sizeof(keys));
 }
@@ -25,12 +27,8 @@ void Controller::onKeyRelease(int key) {
 
 void Controller::onMouseMove(double x, double y) {
     if (mousePressed) {
-        double deltaX = x - lastMouseX;
-        double deltaY = y - lastMouseY;
-
-        if (camera) {
-            camera->rotate(static_cast<float>(deltaX), static_cast<float>(deltaY));
-        }
+        pendingDeltaX += x - lastMouseX;
+        pendingDeltaY += y - lastMouseY;
     }
 
     lastMouseX = x;
@@ -46,6 +44,19 @@ void Controller::onMouseButton(int button, int action) {
             mousePressed = false;
         }
     }
+    else if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && camera) {
+        // Paprsek z kamery přes kurzor - kamera je ve stavu, který uživatel viděl při kliknutí
+        camera->getRay(lastMouseX, lastMouseY, pickOrigin, pickDirection);
+        pickPending = true;
+    }
+}
+
+bool Controller::takePick(glm::vec3& origin, glm::vec3& direction) {
+    if (!pickPending) return false;
+    origin = pickOrigin;
+    direction = pickDirection;
+    pickPending = false;
+    return true;
 }
 
 bool Controller::isKeyPressed(int key) const {
@@ -55,9 +66,60 @@ bool Controller::isKeyPressed(int key) const {
     return false;
 }
 
+bool Controller::isMovementKey(int key) {
+    return key == GLFW_KEY_W || key == GLFW_KEY_S || key == GLFW_KEY_A || key == GLFW_KEY_D;
+}
+
+double Controller::consume(InputQueue& queue) {
+    double oldestActed = 0.0;
+
+    // Pořadí událostí se zachová (stisk tlačítka před pohybem myši)
+    for (const InputEvent& e : queue.getEvents()) {
+        bool acted = false;
+        switch (e.type) {
+        case INPUT_KEY: {
+            bool wasPressed = isKeyPressed(e.code);
+            if (e.action == GLFW_PRESS) onKeyPress(e.code);
+            else if (e.action == GLFW_RELEASE) onKeyRelease(e.code);
+            acted = isMovementKey(e.code) && isKeyPressed(e.code) != wasPressed;
+            break;
+        }
+        case INPUT_MOUSE_BUTTON: {
+            bool wasPicking = pickPending;
+            onMouseButton(e.code, e.action);
+            acted = pickPending && !wasPicking;
+            break;
+        }
+        case INPUT_MOUSE_MOVE:
+            // Bez pravého tlačítka se jen zapamatuje pozice kurzoru
+            acted = mousePressed && (e.x != lastMouseX || e.y != lastMouseY);
+            onMouseMove(e.x, e.y);
+            break;
+        }
+        if (acted && oldestActed == 0.0) {
+            oldestActed = e.timestamp;
+        }
+    }
+    queue.clear();
+    return oldestActed;
+}
+
+bool Controller::isActive() const {
+    return pendingDeltaX != 0.0 || pendingDeltaY != 0.0 ||
+        isKeyPressed(GLFW_KEY_W) || isKeyPressed(GLFW_KEY_S) ||
+        isKeyPressed(GLFW_KEY_A) || isKeyPressed(GLFW_KEY_D);
+}
+
 void Controller::processInput(float deltaTime) {
     if (!camera) return;
 
+    // Otočení myší
+    if (pendingDeltaX != 0.0 || pendingDeltaY != 0.0) {
+        camera->rotate(static_cast<float>(pendingDeltaX), static_cast<float>(pendingDeltaY));
+        pendingDeltaX = 0.0;
+        pendingDeltaY = 0.0;
+    }
+
     // WSAD pohyb
     if (isKeyPressed(GLFW_KEY_W)) {
         camera->moveForward(deltaTime);
@@ -1,6 +1,8 @@
 #pragma once
+#include <glm/glm.hpp>
 
 class Camera;
+class InputQueue;
 
 class Controller {
 private:
@@ -9,15 +11,31 @@ private:
     double lastMouseX;
     double lastMouseY;
     bool mousePressed;
+    // Otočení nasbírané z pohybů myši, kamera ho dostane až v processInput
+    double pendingDeltaX;
+    double pendingDeltaY;
+    // Paprsek levého kliknutí, zpracuje ho aplikace (výběr objektu)
+    bool pickPending;
+    glm::vec3 pickOrigin;
+    glm::vec3 pickDirection;
 public:
     Controller(Camera* cam);
     ~Controller();
 
     bool isKeyPressed(int key) const;
+    static bool isMovementKey(int key);
     void onKeyPress(int key);
     void onKeyRelease(int key);
+    // Zpracuje a vyprázdní frontu událostí. Vrací čas nejstarší události, která
+    // něco změnila (pohybová klávesa, otočení, výběr), 0 = žádná - pohyb myši
+    // bez tlačítka nebo nepoužitá klávesa překreslení nevyvolá.
+    double consume(InputQueue& queue);
     void processInput(float deltaTime);
+    // true, pokud další processInput pohne kamerou (držená klávesa, otočení)
+    bool isActive() const;
 
     void onMouseMove(double x, double y);
     void onMouseButton(int button, int action);
+    // Vrátí a zruší čekající paprsek výběru
+    bool takePick(glm::vec3& origin, glm::vec3& direction);
 };
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include "DepthPrepass.h"
+#include "RenderSnapshot.h"
+#include "DrawList.h"
+#include "ShaderProgram.h"
+#include "Model.h"
+#include "Impostors.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <stdio.h>
+
+DepthPrepass::DepthPrepass()
+    : depthShader(nullptr), mvpLocation(-1), heatShader(nullptr), heatColorLocation(-1), heatVao(0),
+    depthQuery(0), shadedQuery(0), queryPending(false), measuring(false),
+    mode(PREPASS_AUTO), autoActive(false), frameActive(false), frameOverdraw(false),
+    lastSceneId(0), framesSinceProbe(0) {
+    stats = DepthPrepassStats{ 0.0, 0, 0, 0, 0, false };
+}
+
+DepthPrepass::~DepthPrepass() {
+    if (depthShader) delete depthShader;
+    if (heatShader) delete heatShader;
+    if (heatVao) glDeleteVertexArrays(1, &heatVao);
+    if (depthQuery) glDeleteQueries(1, &depthQuery);
+    if (shadedQuery) glDeleteQueries(1, &shadedQuery);
+}
+
+bool DepthPrepass::initialize() {
+    depthShader = new ShaderProgram();
+    if (!depthShader->loadShaderFromFiles("depth_prepass.vert", "depth_prepass.frag")) {
+        printf("Loading depth pre-pass shader from files failed, using hardcoded version\n");
+        const char* vertex_shader =
+            "#version 330 core\n"
+            "layout(location=0) in vec3 vp;"
+            "uniform mat4 mvpMatrix;"
+            "invariant gl_Position;"
+            "void main() { gl_Position = mvpMatrix * vec4(vp, 1.0); }";
+
+        const char* fragment_shader =
+            "#version 330\n"
+            "void main() {}";
+
+        if (!depthShader->loadMainShader(vertex_shader, fragment_shader)) {
+            return false;
+        }
+    }
+    mvpLocation = glGetUniformLocation(depthShader->getProgram(), "mvpMatrix");
+
+    // Teplotní mapa: trojúhelník přes celou obrazovku z gl_VertexID, barva podle úrovně stencilu
+    const char* heat_vertex_shader =
+        "#version 330 core\n"
+        "void main() {"
+        "    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);"
+        "    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);"
+        "}";
+    const char* heat_fragment_shader =
+        "#version 330\n"
+        "uniform vec4 heatColor;"
+        "out vec4 fragColor;"
+        "void main() { fragColor = heatColor; }";
+    heatShader = new ShaderProgram();
+    if (heatShader->loadMainShader(heat_vertex_shader, heat_fragment_shader)) {
+        heatColorLocation = glGetUniformLocation(heatShader->getProgram(), "heatColor");
+        glGenVertexArrays(1, &heatVao);
+    }
+    else {
+        printf("Overdraw visualization shader failed, visualization disabled\n");
+        delete heatShader;
+        heatShader = nullptr;
+    }
+
+    glGenQueries(1, &depthQuery);
+    glGenQueries(1, &shadedQuery);
+
+    printf("Depth pre-pass initialized (mode %s)\n", getModeName(mode));
+    return true;
+}
+
+void DepthPrepass::collectQueries() {
+    // Stejně jako u stínové mapy - výsledek se čte, až je k dispozici
+    if (!queryPending) return;
+    GLint available = 0;
+    glGetQueryObjectiv(shadedQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    GLuint64 depthSamples = 0;
+    GLuint64 shadedSamples = 0;
+    glGetQueryObjectui64v(depthQuery, GL_QUERY_RESULT, &depthSamples);
+    glGetQueryObjectui64v(shadedQuery, GL_QUERY_RESULT, &shadedSamples);
+    queryPending = false;
+
+    stats.depthSamples = depthSamples;
+    stats.shadedSamples = shadedSamples;
+    stats.overdraw = shadedSamples > 0 ? static_cast<double>(depthSamples) / shadedSamples : 1.0;
+    stats.measurements++;
+
+    // Hystereze, aby se rozhodnutí nepřeklápělo na hranici
+    bool wanted = autoActive ? stats.overdraw >= DISABLE_OVERDRAW : stats.overdraw >= ENABLE_OVERDRAW;
+    if (mode == PREPASS_AUTO && wanted != autoActive) {
+        autoActive = wanted;
+        stats.switches++;
+        printf("Depth pre-pass %s (overdraw %.2fx)\n", autoActive ? "ON" : "OFF", stats.overdraw);
+    }
+}
+
+void DepthPrepass::begin(const RenderSnapshot& frame, const vector<RenderItem>& items, const DrawList* drawList, const Impostors* impostors) {
+    PROFILE_SCOPE("DepthPrepass::begin");
+    collectQueries();
+    mode = static_cast<DepthPrepassMode>(frame.depthPrepassMode);
+    frameOverdraw = frame.showOverdraw && heatShader;
+
+    // Jiná scéna má jiný overdraw - změří se hned
+    bool probe = false;
+    if (frame.sceneId != lastSceneId) {
+        lastSceneId = frame.sceneId;
+        probe = true;
+    }
+    if (++framesSinceProbe >= PROBE_INTERVAL) {
+        probe = true;
+    }
+
+    frameActive = mode == PREPASS_ON || (mode == PREPASS_AUTO && (autoActive || probe));
+    stats.active = frameActive;
+    measuring = frameActive && !queryPending;
+    if (measuring) framesSinceProbe = 0;
+
+    if (frameOverdraw) {
+        // Stencil počítá fragmenty, které prošly hloubkou ve stínovacím průchodu
+        glClear(GL_STENCIL_BUFFER_BIT);
+    }
+
+    if (frameActive) {
+        PROFILE_GPU_SCOPE("DepthPrepass");
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+        if (measuring) glBeginQuery(GL_SAMPLES_PASSED, depthQuery);
+
+        glUseProgram(depthShader->getProgram());
+        RenderStats::programBind();
+        if (drawList) {
+            drawList->replayDepth(mvpLocation, impostors);
+        }
+        else {
+            // Jen to, co stínovací průchod opravdu kreslí
+            for (const auto& item : items) {
+                if (!item.model || !item.shader) continue;
+                if (impostors && impostors->replaces(item.model, item.matrices.model)) continue;
+                glUniformMatrix4fv(mvpLocation, 1, GL_FALSE, glm::value_ptr(item.matrices.mvp));
+                RenderStats::uniformUpload();
+                item.model->draw();
+            }
+        }
+
+        if (measuring) glEndQuery(GL_SAMPLES_PASSED);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_FALSE);
+        glDepthFunc(GL_EQUAL);
+    }
+
+    if (measuring) glBeginQuery(GL_SAMPLES_PASSED, shadedQuery);
+    if (frameOverdraw) {
+        glEnable(GL_STENCIL_TEST);
+        glStencilFunc(GL_ALWAYS, 0, 0xFF);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+    }
+}
+
+void DepthPrepass::end() {
+    if (measuring) {
+        glEndQuery(GL_SAMPLES_PASSED);
+        queryPending = true;
+        measuring = false;
+    }
+    if (frameActive) {
+        // Depth mask musí být zapnutá kvůli glClear v dalším snímku
+        glDepthMask(GL_TRUE);
+        glDepthFunc(GL_LESS);
+    }
+    if (frameOverdraw) {
+        drawHeatMap();
+        glDisable(GL_STENCIL_TEST);
+    }
+}
+
+void DepthPrepass::drawHeatMap() {
+    PROFILE_GPU_SCOPE("Overdraw heat map");
+    // 0 černá, 1 modrá, 2 zelená, 3 žlutá, 4 oranžová, 5+ červená
+    static const float colors[HEAT_LEVELS][4] = {
+        { 0.0f, 0.0f, 0.0f, 1.0f },
+        { 0.0f, 0.2f, 0.8f, 1.0f },
+        { 0.0f, 0.7f, 0.2f, 1.0f },
+        { 0.9f, 0.9f, 0.0f, 1.0f },
+        { 1.0f, 0.5f, 0.0f, 1.0f },
+        { 1.0f, 0.0f, 0.0f, 1.0f }
+    };
+
+    glDisable(GL_DEPTH_TEST);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    glUseProgram(heatShader->getProgram());
+    glBindVertexArray(heatVao);
+    for (int level = 0; level < HEAT_LEVELS; level++) {
+        // Poslední úroveň: ref <= stencil
+        glStencilFunc(level == HEAT_LEVELS - 1 ? GL_LEQUAL : GL_EQUAL, level, 0xFF);
+        glUniform4fv(heatColorLocation, 1, colors[level]);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        RenderStats::drawCall(3);
+    }
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+}
+
+const char* DepthPrepass::getModeName(DepthPrepassMode mode) {
+    switch (mode) {
+    case PREPASS_OFF: return "off";
+    case PREPASS_ON: return "on";
+    default: return "auto";
+    }
+}
+
+void DepthPrepass::printStats() const {
+    printf("Depth pre-pass: mode %s, %s, overdraw %.2fx (%llu depth / %llu shaded samples, %d measurements, %d switches)\n",
+        getModeName(mode), stats.active ? "active" : "inactive", stats.overdraw,
+        stats.depthSamples, stats.shadedSamples, stats.measurements, stats.switches);
+}
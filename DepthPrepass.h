@@ -0,0 +1,83 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+
+using namespace std;
+
+class ShaderProgram;
+class DrawList;
+class Impostors;
+struct RenderSnapshot;
+struct RenderItem;
+
+enum DepthPrepassMode {
+    PREPASS_OFF,
+    PREPASS_ON,
+    PREPASS_AUTO             // zapne se podle změřeného overdraw
+};
+
+// Statistiky hloubkového předprůchodu
+struct DepthPrepassStats {
+    double overdraw;             // fragmenty prošlé hloubkou bez předprůchodu / viditelné pixely
+    unsigned long long depthSamples;
+    unsigned long long shadedSamples;
+    int measurements;
+    int switches;                // změny rozhodnutí v režimu AUTO
+    bool active;                 // předprůchod v posledním snímku
+};
+
+// Hloubkový předprůchod (jen pozice, bez barvy) a stínování s GL_EQUAL,
+// takže drahý fragment shader běží na pixel jednou.
+// Overdraw se měří occlusion dotazy ve snímcích s předprůchodem: vzorky prošlé
+// hloubkou v předprůchodu = fragmenty, které by se bez něj stínovaly, vzorky
+// stínovacího průchodu = viditelné pixely. V režimu AUTO se bez předprůchodu
+// jednou za PROBE_INTERVAL snímků (a po změně scény) změří znovu.
+// Vizualizace počítá stínované fragmenty na pixel do stencilu a zobrazí teplotní mapu.
+class DepthPrepass {
+private:
+    static const int PROBE_INTERVAL = 240;
+    static const int HEAT_LEVELS = 6;            // 0, 1, ..., 5 a více fragmentů
+    static constexpr double ENABLE_OVERDRAW = 1.5;
+    static constexpr double DISABLE_OVERDRAW = 1.25;
+
+    ShaderProgram* depthShader;
+    GLint mvpLocation;
+    ShaderProgram* heatShader;
+    GLint heatColorLocation;
+    GLuint heatVao;              // prázdné VAO pro trojúhelník přes celou obrazovku
+
+    GLuint depthQuery;
+    GLuint shadedQuery;
+    bool queryPending;
+    bool measuring;              // dotazy běží v tomto snímku
+
+    DepthPrepassMode mode;
+    bool autoActive;             // rozhodnutí režimu AUTO
+    bool frameActive;            // předprůchod v tomto snímku (do end)
+    bool frameOverdraw;
+    unsigned int lastSceneId;
+    int framesSinceProbe;
+
+    DepthPrepassStats stats;
+
+    void collectQueries();
+    void drawHeatMap();
+public:
+    DepthPrepass();
+    ~DepthPrepass();
+
+    bool initialize();
+
+    // Před stínovacím průchodem (render vlákno): podle režimu ze snímku vykreslí hloubku
+    // a přepne test na GL_EQUAL. drawList != nullptr = hloubka z přehrávaného záznamu,
+    // položky nahrazené impostory se vynechají (jejich hloubka už je v bufferu).
+    void begin(const RenderSnapshot& frame, const vector<RenderItem>& items, const DrawList* drawList, const Impostors* impostors);
+    // Po stínovacím průchodu: vrátí hloubkový test, ukončí dotazy, případně nakreslí overdraw
+    void end();
+
+    DepthPrepassMode getMode() const { return mode; }
+    const DepthPrepassStats& getStats() const { return stats; }
+    void printStats() const;
+
+    static const char* getModeName(DepthPrepassMode mode);
+};
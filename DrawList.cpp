@@ -0,0 +1,158 @@
+#include "DrawList.h"
+#include "ShaderProgram.h"
+#include "ShadowMap.h"
+#include "Model.h"
+#include "Impostors.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <functional>
+
+DrawList::DrawList() : viewProjection(1.0f), recorded(false) {}
+
+void DrawList::clear() {
+    commands.clear();
+    matrices.clear();
+    items.clear();
+    // Lokace platí jen pro programy tohoto záznamu - smazaný program může mít stejné id jako nový
+    programs.clear();
+    recorded = false;
+}
+
+int DrawList::findProgramState(GLuint program) {
+    for (size_t i = 0; i < programs.size(); i++) {
+        if (programs[i].program == program) return static_cast<int>(i);
+    }
+
+    // Lokace se zjistí jednou při záznamu, přehrání je jen čte
+    ProgramState state;
+    state.program = program;
+    state.modelMatrix = glGetUniformLocation(program, "modelMatrix");
+    state.mvpMatrix = glGetUniformLocation(program, "mvpMatrix");
+    state.normalMatrix = glGetUniformLocation(program, "normalMatrix");
+    state.materialIndex = glGetUniformLocation(program, "materialIndex");
+    state.lightPosition = glGetUniformLocation(program, "lightPosition");
+    state.cameraPosition = glGetUniformLocation(program, "cameraPosition");
+    state.shadowMap = glGetUniformLocation(program, "shadowMap");
+    state.shadowFarPlane = glGetUniformLocation(program, "shadowFarPlane");
+    state.shadowsEnabled = glGetUniformLocation(program, "shadowsEnabled");
+    state.frameUniforms = (state.lightPosition != -1) + (state.cameraPosition != -1) + (state.shadowMap != -1) +
+        (state.shadowsEnabled != -1) + (state.shadowFarPlane != -1);
+    state.objectUniforms = (state.modelMatrix != -1) + (state.mvpMatrix != -1) + (state.normalMatrix != -1);
+    programs.push_back(state);
+    return static_cast<int>(programs.size() - 1);
+}
+
+void DrawList::record(const RenderSnapshot& snapshot) {
+    clear();
+    items = snapshot.items;
+    viewProjection = snapshot.viewProjection;
+
+    for (const auto& item : snapshot.items) {
+        if (!item.model || !item.shader) continue;
+
+        DrawCommand cmd;
+        cmd.program = item.shader->getProgram();
+        cmd.model = item.model;
+        cmd.matrixOffset = static_cast<int>(matrices.size());
+        cmd.firstVertex = 0;
+        cmd.vertexCount = item.model->getNumberOfVertices();
+        cmd.programState = findProgramState(cmd.program);
+        cmd.material = item.material;
+        commands.push_back(cmd);
+        matrices.push_back(item.matrices);
+    }
+
+    // Méně přepínání stavu: seřazení podle programu, pak modelu (VAO) a materiálu
+    sort(commands.begin(), commands.end(), [](const DrawCommand& a, const DrawCommand& b) {
+        if (a.program != b.program) return a.program < b.program;
+        if (a.model != b.model) return less<Model*>()(a.model, b.model);
+        return a.material < b.material;
+    });
+
+    recorded = true;
+}
+
+void DrawList::updateViewProjection(const glm::mat4& vp) {
+    if (!recorded || vp == viewProjection) return;
+
+    viewProjection = vp;
+    for (auto& m : matrices) {
+        MatrixBatch::multiply(viewProjection, m.model, m.mvp);
+    }
+}
+
+void DrawList::replayDepth(GLint mvpLocation, const Impostors* impostors) const {
+    PROFILE_SCOPE("DrawList::replayDepth");
+    Model* currentModel = nullptr;
+    for (const auto& cmd : commands) {
+        if (impostors && impostors->replaces(cmd.model, matrices[cmd.matrixOffset].model)) continue;
+        glUniformMatrix4fv(mvpLocation, 1, GL_FALSE, glm::value_ptr(matrices[cmd.matrixOffset].mvp));
+        RenderStats::uniformUpload();
+
+        if (cmd.model != currentModel) {
+            glBindVertexArray(cmd.model->getVAO());
+            currentModel = cmd.model;
+            RenderStats::vaoBind();
+        }
+        glDrawArrays(GL_TRIANGLES, cmd.firstVertex, cmd.vertexCount);
+        RenderStats::drawCall(cmd.vertexCount);
+    }
+    glBindVertexArray(0);
+}
+
+void DrawList::replay(const RenderSnapshot& snapshot, ShadowMap* shadowMap, const Impostors* impostors) const {
+    PROFILE_SCOPE("DrawList::replay");
+    GLuint currentProgram = 0;
+    Model* currentModel = nullptr;
+    int currentMaterial = -1;
+    bool shadows = shadowMap && shadowMap->isEnabled();
+
+    if (shadows) {
+        shadowMap->bindTexture();
+    }
+
+    for (const auto& cmd : commands) {
+        if (impostors && impostors->replaces(cmd.model, matrices[cmd.matrixOffset].model)) continue;
+        const ProgramState& state = programs[cmd.programState];
+
+        if (cmd.program != currentProgram) {
+            glUseProgram(cmd.program);
+            currentProgram = cmd.program;
+            currentMaterial = -1;
+            RenderStats::programBind();
+
+            // Uniformy společné pro celý snímek - jednou na program
+            if (state.lightPosition != -1) glUniform3fv(state.lightPosition, 1, glm::value_ptr(snapshot.lightPosition));
+            if (state.cameraPosition != -1) glUniform3fv(state.cameraPosition, 1, glm::value_ptr(snapshot.cameraPosition));
+            if (state.shadowMap != -1) glUniform1i(state.shadowMap, ShadowMap::TEXTURE_UNIT);
+            if (state.shadowsEnabled != -1) glUniform1i(state.shadowsEnabled, shadows ? 1 : 0);
+            if (state.shadowFarPlane != -1 && shadowMap) glUniform1f(state.shadowFarPlane, shadowMap->getFarPlane());
+            RenderStats::uniformUpload(state.frameUniforms);
+        }
+
+        const ObjectMatrices& m = matrices[cmd.matrixOffset];
+        if (state.modelMatrix != -1) glUniformMatrix4fv(state.modelMatrix, 1, GL_FALSE, glm::value_ptr(m.model));
+        if (state.mvpMatrix != -1) glUniformMatrix4fv(state.mvpMatrix, 1, GL_FALSE, glm::value_ptr(m.mvp));
+        if (state.normalMatrix != -1) glUniformMatrix3fv(state.normalMatrix, 1, GL_FALSE, glm::value_ptr(m.normal));
+        RenderStats::uniformUpload(state.objectUniforms);
+
+        // Index materiálu jen při změně (příkazy jsou seřazené i podle materiálu)
+        if (state.materialIndex != -1 && cmd.material != currentMaterial) {
+            glUniform1i(state.materialIndex, cmd.material);
+            currentMaterial = cmd.material;
+            RenderStats::uniformUpload();
+        }
+
+        if (cmd.model != currentModel) {
+            glBindVertexArray(cmd.model->getVAO());
+            currentModel = cmd.model;
+            RenderStats::vaoBind();
+        }
+        glDrawArrays(GL_TRIANGLES, cmd.firstVertex, cmd.vertexCount);
+        RenderStats::drawCall(cmd.vertexCount);
+    }
+
+    glBindVertexArray(0);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "RenderSnapshot.h"
+
+using namespace std;
+
+class ShaderProgram;
+class ShadowMap;
+class Model;
+class Impostors;
+
+// Jeden záznam v předpřipraveném proudu příkazů
+struct DrawCommand {
+    GLuint program;
+    Model* model;            // VAO se bere až při přehrání (model mohl být znovu nahrán)
+    int matrixOffset;        // index do pole matic
+    int firstVertex;
+    int vertexCount;
+    int programState;        // index do tabulky lokací uniformů
+    unsigned short material; // index do MaterialTable
+};
+
+// Zaznamenaný seznam vykreslení statické scény.
+// Přehrává se bez procházení scény a bez hledání uniformů podle jména.
+class DrawList {
+private:
+    struct ProgramState {
+        GLuint program;
+        GLint modelMatrix;
+        GLint mvpMatrix;
+        GLint normalMatrix;
+        GLint materialIndex;
+        GLint lightPosition;
+        GLint cameraPosition;
+        GLint shadowMap;
+        GLint shadowFarPlane;
+        GLint shadowsEnabled;
+        int frameUniforms;       // počty nalezených uniformů pro statistiky
+        int objectUniforms;
+    };
+
+    vector<DrawCommand> commands;
+    vector<ObjectMatrices> matrices;
+    vector<ProgramState> programs;
+    vector<RenderItem> items;        // kopie záznamu pro stínovou mapu
+    glm::mat4 viewProjection;
+    bool recorded;
+
+    int findProgramState(GLuint program);
+public:
+    DrawList();
+
+    // Zaznamená položky snímku, příkazy seřadí podle programu a modelu
+    void record(const RenderSnapshot& snapshot);
+    // Přepočítá MVP matice, pokud se změnila kamera (bez procházení scény)
+    void updateViewProjection(const glm::mat4& vp);
+    // impostors != nullptr = vzdálenou vegetaci přeskočí (kreslí se jako impostory)
+    void replay(const RenderSnapshot& snapshot, ShadowMap* shadowMap, const Impostors* impostors = nullptr) const;
+    // Jen geometrie s MVP pro aktivní program (hloubkový předprůchod)
+    void replayDepth(GLint mvpLocation, const Impostors* impostors = nullptr) const;
+    void clear();
+
+    bool isRecorded() const { return recorded; }
+    const vector<RenderItem>& getItems() const { return items; }
+    int getCommandCount() const { return static_cast<int>(commands.size()); }
+};
@@ -2,32 +2,82 @@
 #include "Model.h"
 #include "ShaderProgram.h"
 #include "CompositeTransform.h"
+#include "MatrixBatch.h"
+#include "Scene.h"
+#include "Profiler.h"
 
 DrawableObject::DrawableObject(Model* m, ShaderProgram* s, CompositeTransform* t)
-    : model(m), shader(s), transform(t) {
+    : storage(&ObjectStorage::detached()) {
+    handle = storage->create(this, m, s, t);
 }
 
-DrawableObject::~DrawableObject() { }
+DrawableObject::~DrawableObject() {
+    storage->destroy(handle);
+}
 
-void DrawableObject::draw() {
-    if (!model || !shader) return;
+glm::mat4 DrawableObject::getModelMatrix() const {
+    return storage->computeLocalMatrix(index());
+}
 
-    GLuint program = shader->getProgram();
-    shader->use(program);
+void DrawableObject::draw(ShaderProgram* activeShader, const ObjectMatrices& matrices) const {
+    draw(getModel(), activeShader, matrices, getMaterial());
+}
 
-    glm::mat4 modelMatrix = glm::mat4(1.0f);
-    if (transform != nullptr) {
-        modelMatrix = transform->getMatrix();
-    }
+void DrawableObject::draw(Model* model, ShaderProgram* activeShader, const ObjectMatrices& matrices, unsigned short material) {
+    PROFILE_SCOPE("DrawableObject::draw");
+    if (!model || !activeShader) return;
+
+    GLuint program = activeShader->getProgram();
+    activeShader->use(program);
 
-    shader->SetUniform("modelMatrix", modelMatrix);
+    // Matice jsou předpočítané v MatrixBatch; původní shader má jen mvpMatrix
+    activeShader->SetUniform("mvpMatrix", matrices.mvp);
+    if (activeShader->hasUniform("modelMatrix")) {
+        activeShader->SetUniform("modelMatrix", matrices.model);
+    }
+    if (activeShader->hasUniform("normalMatrix")) {
+        activeShader->SetUniform("normalMatrix", matrices.normal);
+    }
+    if (activeShader->hasUniform("materialIndex")) {
+        activeShader->SetUniform("materialIndex", static_cast<int>(material));
+    }
     model->draw();
 }
 
 void DrawableObject::setTransform(CompositeTransform* t) {
-    transform = t;
+    storage->setTransform(index(), t);
+}
+
+void DrawableObject::setLocalTransform(const glm::vec3& translation, float angle, const glm::vec3& axis, const glm::vec3& scale) {
+    storage->setLocalTransform(index(), translation, angle, axis, scale);
+}
+
+void DrawableObject::markTransformDirty() {
+    storage->notifyChanged(index(), true);
 }
 
 void DrawableObject::setShader(ShaderProgram* s) {
-    shader = s;
+    storage->setShader(index(), s);
+    storage->notifyChanged(index(), false);
+}
+
+void DrawableObject::setMaterial(unsigned short material) {
+    storage->setMaterial(index(), material);
+    storage->notifyChanged(index(), false);
+}
+
+void DrawableObject::setStatic(bool s) {
+    storage->setFlag(index(), ObjectStorage::FLAG_STATIC, s);
+    markTransformDirty();
+}
+
+void DrawableObject::setCastsShadow(bool c) {
+    storage->setFlag(index(), ObjectStorage::FLAG_CASTS_SHADOW, c);
+    markTransformDirty();
+}
+
+void DrawableObject::attach(ObjectStorage& target) {
+    if (&target == storage) return;
+    handle = storage->moveTo(handle, target);
+    storage = &target;
 }
\ No newline at end of file
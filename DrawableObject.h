@@ -1,24 +1,54 @@
 #pragma once
+#include <glm/glm.hpp>
+#include "ObjectStorage.h"
 
 class Model;
 class ShaderProgram;
 class CompositeTransform;
+class Scene;
+struct ObjectMatrices;
 
+// Fasáda nad záznamem v ObjectStorage. Do přidání do scény je objekt
+// v ObjectStorage::detached(), Scene::addObject ho přesune do své.
 class DrawableObject {
 private:
-    Model* model;
-    ShaderProgram* shader;
-    CompositeTransform* transform;
+    ObjectStorage* storage;
+    ObjectHandle handle;
+
+    unsigned int index() const { return storage->indexOf(handle); }
 public:
     DrawableObject(Model* m, ShaderProgram* s, CompositeTransform* t = nullptr);
     ~DrawableObject();
 
-    void draw();
+    // Shader se předává zvlášť - render vlákno kreslí se shaderem zachyceným ve snímku
+    void draw(ShaderProgram* activeShader, const ObjectMatrices& matrices) const;
+    // Totéž bez fasády (objekty načtené blokově žádnou nemají)
+    static void draw(Model* model, ShaderProgram* activeShader, const ObjectMatrices& matrices, unsigned short material = 0);
 
-    Model* getModel() const { return model; }
-    ShaderProgram* getShader() const { return shader; }
-    CompositeTransform* getTransform() const { return transform; }
+    Model* getModel() const { return storage->getModel(index()); }
+    ShaderProgram* getShader() const { return storage->getShader(index()); }
+    unsigned short getMaterial() const { return storage->getMaterial(index()); }
+    CompositeTransform* getTransform() const { return storage->getTransform(index()); }
+    glm::mat4 getModelMatrix() const;
 
     void setTransform(CompositeTransform* t);
     void setShader(ShaderProgram* s);
+    // Index do MaterialTable, objekty se stejným shaderem a různým materiálem sdílí program
+    void setMaterial(unsigned short material);
+    // Lokální posun, rotace a měřítko bez alokace Transform (použije se, pokud není kompozitní transformace)
+    void setLocalTransform(const glm::vec3& translation, float angle, const glm::vec3& axis, const glm::vec3& scale);
+
+    // Nutno zavolat, pokud se přiřazená transformace změní na místě
+    void markTransformDirty();
+    unsigned int getRevision() const { return storage->getRevision(index()); }
+
+    bool isStatic() const { return storage->hasFlag(index(), ObjectStorage::FLAG_STATIC); }
+    void setStatic(bool s);
+    bool castsShadow() const { return storage->hasFlag(index(), ObjectStorage::FLAG_CASTS_SHADOW); }
+    void setCastsShadow(bool c);
+
+    // Přesun do úložiště scény (volá Scene::addObject)
+    void attach(ObjectStorage& target);
+    ObjectStorage* getStorage() const { return storage; }
+    ObjectHandle getHandle() const { return handle; }
 };
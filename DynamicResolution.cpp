@@ -0,0 +1,168 @@
+#include "DynamicResolution.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+
+using namespace std;
+
+DynamicResolution::DynamicResolution(double targetMs, float minScale, float maxScale)
+    : fbo(0), colorTexture(0), depthStencil(0), targetWidth(0), targetHeight(0), windowWidth(0), windowHeight(0),
+    queryIndex(0), settle(0), targetMs(targetMs), minScale(minScale), maxScale(maxScale) {
+    for (int i = 0; i < QUERY_FRAMES * 2; i++) queries[i] = 0;
+    for (int i = 0; i < QUERY_FRAMES; i++) {
+        pending[i] = false;
+        queryScale[i] = 0.0f;
+    }
+    if (this->minScale <= 0.0f) this->minScale = 0.1f;
+    if (this->maxScale < this->minScale) this->maxScale = this->minScale;
+    stats = DynamicResolutionStats{ this->maxScale, 0, 0, 0.0, 0.0, 0, 0, 0, this->maxScale, this->maxScale, 0.0 };
+}
+
+DynamicResolution::~DynamicResolution() {
+    if (queries[0]) glDeleteQueries(QUERY_FRAMES * 2, queries);
+    if (fbo) glDeleteFramebuffers(1, &fbo);
+    if (colorTexture) glDeleteTextures(1, &colorTexture);
+    if (depthStencil) glDeleteRenderbuffers(1, &depthStencil);
+}
+
+bool DynamicResolution::initialize(int width, int height) {
+    glGenQueries(QUERY_FRAMES * 2, queries);
+    glGenFramebuffers(1, &fbo);
+    glGenTextures(1, &colorTexture);
+    glGenRenderbuffers(1, &depthStencil);
+    if (!resizeTargets(width, height)) {
+        return false;
+    }
+
+    printf("Dynamic resolution initialized (target %.1f ms, scale %.2f-%.2f)\n", targetMs, minScale, maxScale);
+    return true;
+}
+
+bool DynamicResolution::resizeTargets(int width, int height) {
+    windowWidth = max(width, 1);
+    windowHeight = max(height, 1);
+    targetWidth = max(static_cast<int>(ceil(windowWidth * maxScale)), 1);
+    targetHeight = max(static_cast<int>(ceil(windowHeight * maxScale)), 1);
+
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, targetWidth, targetHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, depthStencil);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, targetWidth, targetHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencil);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        printf("Dynamic resolution framebuffer incomplete (0x%x)\n", status);
+        return false;
+    }
+    return true;
+}
+
+void DynamicResolution::collectQueries() {
+    // Nejstarší slot v kruhu - dotazy jsou QUERY_FRAMES snímků staré
+    if (!pending[queryIndex]) return;
+    GLint available = 0;
+    glGetQueryObjectiv(queries[queryIndex * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    GLuint64 start = 0;
+    GLuint64 stop = 0;
+    glGetQueryObjectui64v(queries[queryIndex * 2], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(queries[queryIndex * 2 + 1], GL_QUERY_RESULT, &stop);
+    pending[queryIndex] = false;
+
+    double gpuMs = (stop - start) / 1000000.0;
+    stats.lastGpuMs = gpuMs;
+    stats.samples++;
+    if (gpuMs > targetMs) stats.overBudget++;
+    stats.maxGpuMs = max(stats.maxGpuMs, gpuMs);
+
+    // Snímky kreslené ještě starým měřítkem do řízení nepatří
+    if (queryScale[queryIndex] != stats.scale) return;
+    stats.gpuMs = stats.gpuMs == 0.0 ? gpuMs : stats.gpuMs + (gpuMs - stats.gpuMs) * SMOOTHING;
+    adjustScale(stats.gpuMs);
+}
+
+void DynamicResolution::adjustScale(double gpuMs) {
+    if (settle > 0) {
+        settle--;
+        return;
+    }
+    if (fabs(gpuMs - targetMs) < targetMs * DEADBAND) return;
+
+    float step = static_cast<float>(sqrt(targetMs / gpuMs));
+    step = min(max(step, 1.0f - MAX_STEP), 1.0f + MAX_STEP);
+    float scale = min(max(stats.scale * step, minScale), maxScale);
+    if (fabs(scale - stats.scale) < 0.005f) return;
+
+    stats.scale = scale;
+    stats.changes++;
+    stats.minScale = min(stats.minScale, scale);
+    stats.maxScale = max(stats.maxScale, scale);
+    // Odhad času pro nové měřítko, než ho zpřesní nová měření
+    stats.gpuMs = gpuMs * (step * step);
+    settle = SETTLE_SAMPLES;
+}
+
+void DynamicResolution::begin(int width, int height) {
+    PROFILE_SCOPE("DynamicResolution::begin");
+    queryIndex = (queryIndex + 1) % QUERY_FRAMES;
+    collectQueries();
+
+    // Změna okna z window_size_callback - textury se přealokují tady (GL vlákno)
+    if (width != windowWidth || height != windowHeight) {
+        resizeTargets(width, height);
+    }
+    stats.renderWidth = max(static_cast<int>(windowWidth * stats.scale + 0.5f), 1);
+    stats.renderHeight = max(static_cast<int>(windowHeight * stats.scale + 0.5f), 1);
+
+    // Slot se ještě nepřečetl - tento snímek se neměří
+    if (!pending[queryIndex]) {
+        queryScale[queryIndex] = stats.scale;
+        glQueryCounter(queries[queryIndex * 2], GL_TIMESTAMP);
+    }
+}
+
+void DynamicResolution::bind() {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, stats.renderWidth, stats.renderHeight);
+}
+
+void DynamicResolution::end() {
+    PROFILE_GPU_SCOPE("Upscale");
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, stats.renderWidth, stats.renderHeight, 0, 0, windowWidth, windowHeight,
+        GL_COLOR_BUFFER_BIT, stats.renderWidth == windowWidth ? GL_NEAREST : GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, windowWidth, windowHeight);
+
+    if (!pending[queryIndex]) {
+        glQueryCounter(queries[queryIndex * 2 + 1], GL_TIMESTAMP);
+        pending[queryIndex] = true;
+    }
+}
+
+void DynamicResolution::printStats() {
+    printf("Dynamic resolution: scale %.2f (%dx%d of %dx%d), GPU %.2f ms (last %.2f, max %.2f, target %.1f), "
+        "%d/%d frames over budget, scale range %.2f-%.2f, %d changes\n",
+        stats.scale, stats.renderWidth, stats.renderHeight, windowWidth, windowHeight,
+        stats.gpuMs, stats.lastGpuMs, stats.maxGpuMs, targetMs,
+        stats.overBudget, stats.samples, stats.minScale, stats.maxScale, stats.changes);
+    stats.samples = 0;
+    stats.overBudget = 0;
+    stats.minScale = stats.scale;
+    stats.maxScale = stats.scale;
+    stats.maxGpuMs = 0.0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <GL/glew.h>
+
+// Statistiky dynamického rozlišení (časy v ms)
+struct DynamicResolutionStats {
+    float scale;                 // aktuální měřítko strany (1 = rozlišení okna)
+    int renderWidth;
+    int renderHeight;
+    double gpuMs;                // vyhlazený GPU čas snímku
+    double lastGpuMs;            // poslední změřený snímek
+    int changes;                 // změny měřítka od začátku
+    // Od posledního printStats
+    int samples;
+    int overBudget;              // snímky nad cílovým časem
+    float minScale;
+    float maxScale;
+    double maxGpuMs;
+};
+
+// Scéna se kreslí do offscreen framebufferu se zmenšeným rozlišením a na konci
+// se lineárně roztáhne do okna. Textury se alokují pro maximální měřítko a kreslí
+// se do levého dolního výřezu, takže změna měřítka nic nepřealokuje - jen změna okna.
+// GPU čas celého snímku měří dvojice GL_TIMESTAMP dotazů (GL_TIME_ELAPSED nejde
+// vnořit do měření stínové mapy) v kruhu QUERY_FRAMES snímků, aby se nečekalo na GPU.
+// Čas je zhruba úměrný počtu pixelů, měřítko strany se proto mění o sqrt(cíl / čas).
+class DynamicResolution {
+private:
+    static const int QUERY_FRAMES = 4;
+    static const int SETTLE_SAMPLES = 3;                    // měření s novým měřítkem před dalším krokem
+    static constexpr double SMOOTHING = 0.25;
+    static constexpr double DEADBAND = 0.05;                // +-5 % kolem cíle beze změny
+    static constexpr float MAX_STEP = 0.1f;                 // nejvýše o 10 % za krok
+
+    GLuint fbo;
+    GLuint colorTexture;
+    GLuint depthStencil;         // stencil kvůli teplotní mapě overdraw
+    int targetWidth;             // alokovaná velikost (okno * maxScale)
+    int targetHeight;
+    int windowWidth;
+    int windowHeight;
+
+    GLuint queries[QUERY_FRAMES * 2];
+    bool pending[QUERY_FRAMES];
+    float queryScale[QUERY_FRAMES];  // měřítko, kterým se snímek kreslil
+    int queryIndex;
+    int settle;
+
+    double targetMs;
+    float minScale;
+    float maxScale;
+
+    DynamicResolutionStats stats;
+
+    bool resizeTargets(int width, int height);
+    void collectQueries();
+    void adjustScale(double gpuMs);
+public:
+    DynamicResolution(double targetMs = 16.0, float minScale = 0.5f, float maxScale = 1.0f);
+    ~DynamicResolution();
+
+    bool initialize(int width, int height);
+
+    // Začátek snímku (render vlákno): přečte hotové dotazy, upraví měřítko,
+    // při změně okna přealokuje textury a spustí měření
+    void begin(int width, int height);
+    // Přesměruje kreslení do offscreen cíle se zmenšeným viewportem
+    void bind();
+    // Roztáhne výsledek do okna (framebuffer 0) a ukončí měření
+    void end();
+
+    double getTargetMs() const { return targetMs; }
+    const DynamicResolutionStats& getStats() const { return stats; }
+    // Vypíše stav a vynuluje intervalové hodnoty
+    void printStats();
+};
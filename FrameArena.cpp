@@ -0,0 +1,119 @@
+#include "FrameArena.h"
+#include <atomic>
+#include <cstdlib>
+#include <stdio.h>
+
+// Globální pořadí vláken - stejné pro všechny arény
+static atomic<int> nextThreadSlot(0);
+static thread_local int currentThreadSlot = -1;
+
+FrameArena::FrameArena(size_t capacityPerThread) : initialCapacity(capacityPerThread) {
+    for (int i = 0; i < ARENA_COUNT; i++) {
+        subArenas[i].base = nullptr;
+        subArenas[i].capacity = 0;
+        subArenas[i].offset = 0;
+        subArenas[i].highWater = 0;
+        subArenas[i].frameOverflow = 0;
+    }
+}
+
+FrameArena::~FrameArena() {
+    reset();
+    for (int i = 0; i < ARENA_COUNT; i++) {
+        free(subArenas[i].base);
+    }
+}
+
+int FrameArena::threadSlot() {
+    if (currentThreadSlot < 0) {
+        currentThreadSlot = nextThreadSlot.fetch_add(1);
+    }
+    return currentThreadSlot;
+}
+
+void* FrameArena::allocateFrom(SubArena& arena, size_t size, size_t alignment) {
+    // Podaréna se vytvoří při první alokaci vlákna
+    if (!arena.base) {
+        arena.capacity = initialCapacity;
+        arena.base = static_cast<char*>(malloc(arena.capacity));
+    }
+
+    size_t aligned = (arena.offset + alignment - 1) & ~(alignment - 1);
+    if (aligned + size <= arena.capacity) {
+        arena.offset = aligned + size;
+        if (arena.offset + arena.frameOverflow > arena.highWater) {
+            arena.highWater = arena.offset + arena.frameOverflow;
+        }
+        return arena.base + aligned;
+    }
+
+    // Přetečení - blok z haldy, podaréna se zvětší při resetu
+    void* block = malloc(size + alignment);
+    arena.overflowBlocks.push_back(block);
+    arena.frameOverflow += size + alignment;
+    if (arena.offset + arena.frameOverflow > arena.highWater) {
+        arena.highWater = arena.offset + arena.frameOverflow;
+    }
+    size_t address = reinterpret_cast<size_t>(block);
+    return reinterpret_cast<void*>((address + alignment - 1) & ~(alignment - 1));
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    int slot = threadSlot();
+    if (slot < MAX_THREADS) {
+        return allocateFrom(subArenas[slot], size, alignment);
+    }
+
+    // Nad limit vláken - vlastní sdílená podaréna pod zámkem (ne podaréna
+    // jiného vlákna, to z ní alokuje bez zámku)
+    lock_guard<mutex> lock(sharedMutex);
+    return allocateFrom(subArenas[SHARED_ARENA], size, alignment);
+}
+
+void FrameArena::reset() {
+    for (int i = 0; i < ARENA_COUNT; i++) {
+        SubArena& arena = subArenas[i];
+        if (!arena.overflowBlocks.empty()) {
+            for (auto block : arena.overflowBlocks) free(block);
+            arena.overflowBlocks.clear();
+
+            // Další snímek se vejde bez přetečení
+            size_t capacity = arena.capacity;
+            while (capacity < arena.highWater) capacity *= 2;
+            free(arena.base);
+            arena.base = static_cast<char*>(malloc(capacity));
+            arena.capacity = capacity;
+        }
+        arena.offset = 0;
+        arena.frameOverflow = 0;
+    }
+}
+
+size_t FrameArena::getUsed() const {
+    size_t used = 0;
+    for (int i = 0; i < ARENA_COUNT; i++) {
+        used += subArenas[i].offset + subArenas[i].frameOverflow;
+    }
+    return used;
+}
+
+size_t FrameArena::getHighWater() const {
+    size_t highWater = 0;
+    for (int i = 0; i < ARENA_COUNT; i++) {
+        highWater += subArenas[i].highWater;
+    }
+    return highWater;
+}
+
+void FrameArena::printStats() const {
+    int threads = 0;
+    size_t reserved = 0;
+    for (int i = 0; i < ARENA_COUNT; i++) {
+        if (subArenas[i].base) {
+            threads++;
+            reserved += subArenas[i].capacity;
+        }
+    }
+    printf("Frame arena: %d threads, used %.1f KB, high water %.1f KB, reserved %.1f KB\n",
+        threads, getUsed() / 1024.0, getHighWater() / 1024.0, reserved / 1024.0);
+}
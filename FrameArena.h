@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <mutex>
+
+using namespace std;
+
+// Lineární (bump) alokátor pro data jednoho snímku. Každé vlákno má vlastní
+// podarénu, takže alokace je jen posun ukazatele bez zámků. reset() se volá
+// na konci snímku, kdy už nikdo z arény nealokuje ani nečte.
+// Při přetečení se alokuje z haldy a při dalším resetu se podaréna zvětší,
+// v ustáleném stavu tedy aréna na haldu nesahá.
+// Destruktory se nevolají - jen pro typy bez vlastních zdrojů.
+class FrameArena {
+private:
+    static const int MAX_THREADS = 64;
+    // Poslední podaréna patří vláknům nad MAX_THREADS a sdílí se pod zámkem
+    static const int SHARED_ARENA = MAX_THREADS;
+    static const int ARENA_COUNT = MAX_THREADS + 1;
+
+    struct SubArena {
+        char* base;
+        size_t capacity;
+        size_t offset;
+        size_t highWater;        // max. využití od vytvoření (včetně přetečení)
+        size_t frameOverflow;    // bajty z haldy v tomto snímku
+        vector<void*> overflowBlocks;
+    };
+
+    SubArena subArenas[ARENA_COUNT];
+    size_t initialCapacity;
+    mutex sharedMutex;           // chrání jen subArenas[SHARED_ARENA]
+
+    void* allocateFrom(SubArena& arena, size_t size, size_t alignment);
+    static int threadSlot();
+public:
+    FrameArena(size_t capacityPerThread = 256 * 1024);
+    ~FrameArena();
+
+    void* allocate(size_t size, size_t alignment = alignof(max_align_t));
+
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(static_cast<Args&&>(args)...);
+    }
+
+    // Konec snímku - uvolní vše najednou
+    void reset();
+
+    size_t getUsed() const;
+    size_t getHighWater() const;
+    void printStats() const;
+};
+
+// Adaptér pro STL kontejnery, deallocate nic nedělá (uvolní se při reset)
+template<typename T>
+class FrameAllocator {
+public:
+    typedef T value_type;
+    FrameArena* arena;
+
+    FrameAllocator(FrameArena* a) : arena(a) {}
+    template<typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    template<typename U>
+    bool operator==(const FrameAllocator<U>& other) const { return arena == other.arena; }
+    template<typename U>
+    bool operator!=(const FrameAllocator<U>& other) const { return arena != other.arena; }
+};
+
+template<typename T>
+using FrameVector = vector<T, FrameAllocator<T>>;
@@ -0,0 +1,501 @@
+#include "FrameCapture.h"
+#include "FramePipeline.h"
+#include "Profiler.h"
+#include <string.h>
+
+FrameCapture::FrameCapture(const string& path, int fps)
+    : path(path), format(formatFromPath(path)), fps(fps > 0 ? fps : 60), ringIndex(0), streamWidth(0), streamHeight(0),
+    lastCaptureTime(0.0), startTime(-1.0), lastIndex(-1), framesWriting(0), stopping(false), file(nullptr) {
+    for (int i = 0; i < RING_SIZE; i++) {
+        ring[i].frame = nullptr;
+        ring[i].fence = nullptr;
+    }
+    memset(&stats, 0, sizeof(stats));
+}
+
+FrameCapture::~FrameCapture() {
+    // PBO a fence patří GL kontextu, uvolní je finish()
+    stop();
+    for (auto frame : frames) {
+        delete frame;
+    }
+}
+
+CaptureFormat FrameCapture::formatFromPath(const string& path) {
+    size_t dot = path.find_last_of('.');
+    string extension = dot == string::npos ? "" : path.substr(dot);
+    if (extension == ".y4m") return CAPTURE_Y4M;
+    if (extension == ".raw" || extension == ".rgb") return CAPTURE_RAW;
+    return CAPTURE_PNG;
+}
+
+bool FrameCapture::initialize() {
+    if (format != CAPTURE_PNG) {
+        file = fopen(path.c_str(), "wb");
+        if (!file) {
+            printf("Frame capture: cannot open %s\n", path.c_str());
+            return false;
+        }
+    }
+
+    stopping = false;
+    writer = thread(&FrameCapture::writerLoop, this);
+
+    static const char* formatNames[] = { "raw RGB24", "Y4M 4:2:0", "PNG" };
+    printf("Frame capture: %s -> %s (%d fps, up to %d PBOs, queue %d)\n",
+        formatNames[format], path.c_str(), fps, MAX_BUFFERS, QUEUE_LIMIT);
+    return true;
+}
+
+bool FrameCapture::isSignaled(GLsync fence) const {
+    // Timeout 0 jen zjistí stav, nic nečeká
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+void FrameCapture::capture(int width, int height) {
+    if (!writer.joinable() || width <= 0 || height <= 0) return;
+    PROFILE_SCOPE("FrameCapture::capture");
+    double start = FramePipeline::now();
+    if (lastCaptureTime > 0.0) {
+        stats.frameMs += start - lastCaptureTime;
+    }
+    lastCaptureTime = start;
+    recycle();
+
+    // Pozice ve výstupu podle času; obsazená pozice = render je rychlejší než fps
+    if (startTime < 0.0) startTime = start;
+    long long index = static_cast<long long>((start - startTime) * fps / 1000.0);
+    if (index <= lastIndex) {
+        stats.skipped++;
+    }
+    else {
+        // Slot z doby před RING_SIZE snímky stále čeká - GPU je hodně pozadu, musí se počkat
+        Slot& slot = ring[ringIndex];
+        if (slot.fence) {
+            PROFILE_SCOPE("FrameCapture stall");
+            double stallStart = FramePipeline::now();
+            while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000) == GL_TIMEOUT_EXPIRED) { // 100 ms
+            }
+            collect(slot);
+            stats.stallMs += FramePipeline::now() - stallStart;
+            stats.stalls++;
+        }
+
+        size_t size = static_cast<size_t>(width) * height * 4;
+        Frame* frame = acquireFrame(size);
+        if (!frame) {
+            // Všechna PBO čekají na zapisovač; pozici vyplní opakování nebo další snímek
+            stats.dropped++;
+        }
+        else {
+            // Čtení do PBO je asynchronní, glReadPixels se vrátí bez čekání na GPU.
+            // BGRA odpovídá nativnímu formátu většiny ovladačů (bez převodu na GPU).
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+            glReadBuffer(GL_BACK);
+            glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            glReadPixels(0, 0, width, height, GL_BGRA, GL_UNSIGNED_BYTE, 0);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            frame->width = width;
+            frame->height = height;
+            frame->index = index;
+            slot.frame = frame;
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            ringIndex = (ringIndex + 1) % RING_SIZE;
+            lastIndex = index;
+        }
+    }
+
+    // Vyzvedne hotové sloty od nejstaršího, pořadí snímků se zachová
+    for (int i = 0; i < RING_SIZE; i++) {
+        Slot& pending = ring[(ringIndex + i) % RING_SIZE];
+        if (!pending.fence || !isSignaled(pending.fence)) break;
+        collect(pending);
+    }
+
+    double ms = FramePipeline::now() - start;
+    stats.cpuMs += ms;
+    if (ms > stats.maxCpuMs) stats.maxCpuMs = ms;
+    stats.frames++;
+}
+
+FrameCapture::Frame* FrameCapture::acquireFrame(size_t size) {
+    Frame* frame = nullptr;
+    if (!freeFrames.empty()) {
+        frame = freeFrames.back();
+        freeFrames.pop_back();
+    }
+    else if (static_cast<int>(frames.size()) < MAX_BUFFERS) {
+        frame = new Frame();
+        glGenBuffers(1, &frame->pbo);
+        frame->capacity = 0;
+        frame->pixels = nullptr;
+        frames.push_back(frame);
+    }
+    else {
+        return nullptr;
+    }
+
+    // Nechá PBO svázané pro glReadPixels
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, frame->pbo);
+    if (frame->capacity < size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        frame->capacity = size;
+    }
+    return frame;
+}
+
+void FrameCapture::collect(Slot& slot) {
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    Frame* frame = slot.frame;
+    slot.frame = nullptr;
+
+    // RAW/Y4M mají pevnou velikost obrazu z prvního snímku
+    if (streamWidth == 0) {
+        streamWidth = frame->width;
+        streamHeight = frame->height;
+    }
+    if (format != CAPTURE_PNG && (frame->width != streamWidth || frame->height != streamHeight)) {
+        if (stats.dropped == 0) {
+            printf("Frame capture: window resized to %dx%d, frames of other size than %dx%d are skipped\n",
+                frame->width, frame->height, streamWidth, streamHeight);
+        }
+        freeFrames.push_back(frame);
+        stats.dropped++;
+        return;
+    }
+
+    // Zapisovač čte přímo z namapované paměti, odmapuje se až po zápisu (recycle)
+    size_t size = static_cast<size_t>(frame->width) * frame->height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, frame->pbo);
+    frame->pixels = static_cast<const unsigned char*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!frame->pixels) {
+        freeFrames.push_back(frame);
+        stats.dropped++;
+        return;
+    }
+
+    lock_guard<mutex> lock(queueMutex);
+    queue.push_back(frame);
+    stats.captured++;
+    queueCondition.notify_one();
+}
+
+void FrameCapture::recycle() {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        doneScratch.swap(writtenFrames);
+    }
+    for (auto frame : doneScratch) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, frame->pbo);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        frame->pixels = nullptr;
+        freeFrames.push_back(frame);
+    }
+    if (!doneScratch.empty()) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        doneScratch.clear();
+    }
+}
+
+void FrameCapture::finish() {
+    // Čekající sloty v pořadí od nejstaršího
+    for (int i = 0; i < RING_SIZE; i++) {
+        Slot& slot = ring[(ringIndex + i) % RING_SIZE];
+        if (!slot.fence) continue;
+        while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000) == GL_TIMEOUT_EXPIRED) {
+        }
+        collect(slot);
+    }
+
+    // Namapovaná PBO se smí smazat až po zápisu
+    if (writer.joinable()) {
+        unique_lock<mutex> lock(queueMutex);
+        drainedCondition.wait(lock, [this]() { return queue.empty() && framesWriting == 0; });
+    }
+    recycle();
+    for (auto frame : frames) {
+        if (frame->pbo) glDeleteBuffers(1, &frame->pbo);
+        frame->pbo = 0;
+        frame->capacity = 0;
+    }
+    freeFrames.clear();
+}
+
+void FrameCapture::stop() {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+    if (writer.joinable()) {
+        writer.join();
+    }
+    if (file) {
+        fclose(file);
+        file = nullptr;
+        printf("Frame capture: %lld frames written to %s (%lld repeated), %lld skipped, %lld dropped\n",
+            stats.written, path.c_str(), stats.repeated, stats.skipped, stats.dropped);
+    }
+}
+
+void FrameCapture::writerLoop() {
+    PROFILE_THREAD_NAME("FrameCapture");
+    vector<unsigned char> rgb;       // poslední převedený snímek, z něj se vyplňují mezery
+    vector<unsigned char> scratch;
+    long long nextIndex = 0;
+    int lastWidth = 0, lastHeight = 0;
+    while (true) {
+        Frame* frame = nullptr;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return stopping || !queue.empty(); });
+            // Při zastavení se fronta nejdřív dopíše
+            if (queue.empty()) break;
+            frame = queue.front();
+            queue.pop_front();
+            framesWriting++;
+        }
+
+        double start = FramePipeline::now();
+        long long index = frame->index;
+        int width = frame->width;
+        int height = frame->height;
+        long long written = 0, repeated = 0, errors = 0;
+        {
+            PROFILE_SCOPE("FrameCapture::writeFrame");
+            // Snímek přišel později, než odpovídá fps - chybějící pozice drží předchozí obraz
+            for (; lastWidth > 0 && nextIndex < index; nextIndex++) {
+                if (writeFrame(nextIndex, rgb.data(), lastWidth, lastHeight, scratch)) written++;
+                else errors++;
+                repeated++;
+            }
+            toRGB(*frame, rgb);
+        }
+
+        // Namapovaná paměť už není potřeba, PBO se vrací GL vláknu
+        {
+            lock_guard<mutex> lock(queueMutex);
+            writtenFrames.push_back(frame);
+            framesWriting--;
+            if (queue.empty() && framesWriting == 0) drainedCondition.notify_all();
+        }
+
+        {
+            PROFILE_SCOPE("FrameCapture::writeFrame");
+            if (writeFrame(index, rgb.data(), width, height, scratch)) written++;
+            else errors++;
+        }
+        nextIndex = index + 1;
+        lastWidth = width;
+        lastHeight = height;
+        double ms = FramePipeline::now() - start;
+
+        lock_guard<mutex> lock(queueMutex);
+        stats.writeMs += ms;
+        stats.writeFrames += static_cast<int>(written + errors);
+        stats.written += written;
+        stats.repeated += repeated;
+        stats.writeErrors += errors;
+    }
+}
+
+bool FrameCapture::writeFrame(long long index, const unsigned char* rgb, int width, int height, vector<unsigned char>& scratch) {
+    size_t size = static_cast<size_t>(width) * height * 3;
+    switch (format) {
+    case CAPTURE_RAW:
+        return fwrite(rgb, 1, size, file) == size;
+    case CAPTURE_Y4M:
+        if (ftell(file) == 0) {
+            fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+        }
+        return writeY4M(file, rgb, width, height, scratch);
+    case CAPTURE_PNG: {
+        // Čísla souborů = pozice ve výstupu, řada je souvislá i s opakovanými snímky
+        char name[1024];
+        snprintf(name, sizeof(name), "%s%06lld.png", path.c_str(), index);
+        return writePNG(name, rgb, width, height, scratch);
+    }
+    }
+    return false;
+}
+
+void FrameCapture::toRGB(const Frame& frame, vector<unsigned char>& rgb) {
+    // BGRA odspodu -> RGB shora
+    rgb.resize(static_cast<size_t>(frame.width) * frame.height * 3);
+    for (int y = 0; y < frame.height; y++) {
+        const unsigned char* src = frame.pixels + static_cast<size_t>(frame.height - 1 - y) * frame.width * 4;
+        unsigned char* dst = rgb.data() + static_cast<size_t>(y) * frame.width * 3;
+        for (int x = 0; x < frame.width; x++) {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            src += 4;
+            dst += 3;
+        }
+    }
+}
+
+bool FrameCapture::writeY4M(FILE* file, const unsigned char* rgb, int width, int height, vector<unsigned char>& planes) {
+    // BT.601 s omezeným rozsahem (výchozí předpoklad přehrávačů), chroma průměr bloku 2x2
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+    size_t lumaSize = static_cast<size_t>(width) * height;
+    size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+    planes.resize(lumaSize + chromaSize * 2);
+    unsigned char* Y = planes.data();
+    unsigned char* U = Y + lumaSize;
+    unsigned char* V = U + chromaSize;
+
+    for (size_t i = 0; i < lumaSize; i++) {
+        const unsigned char* p = rgb + i * 3;
+        Y[i] = static_cast<unsigned char>(((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16);
+    }
+    for (int cy = 0; cy < chromaHeight; cy++) {
+        int y0 = cy * 2;
+        int y1 = y0 + 1 < height ? y0 + 1 : y0;
+        for (int cx = 0; cx < chromaWidth; cx++) {
+            int x0 = cx * 2;
+            int x1 = x0 + 1 < width ? x0 + 1 : x0;
+            const unsigned char* a = rgb + (static_cast<size_t>(y0) * width + x0) * 3;
+            const unsigned char* b = rgb + (static_cast<size_t>(y0) * width + x1) * 3;
+            const unsigned char* c = rgb + (static_cast<size_t>(y1) * width + x0) * 3;
+            const unsigned char* d = rgb + (static_cast<size_t>(y1) * width + x1) * 3;
+            int r = (a[0] + b[0] + c[0] + d[0] + 2) >> 2;
+            int g = (a[1] + b[1] + c[1] + d[1] + 2) >> 2;
+            int bl = (a[2] + b[2] + c[2] + d[2] + 2) >> 2;
+            U[cy * chromaWidth + cx] = static_cast<unsigned char>(((-38 * r - 74 * g + 112 * bl + 128) >> 8) + 128);
+            V[cy * chromaWidth + cx] = static_cast<unsigned char>(((112 * r - 94 * g - 18 * bl + 128) >> 8) + 128);
+        }
+    }
+
+    fputs("FRAME\n", file);
+    return fwrite(planes.data(), 1, planes.size(), file) == planes.size();
+}
+
+static unsigned int crc32Update(unsigned int crc, const unsigned char* data, size_t length) {
+    static unsigned int table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (unsigned int n = 0; n < 256; n++) {
+            unsigned int c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void putBigEndian(vector<unsigned char>& out, unsigned int value) {
+    out.push_back(static_cast<unsigned char>(value >> 24));
+    out.push_back(static_cast<unsigned char>(value >> 16));
+    out.push_back(static_cast<unsigned char>(value >> 8));
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+static void putChunk(vector<unsigned char>& out, const char* type, const unsigned char* data, size_t length) {
+    putBigEndian(out, static_cast<unsigned int>(length));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + length);
+    putBigEndian(out, crc32Update(0, out.data() + start, length + 4));
+}
+
+bool FrameCapture::writePNG(const char* path, const unsigned char* rgb, int width, int height, vector<unsigned char>& scratch) {
+    // Projekt nemá zlib - deflate z nekomprimovaných bloků (platné PNG, soubor ~ velikost RGB).
+    // Zápis je tak omezený diskem, ne kompresí; zmenšit jde dodatečně (optipng, ffmpeg).
+    size_t rowSize = static_cast<size_t>(width) * 3 + 1;    // + bajt filtru 0
+    size_t rawSize = rowSize * height;
+    size_t blocks = (rawSize + 65534) / 65535;
+
+    vector<unsigned char> idat;
+    idat.reserve(2 + rawSize + blocks * 5 + 4);
+    idat.push_back(0x78);    // zlib hlavička: deflate, okno 32 kB
+    idat.push_back(0x01);
+
+    unsigned int adlerA = 1, adlerB = 0;
+    scratch.resize(rawSize);
+    for (int y = 0; y < height; y++) {
+        unsigned char* row = scratch.data() + rowSize * y;
+        row[0] = 0;
+        memcpy(row + 1, rgb + static_cast<size_t>(y) * width * 3, rowSize - 1);
+    }
+    for (size_t i = 0; i < rawSize; i++) {
+        adlerA = (adlerA + scratch[i]) % 65521;
+        adlerB = (adlerB + adlerA) % 65521;
+    }
+    for (size_t offset = 0; offset < rawSize; offset += 65535) {
+        size_t length = rawSize - offset < 65535 ? rawSize - offset : 65535;
+        idat.push_back(offset + length == rawSize ? 1 : 0);
+        idat.push_back(static_cast<unsigned char>(length));
+        idat.push_back(static_cast<unsigned char>(length >> 8));
+        idat.push_back(static_cast<unsigned char>(~length));
+        idat.push_back(static_cast<unsigned char>(~length >> 8));
+        idat.insert(idat.end(), scratch.data() + offset, scratch.data() + offset + length);
+    }
+    putBigEndian(idat, (adlerB << 16) | adlerA);
+
+    unsigned char header[13];
+    header[0] = static_cast<unsigned char>(width >> 24);
+    header[1] = static_cast<unsigned char>(width >> 16);
+    header[2] = static_cast<unsigned char>(width >> 8);
+    header[3] = static_cast<unsigned char>(width);
+    header[4] = static_cast<unsigned char>(height >> 24);
+    header[5] = static_cast<unsigned char>(height >> 16);
+    header[6] = static_cast<unsigned char>(height >> 8);
+    header[7] = static_cast<unsigned char>(height);
+    header[8] = 8;     // bitů na kanál
+    header[9] = 2;     // RGB
+    header[10] = 0;
+    header[11] = 0;
+    header[12] = 0;
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    vector<unsigned char> png(signature, signature + 8);
+    png.reserve(8 + 25 + idat.size() + 12 + 12);
+    putChunk(png, "IHDR", header, sizeof(header));
+    putChunk(png, "IDAT", idat.data(), idat.size());
+    putChunk(png, "IEND", nullptr, 0);
+
+    FILE* out = fopen(path, "wb");
+    if (!out) return false;
+    bool ok = fwrite(png.data(), 1, png.size(), out) == png.size();
+    fclose(out);
+    return ok;
+}
+
+void FrameCapture::printStats() {
+    long long written, repeated, writeErrors;
+    double writeMs;
+    int writeFrames, queued;
+    {
+        lock_guard<mutex> lock(queueMutex);
+        written = stats.written;
+        repeated = stats.repeated;
+        writeErrors = stats.writeErrors;
+        writeMs = stats.writeMs;
+        writeFrames = stats.writeFrames;
+        queued = static_cast<int>(queue.size());
+        stats.writeMs = 0.0;
+        stats.writeFrames = 0;
+    }
+    int frames = stats.frames > 0 ? stats.frames : 1;
+    double share = stats.frameMs > 0.0 ? 100.0 * stats.cpuMs / stats.frameMs : 0.0;
+    printf("Frame capture: %lld captured, %lld written (%lld repeated), %lld skipped, %lld dropped, %lld stalls, "
+        "%lld write errors, queue %d/%d, capture %.2f ms/frame (max %.2f, %.1f%% of frame time), stalls %.1f ms, "
+        "writer %.2f ms/frame\n",
+        stats.captured, written, repeated, stats.skipped, stats.dropped, stats.stalls, writeErrors, queued, QUEUE_LIMIT,
+        stats.cpuMs / frames, stats.maxCpuMs, share, stats.stallMs, writeFrames > 0 ? writeMs / writeFrames : 0.0);
+    stats.frames = 0;
+    stats.cpuMs = 0.0;
+    stats.maxCpuMs = 0.0;
+    stats.frameMs = 0.0;
+    stats.stallMs = 0.0;
+}
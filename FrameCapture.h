@@ -0,0 +1,129 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdio.h>
+
+using namespace std;
+
+enum CaptureFormat {
+    CAPTURE_RAW,     // RGB24 snímky za sebou v jednom souboru (ffmpeg -f rawvideo -pix_fmt rgb24)
+    CAPTURE_Y4M,     // YUV4MPEG2 4:2:0, ffmpeg i mpv ho čtou přímo
+    CAPTURE_PNG      // soubor na snímek prefix000001.png
+};
+
+// Statistiky záznamu (časy v ms)
+struct FrameCaptureStats {
+    long long captured;          // snímky předané zapisovači
+    long long written;           // snímky ve výstupu včetně opakovaných
+    long long skipped;           // vykreslené nad cílovou frekvenci, nečtou se
+    long long repeated;          // mezery v čase vyplněné předchozím snímkem
+    long long dropped;           // všechny PBO u zapisovače nebo jiná velikost okna
+    long long stalls;            // PBO nebylo hotové ani po RING_SIZE snímcích
+    long long writeErrors;
+    // Od posledního printStats
+    int frames;
+    double cpuMs;                // capture() na render vlákně
+    double maxCpuMs;
+    double frameMs;              // doba mezi voláními capture() = délka snímku
+    double stallMs;
+    double writeMs;              // převod a zápis na vlákně zapisovače
+    int writeFrames;
+};
+
+// Záznam snímků s pevnou frekvencí fps bez zastavení pipeline. Snímek dostane
+// pozici ve výstupu podle času od začátku záznamu (čas * fps). Když se renderuje
+// rychleji, snímky na už obsazené pozici se vůbec nečtou; když pomaleji (nebo se
+// snímek zahodí), zapisovač mezeru vyplní opakováním předchozího snímku, takže
+// video hraje skutečnou rychlostí.
+// glReadPixels zadní vyrovnávací paměti jde do pixel buffer objektu a vrátí se
+// hned; za PBO se vloží fence. Až fence doběhne, PBO se namapuje a zapisovač
+// převádí přímo z namapované paměti - render vlákno nic nekopíruje, jen PBO po
+// zápisu odmapuje a použije znovu. PBO je nejvýše RING_SIZE + QUEUE_LIMIT; když
+// jsou všechna u zapisovače, snímek se zahodí (a započítá) - render vlákno na
+// disk nikdy nečeká.
+// capture()/finish() volá jen vlákno s GL kontextem.
+class FrameCapture {
+private:
+    static const int RING_SIZE = 3;          // čtení na cestě (čekají na fence)
+    static const int QUEUE_LIMIT = 8;        // namapované snímky u zapisovače
+    static const int MAX_BUFFERS = RING_SIZE + QUEUE_LIMIT;
+
+    struct Frame {
+        GLuint pbo;
+        size_t capacity;                 // alokovaná velikost PBO v bajtech
+        const unsigned char* pixels;     // namapovaný PBO: BGRA, řádky odspodu; nullptr = odmapovaný
+        int width;
+        int height;
+        long long index;                 // pozice ve výstupu (čas * fps)
+    };
+
+    struct Slot {
+        Frame* frame;
+        GLsync fence;            // nullptr = nic nečeká na vyzvednutí
+    };
+
+    string path;
+    CaptureFormat format;
+    int fps;
+
+    Slot ring[RING_SIZE];
+    int ringIndex;               // slot pro příští čtení = nejstarší čekající
+    int streamWidth;             // velikost prvního snímku (RAW/Y4M ji nemůže měnit)
+    int streamHeight;
+    double lastCaptureTime;
+    double startTime;            // první capture(), od něj se počítají pozice snímků
+    long long lastIndex;         // pozice posledního přečteného snímku
+
+    // PBO vlastní GL vlákno; zapisovač z nich jen čte, dokud jsou namapované
+    vector<Frame*> frames;       // všechny vytvořené
+    vector<Frame*> freeFrames;   // odmapované, připravené pro glReadPixels
+    vector<Frame*> doneScratch;
+
+    // Vlákno zapisovače
+    thread writer;
+    mutex queueMutex;
+    condition_variable queueCondition;
+    condition_variable drainedCondition;
+    deque<Frame*> queue;
+    vector<Frame*> writtenFrames;    // zapsané, čekají na odmapování GL vláknem
+    int framesWriting;           // vyzvednuté zapisovačem a ještě nevrácené
+    bool stopping;
+    FILE* file;                  // RAW/Y4M, PNG otevírá soubor na snímek
+
+    FrameCaptureStats stats;
+
+    bool isSignaled(GLsync fence) const;
+    Frame* acquireFrame(size_t size);
+    void collect(Slot& slot);
+    void recycle();
+    void writerLoop();
+    bool writeFrame(long long index, const unsigned char* rgb, int width, int height, vector<unsigned char>& scratch);
+    static void toRGB(const Frame& frame, vector<unsigned char>& rgb);
+    static bool writeY4M(FILE* file, const unsigned char* rgb, int width, int height, vector<unsigned char>& planes);
+    static bool writePNG(const char* path, const unsigned char* rgb, int width, int height, vector<unsigned char>& scratch);
+public:
+    FrameCapture(const string& path, int fps = 60);
+    ~FrameCapture();
+
+    // Formát podle přípony: .y4m, .raw/.rgb, jinak prefix souborů PNG
+    static CaptureFormat formatFromPath(const string& path);
+
+    // Vytvoří PBO (GL vlákno), otevře výstup a spustí zapisovač
+    bool initialize();
+    // Po vykreslení snímku, před glfwSwapBuffers (čte zadní buffer framebufferu 0)
+    void capture(int width, int height);
+    // Dočte čekající PBO, počká na zapisovač a PBO smaže (před zrušením kontextu)
+    void finish();
+    // Dopíše frontu, zastaví vlákno a zavře soubor
+    void stop();
+
+    CaptureFormat getFormat() const { return format; }
+    const FrameCaptureStats& getStats() const { return stats; }
+    // Vypíše stav a vynuluje intervalové hodnoty
+    void printStats();
+};
@@ -0,0 +1,40 @@
+#include "FrameLimiter.h"
+#include "FramePipeline.h"
+#include "Profiler.h"
+
+FrameLimiter::FrameLimiter(int maxQueued)
+    : maxQueued(maxQueued), waitTotalMs(0.0), waits(0) {
+}
+
+FrameLimiter::~FrameLimiter() {
+    // Fence patří GL kontextu, bez něj je nelze smazat - release() se volá dřív
+}
+
+void FrameLimiter::frameSubmitted() {
+    if (maxQueued <= 0) return;
+
+    fences.push_back(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+    if (static_cast<int>(fences.size()) > maxQueued) {
+        PROFILE_SCOPE("FrameLimiter wait");
+        double start = FramePipeline::now();
+        while (static_cast<int>(fences.size()) > maxQueued) {
+            GLsync oldest = fences.front();
+            // Flush zajistí, že fence vůbec dojde na GPU
+            GLenum result = glClientWaitSync(oldest, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000); // 100 ms
+            if (result == GL_TIMEOUT_EXPIRED) continue;
+            glDeleteSync(oldest);
+            fences.pop_front();
+        }
+        // Jediný zapisovatel, stačí načíst a uložit
+        waitTotalMs.store(waitTotalMs.load(memory_order_relaxed) + FramePipeline::now() - start, memory_order_relaxed);
+        waits.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+void FrameLimiter::release() {
+    for (auto fence : fences) {
+        glDeleteSync(fence);
+    }
+    fences.clear();
+}
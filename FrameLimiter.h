@@ -0,0 +1,31 @@
+#pragma once
+#include <GL/glew.h>
+#include <deque>
+#include <atomic>
+
+using namespace std;
+
+// Omezí počet snímků, které ovladač drží ve frontě za CPU.
+// Po každém swapu se vloží fence; když je jich víc než maxQueued,
+// čeká se na nejstarší. CPU tak neutíká GPU napřed a vstup je čerstvější.
+// Volá jen vlákno s GL kontextem; statistiky čekání smí číst i jiné vlákno.
+class FrameLimiter {
+private:
+    deque<GLsync> fences;
+    int maxQueued;           // 0 = bez omezení
+    atomic<double> waitTotalMs;  // zapisuje jen GL vlákno
+    atomic<long long> waits;
+public:
+    FrameLimiter(int maxQueued = 1);
+    ~FrameLimiter();
+
+    // Po glfwSwapBuffers
+    void frameSubmitted();
+    // Smaže fence (před zrušením kontextu)
+    void release();
+
+    void setMaxQueued(int frames) { maxQueued = frames < 0 ? 0 : frames; }
+    int getMaxQueued() const { return maxQueued; }
+    double getWaitTotalMs() const { return waitTotalMs.load(memory_order_relaxed); }
+    long long getWaits() const { return waits.load(memory_order_relaxed); }
+};
@@ -0,0 +1,135 @@
+#include "FramePipeline.h"
+#include "Profiler.h"
+#include <chrono>
+#include <algorithm>
+#include <stdio.h>
+
+double FramePipeline::now() {
+    using namespace std::chrono;
+    return duration<double, milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+FramePipeline::FramePipeline(int framesInFlight)
+    : framesInFlight(framesInFlight < 1 ? 1 : framesInFlight),
+    submitted(0), released(0), stopping(false), waitTotalMs(0.0) {
+    slots.resize(this->framesInFlight);
+}
+
+FramePipeline::~FramePipeline() {
+    stop();
+}
+
+void FramePipeline::start(function<void()> onThreadStart,
+    function<void(const RenderSnapshot&)> onRender,
+    function<void()> onThreadEnd) {
+    threadStart = onThreadStart;
+    renderCallback = onRender;
+    threadEnd = onThreadEnd;
+    stopping = false;
+    renderThread = thread(&FramePipeline::renderLoop, this);
+}
+
+void FramePipeline::stop() {
+    if (!renderThread.joinable()) return;
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    readyCondition.notify_all();
+    renderThread.join();
+}
+
+RenderSnapshot* FramePipeline::acquire() {
+    PROFILE_SCOPE("FramePipeline::acquire");
+    double waitStart = now();
+    unique_lock<mutex> lock(queueMutex);
+    freeCondition.wait(lock, [this]() { return submitted - released < framesInFlight; });
+    RenderSnapshot* slot = &slots[submitted % framesInFlight];
+    lock.unlock();
+
+    lock_guard<mutex> statsLock(statsMutex);
+    waitTotalMs += now() - waitStart;
+    return slot;
+}
+
+void FramePipeline::submit(RenderSnapshot* snapshot) {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        // Odeslat jde jen slot vrácený posledním acquire(), jinak by render vlákno četlo jiný snímek
+        if (snapshot != &slots[submitted % framesInFlight]) {
+            printf("FramePipeline: submitted snapshot is not the acquired slot, frame skipped\n");
+            return;
+        }
+        submitted++;
+    }
+    readyCondition.notify_one();
+}
+
+void FramePipeline::renderLoop() {
+    PROFILE_THREAD_NAME("Render");
+    if (threadStart) threadStart();
+
+    while (true) {
+        RenderSnapshot* snapshot = nullptr;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            readyCondition.wait(lock, [this]() { return stopping || released < submitted; });
+            if (released == submitted) break; // stopping a nic nezbývá
+            snapshot = &slots[released % framesInFlight];
+        }
+
+        double start = now();
+        renderCallback(*snapshot);
+        double end = now();
+
+        {
+            lock_guard<mutex> statsLock(statsMutex);
+            renderIntervals.push_back(Interval{ start, end });
+        }
+        {
+            lock_guard<mutex> lock(queueMutex);
+            released++;
+        }
+        freeCondition.notify_one();
+    }
+
+    if (threadEnd) threadEnd();
+}
+
+void FramePipeline::recordUpdate(double start, double end) {
+    lock_guard<mutex> statsLock(statsMutex);
+    updateIntervals.push_back(Interval{ start, end });
+}
+
+void FramePipeline::printStats() {
+    lock_guard<mutex> statsLock(statsMutex);
+    if (updateIntervals.empty() || renderIntervals.empty()) return;
+
+    double updateMs = 0.0;
+    double renderMs = 0.0;
+    double overlapMs = 0.0;
+    for (const auto& u : updateIntervals) updateMs += u.end - u.start;
+    for (const auto& r : renderIntervals) renderMs += r.end - r.start;
+
+    // Oba seznamy jsou seřazené (každé vlákno pracuje sekvenčně)
+    size_t i = 0, j = 0;
+    while (i < updateIntervals.size() && j < renderIntervals.size()) {
+        const Interval& u = updateIntervals[i];
+        const Interval& r = renderIntervals[j];
+        double overlap = min(u.end, r.end) - max(u.start, r.start);
+        if (overlap > 0.0) overlapMs += overlap;
+        if (u.end < r.end) i++;
+        else j++;
+    }
+
+    double frames = static_cast<double>(updateIntervals.size());
+    printf("Pipeline (%d in flight): %d frames | update %.3f ms | render %.3f ms | overlap %.3f ms/frame (%.0f%% of update) | main waited %.3f ms/frame\n",
+        framesInFlight, static_cast<int>(updateIntervals.size()),
+        updateMs / frames, renderMs / renderIntervals.size(),
+        overlapMs / frames, updateMs > 0.0 ? 100.0 * overlapMs / updateMs : 0.0,
+        waitTotalMs / frames);
+
+    updateIntervals.clear();
+    renderIntervals.clear();
+    waitTotalMs = 0.0;
+}
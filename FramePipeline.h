@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "RenderSnapshot.h"
+
+using namespace std;
+
+// Dvoustupňová pipeline: hlavní vlákno připravuje snímek N+1,
+// render vlákno (vlastník GL kontextu) zatím odesílá snímek N.
+class FramePipeline {
+private:
+    struct Interval {
+        double start;
+        double end;
+    };
+
+    int framesInFlight;
+    vector<RenderSnapshot> slots;
+    long long submitted;         // počet snímků předaných render vláknu
+    long long released;          // počet snímků, které render vlákno dokončilo
+    bool stopping;
+
+    mutex queueMutex;
+    condition_variable freeCondition;
+    condition_variable readyCondition;
+    thread renderThread;
+
+    function<void()> threadStart;
+    function<void(const RenderSnapshot&)> renderCallback;
+    function<void()> threadEnd;
+
+    // Instrumentace překryvu obou vláken
+    mutex statsMutex;
+    vector<Interval> updateIntervals;
+    vector<Interval> renderIntervals;
+    double waitTotalMs;
+
+    void renderLoop();
+public:
+    FramePipeline(int framesInFlight);
+    ~FramePipeline();
+
+    void start(function<void()> onThreadStart,
+        function<void(const RenderSnapshot&)> onRender,
+        function<void()> onThreadEnd);
+    // Dokreslí rozpracované snímky a ukončí render vlákno
+    void stop();
+
+    // Hlavní vlákno: volný slot (čeká, pokud je v letu framesInFlight snímků)
+    RenderSnapshot* acquire();
+    // Předá render vláknu slot z posledního acquire()
+    void submit(RenderSnapshot* snapshot);
+
+    void recordUpdate(double start, double end);
+    void printStats();
+
+    int getFramesInFlight() const { return framesInFlight; }
+    static double now();
+};
@@ -0,0 +1,369 @@
+#include "Impostors.h"
+#include "RenderSnapshot.h"
+#include "ShaderProgram.h"
+#include "Model.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <cmath>
+#include <stdio.h>
+
+// Jednotka textury atlasu (0 nechává běžným shaderům, 1 je stínová mapa)
+static const int ATLAS_TEXTURE_UNIT = 2;
+
+Impostors::Impostors()
+    : bakeShader(nullptr), bakeMvpLocation(-1), shader(nullptr), viewProjectionLocation(-1), cameraPositionLocation(-1),
+    lightPositionLocation(-1), boundsLocation(-1), shadingLocation(-1), atlasLocation(-1), vao(0), instanceBuffer(0),
+    instanceCapacity(0), active(false), distanceSquared(0.0f), cameraPosition(0.0f) {
+    stats = ImpostorStats{ 0, 0, 0, 0 };
+}
+
+Impostors::~Impostors() {
+    for (auto& atlas : atlases) {
+        glDeleteTextures(1, &atlas.texture);
+    }
+    if (bakeShader) delete bakeShader;
+    if (shader) delete shader;
+    if (vao) glDeleteVertexArrays(1, &vao);
+    if (instanceBuffer) glDeleteBuffers(1, &instanceBuffer);
+}
+
+bool Impostors::initialize() {
+    // Zapékání: atribut location 1 zakódovaný do 0..1, alfa = pokrytí
+    const char* bake_vertex_shader =
+        "#version 330 core\n"
+        "layout(location=0) in vec3 vp;"
+        "layout(location=1) in vec3 vn;"
+        "uniform mat4 mvpMatrix;"
+        "out vec3 attribute;"
+        "void main() {"
+        "    gl_Position = mvpMatrix * vec4(vp, 1.0);"
+        "    attribute = vn;"
+        "}";
+    const char* bake_fragment_shader =
+        "#version 330\n"
+        "in vec3 attribute;"
+        "out vec4 fragColor;"
+        "void main() { fragColor = vec4(clamp(attribute, -1.0, 1.0) * 0.5 + 0.5, 1.0); }";
+
+    // Čtverec z gl_VertexID natočený ke kameře v prostoru modelu, báze stejná jako
+    // lookAt při zapékání. Směr ke kameře vybere 4 nejbližší pohledy a bilineární váhy.
+    const char* vertex_shader =
+        "#version 330 core\n"
+        "layout(location=2) in mat4 instanceMatrix;"
+        "layout(location=6) in uint instanceMaterial;"
+        "uniform mat4 viewProjection;"
+        "uniform vec3 cameraPosition;"
+        "uniform vec3 lightPosition;"
+        "uniform vec4 bounds;"
+        "uniform float frames;"
+        "out vec2 quadUV;"
+        "out vec3 lightDirection;"
+        "out vec4 weights;"
+        "flat out vec4 cells01;"
+        "flat out vec4 cells23;"
+        "flat out int material;"
+        "void main() {"
+        "    material = int(instanceMaterial);"
+        "    mat3 toModel = inverse(mat3(instanceMatrix));"
+        "    vec3 worldCenter = (instanceMatrix * vec4(bounds.xyz, 1.0)).xyz;"
+        "    vec3 dir = normalize(toModel * (cameraPosition - worldCenter));"
+        "    vec3 h = vec3(dir.x, max(dir.y, 0.0), dir.z);"
+        "    h /= abs(h.x) + h.y + abs(h.z);"
+        "    vec2 grid = (vec2(h.x + h.z, h.x - h.z) * 0.5 + 0.5) * (frames - 1.0);"
+        "    vec2 base = min(floor(grid), vec2(frames - 2.0));"
+        "    vec2 f = grid - base;"
+        "    cells01 = vec4(base, base + vec2(1.0, 0.0));"
+        "    cells23 = vec4(base + vec2(0.0, 1.0), base + vec2(1.0));"
+        "    weights = vec4((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);"
+        "    vec3 up = abs(dir.y) > 0.999 ? vec3(0.0, 0.0, -1.0) : vec3(0.0, 1.0, 0.0);"
+        "    vec3 right = normalize(cross(up, dir));"
+        "    vec3 quadUp = cross(dir, right);"
+        "    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;"
+        "    vec3 local = bounds.xyz + (right * corner.x + quadUp * corner.y) * bounds.w;"
+        "    quadUV = corner * 0.5 + 0.5;"
+        "    lightDirection = toModel * (lightPosition - worldCenter);"
+        "    gl_Position = viewProjection * instanceMatrix * vec4(local, 1.0);"
+        "}";
+    const char* fragment_shader =
+        "#version 330\n"
+        "in vec2 quadUV;"
+        "in vec3 lightDirection;"
+        "in vec4 weights;"
+        "flat in vec4 cells01;"
+        "flat in vec4 cells23;"
+        "flat in int material;"
+        "uniform sampler2D atlas;"
+        "uniform float frames;"
+        "uniform int shading;"
+        "out vec4 fragColor;"
+        "vec4 frame(vec2 cell) { return texture(atlas, (cell + clamp(quadUV, 0.01, 0.99)) / frames); }"
+        "void main() {"
+        "    vec4 s = frame(cells01.xy) * weights.x + frame(cells01.zw) * weights.y +"
+        "             frame(cells23.xy) * weights.z + frame(cells23.zw) * weights.w;"
+        "    if (s.a < 0.5) discard;"
+        "    vec3 attribute = s.rgb / s.a * 2.0 - 1.0;"
+        "    vec4 objectColor = materials[material].diffuse;"
+        "    if (shading == 0) fragColor = vec4(attribute, 1.0);"
+        "    else if (shading == 1) fragColor = objectColor;"
+        "    else fragColor = materials[material].ambient + max(dot(normalize(attribute), normalize(lightDirection)), 0.0) * objectColor;"
+        "}";
+
+    bakeShader = new ShaderProgram();
+    shader = new ShaderProgram();
+    if (!bakeShader->loadMainShader(bake_vertex_shader, bake_fragment_shader) ||
+        !shader->loadMainShader(vertex_shader, fragment_shader, true)) {
+        return false;
+    }
+    bakeMvpLocation = glGetUniformLocation(bakeShader->getProgram(), "mvpMatrix");
+
+    GLuint program = shader->getProgram();
+    viewProjectionLocation = glGetUniformLocation(program, "viewProjection");
+    cameraPositionLocation = glGetUniformLocation(program, "cameraPosition");
+    lightPositionLocation = glGetUniformLocation(program, "lightPosition");
+    boundsLocation = glGetUniformLocation(program, "bounds");
+    shadingLocation = glGetUniformLocation(program, "shading");
+    atlasLocation = glGetUniformLocation(program, "atlas");
+    glUseProgram(program);
+    glUniform1f(glGetUniformLocation(program, "frames"), static_cast<float>(FRAMES));
+    glUseProgram(0);
+
+    // Matice instance v atributech 2-5 a materiál v 6, ukazatele se posouvají pro každou dávku
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &instanceBuffer);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    for (int a = 2; a <= 6; a++) {
+        glEnableVertexAttribArray(a);
+        glVertexAttribDivisor(a, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    printf("Impostors initialized (%dx%d views, %d px per view)\n", FRAMES, FRAMES, CELL_SIZE);
+    return true;
+}
+
+bool Impostors::addModel(Model* model) {
+    if (!model || !shader) return false;
+    for (const auto& atlas : atlases) {
+        if (atlas.model == model) return true;
+    }
+
+    Atlas atlas;
+    atlas.model = model;
+    atlas.texture = 0;
+    atlas.bounds = model->getBoundingSphere();
+    if (!bake(atlas)) {
+        if (atlas.texture) glDeleteTextures(1, &atlas.texture);
+        return false;
+    }
+    atlases.push_back(atlas);
+    stats.models = static_cast<int>(atlases.size());
+    return true;
+}
+
+bool Impostors::bake(Atlas& atlas) {
+    PROFILE_SCOPE("Impostors::bake");
+    int size = FRAMES * CELL_SIZE;
+
+    glGenTextures(1, &atlas.texture);
+    glBindTexture(GL_TEXTURE_2D, atlas.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    GLuint fbo = 0;
+    GLuint depth = 0;
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size, size);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas.texture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    if (complete) {
+        GLint viewport[4];
+        GLfloat clearColor[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+
+        // Prázdné pixely s nulovou alfou - filtrování pak míchá přenásobené hodnoty
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glUseProgram(bakeShader->getProgram());
+
+        glm::vec3 center(atlas.bounds.x, atlas.bounds.y, atlas.bounds.z);
+        float radius = atlas.bounds.w > 0.0f ? atlas.bounds.w : 1.0f;
+        glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, radius * 0.5f, radius * 3.5f);
+        for (int y = 0; y < FRAMES; y++) {
+            for (int x = 0; x < FRAMES; x++) {
+                // Inverze hemi-oktaedrického kódování ze shaderu, pohledy včetně obzoru
+                float px = x * 2.0f / (FRAMES - 1) - 1.0f;
+                float py = y * 2.0f / (FRAMES - 1) - 1.0f;
+                glm::vec3 dir((px + py) * 0.5f, 0.0f, (px - py) * 0.5f);
+                dir.y = 1.0f - fabs(dir.x) - fabs(dir.z);
+                dir = glm::normalize(dir);
+
+                glm::vec3 up = fabs(dir.y) > 0.999f ? glm::vec3(0.0f, 0.0f, -1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+                glm::mat4 mvp = projection * glm::lookAt(center + dir * (radius * 2.0f), center, up);
+                glUniformMatrix4fv(bakeMvpLocation, 1, GL_FALSE, glm::value_ptr(mvp));
+                glViewport(x * CELL_SIZE, y * CELL_SIZE, CELL_SIZE, CELL_SIZE);
+                atlas.model->draw();
+            }
+        }
+
+        glUseProgram(0);
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+    else {
+        printf("Impostor atlas framebuffer incomplete\n");
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &depth);
+
+    // Mipmapy jen do velikosti, kdy pohledy ještě nesplývají (64 -> 8 px)
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 3);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (complete) glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (complete) {
+        stats.atlasBytes += static_cast<size_t>(size) * size * 4 * 4 / 3;
+        printf("Baked impostor atlas: %d views, radius %.2f\n", FRAMES * FRAMES, atlas.bounds.w);
+    }
+    return complete;
+}
+
+int Impostors::getShading(ShaderProgram* program) {
+    GLuint id = program->getProgram();
+    for (const auto& entry : programShading) {
+        if (entry.first == id) return entry.second;
+    }
+
+    // Původní shader bere location 1 jako barvu, osvětlené mají pozici světla
+    int shading = SHADING_CONSTANT;
+    if (glGetAttribLocation(id, "color") != -1) shading = SHADING_ATTRIBUTE;
+    else if (glGetUniformLocation(id, "lightPosition") != -1) shading = SHADING_LIT;
+    programShading.push_back(make_pair(id, shading));
+    return shading;
+}
+
+void Impostors::beginFrame(const RenderSnapshot& frame) {
+    active = frame.impostorDistance > 0.0f && frame.viewCount == 1 && !atlases.empty();
+    distanceSquared = frame.impostorDistance * frame.impostorDistance;
+    cameraPosition = frame.cameraPosition;
+    stats.instances = 0;
+    stats.draws = 0;
+}
+
+bool Impostors::replaces(const Model* model, const glm::mat4& modelMatrix) const {
+    if (!active || !model) return false;
+    bool baked = false;
+    for (const auto& atlas : atlases) {
+        if (atlas.model == model) {
+            baked = true;
+            break;
+        }
+    }
+    if (!baked) return false;
+
+    glm::vec3 offset(modelMatrix[3].x - cameraPosition.x, modelMatrix[3].y - cameraPosition.y, modelMatrix[3].z - cameraPosition.z);
+    return glm::dot(offset, offset) > distanceSquared;
+}
+
+void Impostors::render(const RenderSnapshot& frame, const vector<RenderItem>& items) {
+    if (!active) return;
+    PROFILE_SCOPE("Impostors::render");
+
+    // Dávky zůstávají mezi snímky, vyprázdní se jen matice
+    for (auto& batch : batches) {
+        batch.instances.clear();
+    }
+    for (const auto& item : items) {
+        if (!item.shader || !replaces(item.model, item.matrices.model)) continue;
+
+        int atlas = 0;
+        while (atlases[atlas].model != item.model) atlas++;
+        int shading = getShading(item.shader);
+        Batch* target = nullptr;
+        for (auto& batch : batches) {
+            if (batch.atlas == atlas && batch.shading == shading) target = &batch;
+        }
+        if (!target) {
+            batches.push_back(Batch{ atlas, shading, vector<Instance>() });
+            target = &batches.back();
+        }
+        target->instances.push_back(Instance{ item.matrices.model, item.material });
+    }
+
+    uploadData.clear();
+    for (const auto& batch : batches) {
+        uploadData.insert(uploadData.end(), batch.instances.begin(), batch.instances.end());
+    }
+    if (uploadData.empty()) return;
+
+    PROFILE_GPU_SCOPE("Impostors");
+    size_t bytes = uploadData.size() * sizeof(Instance);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    if (bytes > instanceCapacity) {
+        instanceCapacity = bytes * 2;
+    }
+    // Osiření bufferu - GPU může ještě číst data předchozího snímku
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, uploadData.data());
+    RenderStats::bufferUpload(static_cast<long long>(bytes));
+
+    GLuint program = shader->getProgram();
+    glUseProgram(program);
+    RenderStats::programBind();
+    glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(frame.viewProjection));
+    glUniform3fv(cameraPositionLocation, 1, glm::value_ptr(frame.cameraPosition));
+    glUniform3fv(lightPositionLocation, 1, glm::value_ptr(frame.lightPosition));
+    glUniform1i(atlasLocation, ATLAS_TEXTURE_UNIT);
+    RenderStats::uniformUpload(4);
+    glActiveTexture(GL_TEXTURE0 + ATLAS_TEXTURE_UNIT);
+    glBindVertexArray(vao);
+    RenderStats::vaoBind();
+
+    size_t first = 0;
+    for (const auto& batch : batches) {
+        if (batch.instances.empty()) continue;
+
+        size_t offset = first * sizeof(Instance);
+        for (int c = 0; c < 4; c++) {
+            glVertexAttribPointer(2 + c, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                reinterpret_cast<void*>(offset + c * sizeof(glm::vec4)));
+        }
+        glVertexAttribIPointer(6, 1, GL_UNSIGNED_INT, sizeof(Instance), reinterpret_cast<void*>(offset + sizeof(glm::mat4)));
+        glBindTexture(GL_TEXTURE_2D, atlases[batch.atlas].texture);
+        glUniform4fv(boundsLocation, 1, glm::value_ptr(atlases[batch.atlas].bounds));
+        glUniform1i(shadingLocation, batch.shading);
+        RenderStats::uniformUpload(2);
+
+        int count = static_cast<int>(batch.instances.size());
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+        RenderStats::drawCall(6 * count);   // 2 trojúhelníky na instanci
+        stats.instances += count;
+        stats.draws++;
+        first += batch.instances.size();
+    }
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Impostors::printStats() const {
+    printf("Impostors: %d instances in %d draws, %d atlases (%.1f MB)%s\n",
+        stats.instances, stats.draws, stats.models, stats.atlasBytes / (1024.0 * 1024.0), active ? "" : ", inactive");
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+using namespace std;
+
+class Model;
+class ShaderProgram;
+struct RenderSnapshot;
+struct RenderItem;
+
+// Statistiky impostorů (poslední snímek)
+struct ImpostorStats {
+    int instances;               // instance nakreslené jako impostor
+    int draws;                   // instancovaná volání
+    int models;                  // modely s atlasem
+    size_t atlasBytes;
+};
+
+// Impostory vzdálené vegetace.
+// Při načtení se model vykreslí ortograficky z FRAMES x FRAMES směrů horní polokoule
+// (hemi-oktaedrické rozložení) do atlasu; ukládá se atribut location 1 (normála/barva)
+// a pokrytí v alfě. Za vzdáleností z RenderSnapshot::impostorDistance se místo modelu
+// kreslí jeden čtverec natočený ke kameře na instanci, který míchá 4 nejbližší pohledy.
+// Běžné průchody (smyčka položek, draw list, předprůchod) se ptají replaces().
+class Impostors {
+private:
+    static const int FRAMES = 8;             // pohledů na stranu atlasu
+    static const int CELL_SIZE = 64;         // pixely na pohled
+
+    struct Atlas {
+        Model* model;
+        GLuint texture;
+        glm::vec4 bounds;                    // obalová koule modelu
+    };
+
+    // Data instance v atributech 2-6
+    struct Instance {
+        glm::mat4 matrix;
+        unsigned int material;   // index do MaterialTable - různé materiály v jedné dávce
+    };
+
+    // Instance jednoho modelu se stejným způsobem stínování
+    struct Batch {
+        int atlas;               // index do atlases
+        int shading;
+        vector<Instance> instances;
+    };
+
+    vector<Atlas> atlases;
+    vector<Batch> batches;
+    vector<Instance> uploadData;
+    vector<pair<GLuint, int>> programShading;    // program položky -> způsob stínování
+
+    ShaderProgram* bakeShader;
+    GLint bakeMvpLocation;
+    ShaderProgram* shader;
+    GLint viewProjectionLocation;
+    GLint cameraPositionLocation;
+    GLint lightPositionLocation;
+    GLint boundsLocation;
+    GLint shadingLocation;
+    GLint atlasLocation;
+    GLuint vao;
+    GLuint instanceBuffer;
+    size_t instanceCapacity;
+
+    // Stav snímku (render vlákno)
+    bool active;
+    float distanceSquared;
+    glm::vec3 cameraPosition;
+
+    ImpostorStats stats;
+
+    int getShading(ShaderProgram* program);
+    bool bake(Atlas& atlas);
+public:
+    // Způsob stínování podle shaderu, který impostor nahrazuje
+    enum Shading {
+        SHADING_ATTRIBUTE,       // atribut jako barva (původní shader)
+        SHADING_CONSTANT,        // jednolitá barva
+        SHADING_LIT              // Lambert s okolním světlem (bez stínů a odlesků)
+    };
+
+    Impostors();
+    ~Impostors();
+
+    bool initialize();
+    // Předpočítá atlas modelu (vlákno s GL kontextem, při načítání)
+    bool addModel(Model* model);
+
+    // Začátek snímku (render vlákno): vzdálenost a kamera ze snímku, jen pro jeden pohled
+    void beginFrame(const RenderSnapshot& frame);
+    // true = položka se kreslí jako impostor, běžný průchod ji přeskočí
+    bool replaces(const Model* model, const glm::mat4& modelMatrix) const;
+    // Vykreslí nahrazené položky instancovaně (jedno volání na model a stínování)
+    void render(const RenderSnapshot& frame, const vector<RenderItem>& items);
+
+    bool isActive() const { return active; }
+    const ImpostorStats& getStats() const { return stats; }
+    void printStats() const;
+};
@@ -0,0 +1,24 @@
+#include "InputQueue.h"
+#include "FramePipeline.h"
+
+InputQueue::InputQueue() : totalEvents(0) {
+    events.reserve(64);
+}
+
+void InputQueue::pushKey(int key, int action) {
+    InputEvent e = { INPUT_KEY, key, action, 0.0, 0.0, FramePipeline::now() };
+    events.push_back(e);
+    totalEvents++;
+}
+
+void InputQueue::pushMouseButton(int button, int action) {
+    InputEvent e = { INPUT_MOUSE_BUTTON, button, action, 0.0, 0.0, FramePipeline::now() };
+    events.push_back(e);
+    totalEvents++;
+}
+
+void InputQueue::pushMouseMove(double x, double y) {
+    InputEvent e = { INPUT_MOUSE_MOVE, 0, 0, x, y, FramePipeline::now() };
+    events.push_back(e);
+    totalEvents++;
+}
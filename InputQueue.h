@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+
+using namespace std;
+
+enum InputEventType {
+    INPUT_KEY,
+    INPUT_MOUSE_BUTTON,
+    INPUT_MOUSE_MOVE
+};
+
+// Jedna událost z GLFW callbacku s časem příchodu (ms, FramePipeline::now)
+struct InputEvent {
+    InputEventType type;
+    int code;                // klávesa / tlačítko
+    int action;              // GLFW_PRESS / GLFW_RELEASE
+    double x;
+    double y;
+    double timestamp;
+};
+
+// Fronta událostí mezi callbacky a updatem snímku.
+// Callbacky jen zapisují, Controller frontu zpracuje až těsně před updatem kamery.
+// Obojí běží v hlavním vlákně (glfwPollEvents), zámek není potřeba.
+class InputQueue {
+private:
+    vector<InputEvent> events;
+    long long totalEvents;
+public:
+    InputQueue();
+
+    void pushKey(int key, int action);
+    void pushMouseButton(int button, int action);
+    void pushMouseMove(double x, double y);
+
+    bool isEmpty() const { return events.empty(); }
+    const vector<InputEvent>& getEvents() const { return events; }
+    void clear() { events.clear(); }
+
+    long long getTotalEvents() const { return totalEvents; }
+};
@@ -0,0 +1,253 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <chrono>
+#include <stdio.h>
+
+// Worker vlákno patří právě jednomu systému; vlákno s indexem 0 se pozná
+// podle ownerThread (může vlastnit i více systémů, např. v benchmarku)
+static thread_local const JobSystem* currentSystem = nullptr;
+static thread_local int currentThreadIndex = -1;
+
+WorkStealingQueue::WorkStealingQueue() : top(0), bottom(0) {
+    for (long long i = 0; i < CAPACITY; i++) {
+        buffer[i].store(nullptr, memory_order_relaxed);
+    }
+}
+
+bool WorkStealingQueue::push(Job* job) {
+    long long b = bottom.load(memory_order_relaxed);
+    long long t = top.load(memory_order_acquire);
+    if (b - t >= CAPACITY) {
+        return false;
+    }
+    buffer[b & MASK].store(job, memory_order_relaxed);
+    // Release - zloděj, který uvidí nový bottom, uvidí i vyplněnou úlohu
+    bottom.store(b + 1, memory_order_release);
+    return true;
+}
+
+bool WorkStealingQueue::isFull() const {
+    long long b = bottom.load(memory_order_relaxed);
+    long long t = top.load(memory_order_acquire);
+    return b - t >= CAPACITY;
+}
+
+Job* WorkStealingQueue::pop() {
+    long long b = bottom.load(memory_order_relaxed) - 1;
+    bottom.store(b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long t = top.load(memory_order_relaxed);
+
+    if (t > b) {
+        // Prázdná fronta
+        bottom.store(b + 1, memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = buffer[b & MASK].load(memory_order_relaxed);
+    if (t == b) {
+        // Poslední prvek - soupeříme se zloději
+        if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            job = nullptr;
+        }
+        bottom.store(b + 1, memory_order_relaxed);
+    }
+    return job;
+}
+
+Job* WorkStealingQueue::steal() {
+    long long t = top.load(memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long b = bottom.load(memory_order_acquire);
+
+    if (t >= b) {
+        return nullptr;
+    }
+
+    Job* job = buffer[t & MASK].load(memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return nullptr;
+    }
+    return job;
+}
+
+int JobSystem::getDefaultWorkerCount() {
+    int hardware = static_cast<int>(thread::hardware_concurrency());
+    return hardware > 1 ? hardware - 1 : 0;
+}
+
+JobSystem::JobSystem(int workerCount) : running(true), sleeping(0) {
+    if (workerCount < 0) workerCount = 0;
+
+    for (int i = 0; i < workerCount + 1; i++) {
+        Worker* worker = new Worker();
+        worker->jobPool = new Job[JOB_POOL_SIZE];
+        worker->nextJob = 0;
+        worker->random = 2463534242u + i * 7919u;
+        workers.push_back(worker);
+    }
+
+    // Vytvářející vlákno je worker 0
+    ownerThread = this_thread::get_id();
+
+    for (int i = 1; i <= workerCount; i++) {
+        threads.push_back(thread(&JobSystem::workerLoop, this, i));
+    }
+}
+
+JobSystem::~JobSystem() {
+    running.store(false);
+    sleepCondition.notify_all();
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (auto worker : workers) {
+        delete[] worker->jobPool;
+        delete worker;
+    }
+}
+
+int JobSystem::getThreadIndex() const {
+    if (currentSystem == this) return currentThreadIndex;
+    if (this_thread::get_id() == ownerThread) return 0;
+    return -1;
+}
+
+Job* JobSystem::allocateJob(int threadIndex) {
+    // Kruhový pool - obsazené sloty (úloha ve frontě nebo právě běží) se přeskakují
+    Worker* worker = workers[threadIndex];
+    for (int attempt = 0; attempt < JOB_POOL_SIZE; attempt++) {
+        Job* job = &worker->jobPool[worker->nextJob++ & (JOB_POOL_SIZE - 1)];
+        if (!job->inUse.load(memory_order_acquire)) {
+            job->inUse.store(true, memory_order_relaxed);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::schedule(JobFunction function, void* context, size_t begin, size_t end,
+    JobCounter* counter, JobCounter* dependency) {
+    int threadIndex = getThreadIndex();
+    if (threadIndex < 0 || threadIndex >= static_cast<int>(workers.size())) {
+        // Cizí vlákno - vykonáme hned
+        if (dependency) {
+            while (!dependency->isDone()) this_thread::yield();
+        }
+        function(context, begin, end);
+        return;
+    }
+
+    if (counter) {
+        counter->value.fetch_add(1, memory_order_relaxed);
+    }
+
+    // Plná fronta nebo pool - vykonáme hned, bez slotu v poolu
+    Job* job = workers[threadIndex]->queue.isFull() ? nullptr : allocateJob(threadIndex);
+    if (!job) {
+        Job inlineJob;
+        inlineJob.function = function;
+        inlineJob.context = context;
+        inlineJob.begin = begin;
+        inlineJob.end = end;
+        inlineJob.counter = counter;
+        inlineJob.dependency = dependency;
+        execute(&inlineJob);
+        return;
+    }
+
+    job->function = function;
+    job->context = context;
+    job->begin = begin;
+    job->end = end;
+    job->counter = counter;
+    job->dependency = dependency;
+
+    // Místo ve frontě je jisté - zloději ji mohou jen zmenšit
+    workers[threadIndex]->queue.push(job);
+
+    if (sleeping.load(memory_order_relaxed) > 0) {
+        sleepCondition.notify_one();
+    }
+}
+
+Job* JobSystem::findJob(int threadIndex) {
+    Worker* self = workers[threadIndex];
+    Job* job = self->queue.pop();
+    if (job) return job;
+
+    // Krádež od náhodné oběti (xorshift)
+    int count = static_cast<int>(workers.size());
+    for (int attempt = 0; attempt < count; attempt++) {
+        self->random ^= self->random << 13;
+        self->random ^= self->random >> 17;
+        self->random ^= self->random << 5;
+        int victim = static_cast<int>(self->random % count);
+        if (victim == threadIndex) continue;
+
+        job = workers[victim]->queue.steal();
+        if (job) return job;
+    }
+    return nullptr;
+}
+
+void JobSystem::execute(Job* job) {
+    if (job->dependency) {
+        wait(*job->dependency);
+    }
+    {
+        PROFILE_SCOPE("Job");
+        job->function(job->context, job->begin, job->end);
+    }
+    // Slot se uvolní před dekrementem - čekající může hned plánovat dál
+    JobCounter* counter = job->counter;
+    job->inUse.store(false, memory_order_release);
+    if (counter) {
+        counter->value.fetch_sub(1, memory_order_release);
+    }
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    int threadIndex = getThreadIndex();
+    while (!counter.isDone()) {
+        Job* job = (threadIndex >= 0) ? findJob(threadIndex) : nullptr;
+        if (job) {
+            execute(job);
+        }
+        else {
+            this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::workerLoop(int threadIndex) {
+    currentSystem = this;
+    currentThreadIndex = threadIndex;
+#if ZPG_PROFILING
+    char threadName[32];
+    snprintf(threadName, sizeof(threadName), "Worker %d", threadIndex);
+    Profiler::setThreadName(threadName);
+#endif
+    int idleSpins = 0;
+
+    while (running.load(memory_order_relaxed)) {
+        Job* job = findJob(threadIndex);
+        if (job) {
+            execute(job);
+            idleSpins = 0;
+            continue;
+        }
+
+        if (++idleSpins < 64) {
+            this_thread::yield();
+            continue;
+        }
+
+        // Nic na práci - uspání s timeoutem (pojistka proti ztracenému probuzení)
+        unique_lock<mutex> lock(sleepMutex);
+        sleeping.fetch_add(1);
+        sleepCondition.wait_for(lock, chrono::milliseconds(1));
+        sleeping.fetch_sub(1);
+        idleSpins = 0;
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+using namespace std;
+
+// Počítadlo nedokončených úloh - slouží k čekání a jako závislost
+struct JobCounter {
+    atomic<int> value;
+
+    JobCounter() : value(0) {}
+    bool isDone() const { return value.load(memory_order_acquire) == 0; }
+};
+
+typedef void (*JobFunction)(void* context, size_t begin, size_t end);
+
+struct Job {
+    JobFunction function;
+    void* context;
+    size_t begin;
+    size_t end;
+    JobCounter* counter;       // dekrementuje se po dokončení
+    JobCounter* dependency;    // úloha začne až po jeho vynulování
+    atomic<bool> inUse;        // slot v poolu je obsazený (ve frontě nebo běží)
+
+    Job() : function(nullptr), context(nullptr), begin(0), end(0),
+        counter(nullptr), dependency(nullptr), inUse(false) {}
+};
+
+// Lock-free deque (Chase-Lev) s pevnou kapacitou.
+// Vlastník volá push/pop na spodním konci, ostatní vlákna kradou z vrchu.
+class WorkStealingQueue {
+public:
+    static const long long CAPACITY = 4096;
+private:
+    static const long long MASK = CAPACITY - 1;
+
+    atomic<long long> top;
+    atomic<long long> bottom;
+    atomic<Job*> buffer[CAPACITY];
+public:
+    WorkStealingQueue();
+
+    bool push(Job* job);
+    Job* pop();
+    Job* steal();
+    // Volá jen vlastník - zloději frontu mohou jen zmenšit
+    bool isFull() const;
+};
+
+// Pevný pool vláken s work stealingem. Vlákno, které systém vytvořilo,
+// má index 0 a při wait() se zapojuje do práce.
+class JobSystem {
+private:
+    static const int JOB_POOL_SIZE = 8192;
+    // parallelFor naplánuje najednou nejvýše tolik úloh, kolik pojme fronta
+    static const size_t MAX_BATCH_JOBS = static_cast<size_t>(WorkStealingQueue::CAPACITY);
+
+    struct Worker {
+        WorkStealingQueue queue;
+        Job* jobPool;
+        unsigned int nextJob;
+        unsigned int random;
+    };
+
+    vector<Worker*> workers;
+    vector<thread> threads;
+    atomic<bool> running;
+    thread::id ownerThread;    // vlákno s indexem 0
+
+    mutex sleepMutex;
+    condition_variable sleepCondition;
+    atomic<int> sleeping;
+
+    // Index volajícího vlákna v tomto systému (-1 = cizí vlákno)
+    int getThreadIndex() const;
+    // nullptr = všechny sloty jsou obsazené
+    Job* allocateJob(int threadIndex);
+    Job* findJob(int threadIndex);
+    void execute(Job* job);
+    void workerLoop(int threadIndex);
+
+    template<typename F>
+    static void invokeRange(void* context, size_t begin, size_t end) {
+        (*static_cast<const F*>(context))(begin, end);
+    }
+public:
+    // workerCount = počet vláken navíc k volajícímu (celkem workerCount + 1)
+    JobSystem(int workerCount = getDefaultWorkerCount());
+    ~JobSystem();
+
+    void schedule(JobFunction function, void* context, size_t begin, size_t end,
+        JobCounter* counter, JobCounter* dependency = nullptr);
+    // Čeká na vynulování počítadla, mezitím vykonává jiné úlohy
+    void wait(JobCounter& counter);
+
+    // body(begin, end) pro bloky o velikosti grain
+    template<typename F>
+    void parallelFor(size_t count, size_t grain, const F& body) {
+        if (count == 0) return;
+        if (grain == 0) grain = 1;
+        if (workers.size() == 1 || count <= grain) {
+            body(0, count);
+            return;
+        }
+
+        // Po dávkách - rozpracovaných úloh je nejvýše tolik, kolik pojme fronta
+        size_t batchSize = grain * MAX_BATCH_JOBS;
+        for (size_t batchBegin = 0; batchBegin < count; batchBegin += batchSize) {
+            size_t batchEnd = min(count, batchBegin + batchSize);
+            JobCounter counter;
+            for (size_t begin = batchBegin; begin < batchEnd; begin += grain) {
+                size_t end = min(batchEnd, begin + grain);
+                schedule(&invokeRange<F>, (void*)&body, begin, end, &counter);
+            }
+            wait(counter);
+        }
+    }
+
+    int getThreadCount() const { return static_cast<int>(workers.size()); }
+    static int getDefaultWorkerCount();
+};
@@ -1,5 +1,5 @@
 #include "Light.h"
 
 Light::Light(const glm::vec3& pos, const glm::vec3& col)
-    : position(pos), color(col) {
+    : position(pos), color(col), revision(0) {
 }
\ No newline at end of file
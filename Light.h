@@ -5,6 +5,7 @@ class Light {
 private:
     glm::vec3 position;
     glm::vec3 color;
+    unsigned int revision;   // zvyšuje se při každé změně
 
 public:
     Light(const glm::vec3& pos = glm::vec3(0.0f),
@@ -13,6 +14,7 @@ public:
     glm::vec3 getPosition() const { return position; }
     glm::vec3 getColor() const { return color; }
 
-    void setPosition(const glm::vec3& pos) { position = pos; }
-    void setColor(const glm::vec3& col) { color = col; }
+    void setPosition(const glm::vec3& pos) { position = pos; revision++; }
+    void setColor(const glm::vec3& col) { color = col; revision++; }
+    unsigned int getRevision() const { return revision; }
 };
\ No newline at end of file
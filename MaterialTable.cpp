@@ -0,0 +1,99 @@
+#include "MaterialTable.h"
+#include "Profiler.h"
+#include <stdio.h>
+
+MaterialTable::MaterialTable() : revision(1), uploadedRevision(0), buffer(0) {
+    materials.push_back(getDefault());
+    names.push_back("default");
+}
+
+MaterialTable::~MaterialTable() {
+    if (buffer) glDeleteBuffers(1, &buffer);
+}
+
+Material MaterialTable::makeMaterial(const glm::vec3& color, float ambient, float specular, float shininess) {
+    Material material;
+    material.diffuse = glm::vec4(color, 1.0f);
+    material.ambient = glm::vec4(ambient, ambient, ambient, 1.0f);
+    material.specular = glm::vec4(specular, specular, specular, shininess);
+    return material;
+}
+
+Material MaterialTable::getDefault() {
+    // Barva, okolní složka a lesk dřív zapsané v každém .frag
+    return makeMaterial(glm::vec3(0.385f, 0.647f, 0.812f));
+}
+
+bool MaterialTable::initialize() {
+    glGenBuffers(1, &buffer);
+    if (!buffer) return false;
+
+    // Vždy celá velikost bloku - shader deklaruje pole MAX_MATERIALS
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferData(GL_UNIFORM_BUFFER, MAX_MATERIALS * sizeof(Material), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, buffer);
+    upload();
+    return true;
+}
+
+void MaterialTable::upload() {
+    if (!buffer) return;
+    lock_guard<mutex> lock(tableMutex);
+    if (uploadedRevision == revision) return;
+
+    PROFILE_SCOPE("MaterialTable::upload");
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, materials.size() * sizeof(Material), materials.data());
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    uploadedRevision = revision;
+}
+
+unsigned short MaterialTable::add(const string& name, const Material& material) {
+    lock_guard<mutex> lock(tableMutex);
+    for (size_t i = 0; i < names.size(); i++) {
+        if (names[i] == name) {
+            materials[i] = material;
+            revision++;
+            return static_cast<unsigned short>(i);
+        }
+    }
+    if (static_cast<int>(materials.size()) >= MAX_MATERIALS) {
+        printf("Material table full, %s uses the default material\n", name.c_str());
+        return DEFAULT_MATERIAL;
+    }
+    materials.push_back(material);
+    names.push_back(name);
+    revision++;
+    return static_cast<unsigned short>(materials.size() - 1);
+}
+
+int MaterialTable::find(const string& name) const {
+    lock_guard<mutex> lock(tableMutex);
+    for (size_t i = 0; i < names.size(); i++) {
+        if (names[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void MaterialTable::set(unsigned short index, const Material& material) {
+    lock_guard<mutex> lock(tableMutex);
+    if (index >= materials.size()) return;
+    materials[index] = material;
+    revision++;
+}
+
+Material MaterialTable::get(unsigned short index) const {
+    lock_guard<mutex> lock(tableMutex);
+    return index < materials.size() ? materials[index] : materials[DEFAULT_MATERIAL];
+}
+
+vector<Material> MaterialTable::getAll() const {
+    lock_guard<mutex> lock(tableMutex);
+    return materials;
+}
+
+int MaterialTable::getCount() const {
+    lock_guard<mutex> lock(tableMutex);
+    return static_cast<int>(materials.size());
+}
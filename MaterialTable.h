@@ -0,0 +1,57 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <mutex>
+
+using namespace std;
+
+// Materiál objektu na GPU (std140, 48 bajtů)
+struct Material {
+    glm::vec4 diffuse;           // barva objektu
+    glm::vec4 ambient;
+    glm::vec4 specular;          // rgb = barva odlesku, w = shininess
+};
+
+// Tabulka materiálů v uniform bufferu sdílená všemi shadery.
+// Objekt nese jen index (ObjectStorage), který se předává uniformem materialIndex
+// na vykreslení nebo atributem na instanci - objekty s různými materiály tak
+// sdílí jeden program a dají se dávkovat. Index 0 je výchozí materiál
+// (dřívější barva zapsaná v shaderech). Tabulku lze měnit z libovolného vlákna,
+// render vlákno ji nahraje na začátku snímku, pokud se změnila.
+class MaterialTable {
+public:
+    static const int MAX_MATERIALS = 256;        // 12 kB, vejde se do minimálních 16 kB UBO
+    static const GLuint BINDING = 0;             // binding point bloku Materials
+    static const unsigned short DEFAULT_MATERIAL = 0;
+private:
+    vector<Material> materials;
+    vector<string> names;
+    mutable mutex tableMutex;
+    unsigned int revision;
+    unsigned int uploadedRevision;
+    GLuint buffer;
+public:
+    MaterialTable();
+    ~MaterialTable();
+
+    static Material makeMaterial(const glm::vec3& color, float ambient = 0.1f, float specular = 1.0f, float shininess = 32.0f);
+    // Materiál na indexu 0
+    static Material getDefault();
+
+    // Vytvoří buffer a připojí ho na BINDING (vlákno s GL kontextem)
+    bool initialize();
+    // Render vlákno: nahraje tabulku, pokud se od minula změnila
+    void upload();
+
+    // Přidá materiál (nebo přepíše stejnojmenný), vrací index; plná tabulka = DEFAULT_MATERIAL
+    unsigned short add(const string& name, const Material& material);
+    // -1 = neexistuje
+    int find(const string& name) const;
+    void set(unsigned short index, const Material& material);
+    Material get(unsigned short index) const;
+    // Kopie celé tabulky (softwarový rasterizér)
+    vector<Material> getAll() const;
+    int getCount() const;
+};
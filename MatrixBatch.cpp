@@ -0,0 +1,96 @@
+#include "MatrixBatch.h"
+#include "ObjectStorage.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <cmath>
+#include <atomic>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define ZPG_USE_SSE 1
+#endif
+
+MatrixBatch::MatrixBatch() : fastPathCount(0) {}
+
+void MatrixBatch::multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out) {
+#ifdef ZPG_USE_SSE
+    // glm je column-major: sloupec j výsledku = sum_k a[k] * b[j][k]
+    const float* pa = glm::value_ptr(a);
+    const float* pb = glm::value_ptr(b);
+    float* po = glm::value_ptr(out);
+
+    __m128 a0 = _mm_loadu_ps(pa);
+    __m128 a1 = _mm_loadu_ps(pa + 4);
+    __m128 a2 = _mm_loadu_ps(pa + 8);
+    __m128 a3 = _mm_loadu_ps(pa + 12);
+
+    for (int j = 0; j < 4; j++) {
+        __m128 r = _mm_mul_ps(a0, _mm_set1_ps(pb[j * 4 + 0]));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(pb[j * 4 + 1])));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(pb[j * 4 + 2])));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(pb[j * 4 + 3])));
+        _mm_storeu_ps(po + j * 4, r);
+    }
+#else
+    out = a * b;
+#endif
+}
+
+bool MatrixBatch::computeNormalMatrix(const glm::mat4& model, glm::mat3& out) {
+    glm::vec3 c0(model[0]);
+    glm::vec3 c1(model[1]);
+    glm::vec3 c2(model[2]);
+
+    float l0 = glm::dot(c0, c0);
+    float l1 = glm::dot(c1, c1);
+    float l2 = glm::dot(c2, c2);
+    float eps = 1e-4f * l0;
+
+    // Rotace + uniformní škálování: inverse-transpose má stejný směr jako model,
+    // normála se ve fragment shaderu stejně normalizuje
+    if (std::fabs(l0 - l1) < eps && std::fabs(l0 - l2) < eps &&
+        std::fabs(glm::dot(c0, c1)) < eps && std::fabs(glm::dot(c0, c2)) < eps &&
+        std::fabs(glm::dot(c1, c2)) < eps) {
+        out = glm::mat3(c0, c1, c2);
+        return true;
+    }
+
+    // Obecný případ: kofaktorová matice = det * transpose(inverse(M))
+    glm::vec3 x = glm::cross(c1, c2);
+    glm::vec3 y = glm::cross(c2, c0);
+    glm::vec3 z = glm::cross(c0, c1);
+    float sign = glm::dot(c0, x) < 0.0f ? -1.0f : 1.0f;
+    out = glm::mat3(x * sign, y * sign, z * sign);
+    return false;
+}
+
+void MatrixBatch::compute(const ObjectStorage& storage, const glm::mat4& viewProjection, JobSystem* jobs) {
+    PROFILE_SCOPE("MatrixBatch::compute");
+    const vector<glm::mat4>& worldMatrices = storage.getWorldMatrices();
+    results.resize(worldMatrices.size());
+    atomic<int> fastPaths(0);
+
+    // Každý blok zapisuje jen do svých prvků results
+    auto computeRange = [&](size_t begin, size_t end) {
+        int localFastPaths = 0;
+        for (size_t i = begin; i < end; i++) {
+            ObjectMatrices& m = results[i];
+            m.model = worldMatrices[i];
+            multiply(viewProjection, m.model, m.mvp);
+            if (computeNormalMatrix(m.model, m.normal)) {
+                localFastPaths++;
+            }
+        }
+        fastPaths.fetch_add(localFastPaths, memory_order_relaxed);
+    };
+
+    if (jobs) {
+        jobs->parallelFor(worldMatrices.size(), GRAIN, computeRange);
+    }
+    else {
+        computeRange(0, worldMatrices.size());
+    }
+
+    fastPathCount = fastPaths.load();
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+
+using namespace std;
+
+class ObjectStorage;
+class JobSystem;
+
+// Matice jednoho objektu připravené na CPU
+struct ObjectMatrices {
+    glm::mat4 model;
+    glm::mat4 mvp;           // projection * view * model
+    glm::mat3 normal;        // směrově odpovídá transpose(inverse(mat3(model)))
+};
+
+// Dávkový výpočet MVP a normálových matic pro všechny objekty scény.
+// Počítá se jednou za snímek, shader už nic neinvertuje.
+class MatrixBatch {
+private:
+    static const size_t GRAIN = 64;   // objektů na jednu úlohu
+
+    vector<ObjectMatrices> results;
+    int fastPathCount;
+public:
+    MatrixBatch();
+
+    // Čte world matice z ObjectStorage (musí být aktuální - updateWorldMatrices).
+    // S JobSystemem se objekty rozdělí mezi vlákna po blocích GRAIN
+    void compute(const ObjectStorage& storage, const glm::mat4& viewProjection, JobSystem* jobs = nullptr);
+
+    const ObjectMatrices& get(size_t index) const { return results[index]; }
+    size_t size() const { return results.size(); }
+    int getFastPathCount() const { return fastPathCount; }
+
+    // out = a * b (SSE, pokud je k dispozici)
+    static void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out);
+    // Vrací true pro rychlou cestu (uniformní škálování bez inverze)
+    static bool computeNormalMatrix(const glm::mat4& model, glm::mat3& out);
+};
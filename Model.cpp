@@ -1,12 +1,45 @@
 ﻿#include "Model.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "TriangleBVH.h"
 
-Model::Model(float* vertices, int numberOfFloats) {
+unsigned long long Model::currentFrame = 0;
+int Model::reloadCount = 0;
+
+Model::Model(float* vertices, int numberOfFloats, bool copyVertices)
+    : VAO(0), VBO(0), source(vertices), numberOfFloats(numberOfFloats), resident(false), lastUsedFrame(currentFrame), bvh(nullptr) {
+    PROFILE_SCOPE("Model::Model");
     numberOfVertices = numberOfFloats / 6; // 3 pozice, 3 barvy
 
+    if (copyVertices) {
+        ownedSource.assign(vertices, vertices + numberOfFloats);
+        source = ownedSource.data();
+    }
+
+    // Obalová koule pro ořez: střed AABB, poloměr k nejvzdálenějšímu vrcholu
+    glm::vec3 minimum(0.0f), maximum(0.0f);
+    for (int i = 0; i < numberOfVertices; i++) {
+        glm::vec3 p(source[i * 6], source[i * 6 + 1], source[i * 6 + 2]);
+        minimum = i == 0 ? p : glm::min(minimum, p);
+        maximum = i == 0 ? p : glm::max(maximum, p);
+    }
+    glm::vec3 center = (minimum + maximum) * 0.5f;
+    float radius = 0.0f;
+    for (int i = 0; i < numberOfVertices; i++) {
+        glm::vec3 p(source[i * 6], source[i * 6 + 1], source[i * 6 + 2]);
+        radius = glm::max(radius, glm::length(p - center));
+    }
+    bounds = glm::vec4(center, radius);
+
+    upload();
+}
+
+void Model::upload() {
     // VBO
     glGenBuffers(1, &VBO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, numberOfFloats * sizeof(float), vertices, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, numberOfFloats * sizeof(float), source, GL_STATIC_DRAW);
+    RenderStats::bufferUpload(numberOfFloats * sizeof(float));
 
     // VAO
     glGenVertexArrays(1, &VAO);
@@ -23,15 +56,53 @@ Model::Model(float* vertices, int numberOfFloats) {
     // Pracuje se s tím tady
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    resident = true;
 }
 
 Model::~Model() {
+    unload();
+    if (bvh) delete bvh;
+}
+
+const TriangleBVH& Model::getBVH() {
+    // Zdrojová data zůstávají v RAM (kvůli znovunahrání), stačí postavit nad nimi
+    if (!bvh) {
+        bvh = new TriangleBVH(source, numberOfVertices, 6);
+    }
+    return *bvh;
+}
+
+void Model::unload() {
+    if (!resident) return;
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
+    VAO = 0;
+    VBO = 0;
+    resident = false;
+}
+
+GLuint Model::getVAO() {
+    if (!resident) {
+        PROFILE_SCOPE("Model::reload");
+        upload();
+        reloadCount++;
+    }
+    lastUsedFrame = currentFrame;
+    return VAO;
 }
 
 void Model::draw() {
-    glBindVertexArray(VAO);
+    glBindVertexArray(getVAO());
     glDrawArrays(GL_TRIANGLES, 0, numberOfVertices);
+    RenderStats::vaoBind();
+    RenderStats::drawCall(numberOfVertices);
+    glBindVertexArray(0);
+}
+
+void Model::drawInstanced(int instances) {
+    glBindVertexArray(getVAO());
+    glDrawArraysInstanced(GL_TRIANGLES, 0, numberOfVertices, instances);
+    RenderStats::vaoBind();
+    RenderStats::drawCall(numberOfVertices * instances);
     glBindVertexArray(0);
 }
\ No newline at end of file
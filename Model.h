@@ -1,16 +1,54 @@
 ﻿#pragma once
 #include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+class TriangleBVH;
 
 class Model {
 private:
     GLuint VAO;
     GLuint VBO;
     int numberOfVertices;
+    glm::vec4 bounds;        // obalová koule v prostoru modelu (střed, poloměr)
+
+    // Zdroj dat pro znovunahrání po vyhození z VRAM
+    const float* source;
+    vector<float> ownedSource;
+    int numberOfFloats;
+    bool resident;
+    unsigned long long lastUsedFrame;
+    TriangleBVH* bvh;        // pro výběr myší, staví se při prvním použití
+
+    static unsigned long long currentFrame;
+    static int reloadCount;
+
+    void upload();
 public:
-    Model(float* vertices, int numberOfFloats); // Vytvoří model
+    // copyVertices = false jen pro data, která žijí po celou dobu běhu (statická pole)
+    Model(float* vertices, int numberOfFloats, bool copyVertices = true); // Vytvoří model
     ~Model();
 
     void draw();          // Vykreslí model
-    GLuint getVAO() const { return VAO; } // pokud bude potřeba VAO externě
+    void drawInstanced(int instances);
+    GLuint getVAO();      // Nahraje model, pokud byl vyhozen, a označí ho jako použitý
     int getNumberOfVertices() const { return numberOfVertices; }
+    // Data v RAM (6 floatů na vrchol: pozice, atribut) pro softwarový rasterizér
+    const float* getVertexData() const { return source; }
+    const glm::vec4& getBoundingSphere() const { return bounds; }
+    // BVH trojúhelníků v prostoru modelu (jen hlavní vlákno)
+    const TriangleBVH& getBVH();
+
+    // Správa VRAM (jen vlákno s GL kontextem)
+    bool isResident() const { return resident; }
+    void unload();
+    size_t getGpuBytes() const { return static_cast<size_t>(numberOfFloats) * sizeof(float); }
+    unsigned long long getLastUsedFrame() const { return lastUsedFrame; }
+
+    static void advanceFrame() { currentFrame++; }
+    static unsigned long long getCurrentFrame() { return currentFrame; }
+    static int getReloadCount() { return reloadCount; }
 };
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "MultiView.h"
+#include "Camera.h"
+#include "ShaderProgram.h"
+#include "ShadowMap.h"
+#include "DrawableObject.h"
+#include "Model.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+
+void Frustum::fromMatrix(const glm::mat4& m) {
+    // Gribb-Hartmann: roviny z řádků matice (glm je po sloupcích)
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    planes[0] = row3 + row0;     // levá
+    planes[1] = row3 - row0;     // pravá
+    planes[2] = row3 + row1;     // dolní
+    planes[3] = row3 - row1;     // horní
+    planes[4] = row3 + row2;     // blízká
+    planes[5] = row3 - row2;     // vzdálená
+
+    for (int i = 0; i < 6; i++) {
+        planes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+    }
+}
+
+bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const {
+    for (int i = 0; i < 6; i++) {
+        if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius) return false;
+    }
+    return true;
+}
+
+MultiView::MultiView() : enabled(false), lastViewCount(0), instancedDraws(0), fallbackDraws(0) {
+}
+
+void MultiView::addCameraView(Camera* camera, const glm::vec4& rect) {
+    View view = { camera, glm::vec3(0.0f), glm::vec3(0.0f), rect };
+    views.push_back(view);
+}
+
+void MultiView::addFixedView(const glm::vec3& eye, const glm::vec3& center, const glm::vec4& rect) {
+    View view = { nullptr, eye, center, rect };
+    views.push_back(view);
+}
+
+void MultiView::registerVariant(ShaderProgram* shader, ShaderProgram* multiViewShader) {
+    variants[shader] = multiViewShader;
+    ProgramState state;
+    state.viewProjections = glGetUniformLocation(multiViewShader->getProgram(), "viewProjections");
+    state.viewRects = glGetUniformLocation(multiViewShader->getProgram(), "viewRects");
+    programStates[multiViewShader] = state;
+}
+
+void MultiView::prepare(RenderSnapshot& snapshot) {
+    PROFILE_SCOPE("MultiView::prepare");
+    int viewCount = min(static_cast<int>(views.size()), static_cast<int>(RenderSnapshot::MAX_VIEWS));
+    snapshot.viewCount = viewCount;
+
+    // Matice pohledů a obálka všech frust (AABB rohů ve světových souřadnicích)
+    Frustum frusta[RenderSnapshot::MAX_VIEWS];
+    glm::vec3 unionMin(0.0f), unionMax(0.0f);
+    for (int v = 0; v < viewCount; v++) {
+        const View& view = views[v];
+        float width = view.rect.z * snapshot.viewportWidth;
+        float height = view.rect.w * snapshot.viewportHeight;
+        float aspect = height > 0.0f ? width / height : 1.0f;
+        glm::mat4 projection;
+        glm::mat4 viewMatrix;
+        if (view.camera) {
+            // Projekce kamery (zorné pole, roviny ořezu), jen poměr stran podle obdélníku pohledu
+            projection = view.camera->getProjectionMatrix();
+            projection[0][0] = projection[1][1] / aspect;
+            viewMatrix = view.camera->getViewMatrix();
+        }
+        else {
+            projection = glm::perspective(glm::radians(60.0f), aspect, 0.1f, 100.0f);
+            viewMatrix = glm::lookAt(view.eye, view.center, glm::vec3(0.0f, 1.0f, 0.0f));
+        }
+
+        snapshot.viewProjections[v] = projection * viewMatrix;
+        snapshot.viewRects[v] = view.rect;
+        frusta[v].fromMatrix(snapshot.viewProjections[v]);
+
+        glm::mat4 inverse = glm::inverse(snapshot.viewProjections[v]);
+        for (int corner = 0; corner < 8; corner++) {
+            glm::vec4 ndc((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f, 1.0f);
+            glm::vec4 world = inverse * ndc;
+            glm::vec3 p = glm::vec3(world) / world.w;
+            unionMin = (v == 0 && corner == 0) ? p : glm::min(unionMin, p);
+            unionMax = (v == 0 && corner == 0) ? p : glm::max(unionMax, p);
+        }
+    }
+
+    // Jeden test proti obálce, zpřesnění na masku jen pro objekty uvnitř
+    int culled = 0;
+    unsigned int allViews = (1u << viewCount) - 1;
+    for (auto& item : snapshot.items) {
+        if (!item.model) {
+            item.viewMask = allViews;
+            continue;
+        }
+        const glm::vec4& bounds = item.model->getBoundingSphere();
+        const glm::mat4& model = item.matrices.model;
+        glm::vec3 center = glm::vec3(model * glm::vec4(glm::vec3(bounds), 1.0f));
+        float scale = max(glm::length(glm::vec3(model[0])), max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        float radius = bounds.w * scale;
+
+        glm::vec3 closest = glm::clamp(center, unionMin, unionMax);
+        glm::vec3 d = closest - center;
+        unsigned int mask = 0;
+        if (glm::dot(d, d) <= radius * radius) {
+            for (int v = 0; v < viewCount; v++) {
+                if (frusta[v].intersectsSphere(center, radius)) mask |= 1u << v;
+            }
+        }
+        item.viewMask = mask;
+        if (mask == 0) culled++;
+    }
+    // Ořezané položky zůstávají ve snímku kvůli stínové mapě
+    snapshot.objectsCulled = culled;
+}
+
+void MultiView::applyViewUniforms(const RenderSnapshot& snapshot, ShaderProgram* shader) {
+    // Pole pohledů stačí nahrát jednou za snímek pro každý program
+    if (find(framePrograms.begin(), framePrograms.end(), shader) != framePrograms.end()) return;
+    framePrograms.push_back(shader);
+
+    // Obdélník pohledu -> měřítko a posun v NDC
+    glm::vec4 ndcRects[RenderSnapshot::MAX_VIEWS];
+    for (int v = 0; v < snapshot.viewCount; v++) {
+        const glm::vec4& r = snapshot.viewRects[v];
+        ndcRects[v] = glm::vec4(r.z, r.w, 2.0f * r.x + r.z - 1.0f, 2.0f * r.y + r.w - 1.0f);
+    }
+
+    const ProgramState& state = programStates[shader];
+    glUniformMatrix4fv(state.viewProjections, snapshot.viewCount, GL_FALSE, glm::value_ptr(snapshot.viewProjections[0]));
+    glUniform4fv(state.viewRects, snapshot.viewCount, glm::value_ptr(ndcRects[0]));
+    RenderStats::uniformUpload(2);
+}
+
+void MultiView::render(const RenderSnapshot& snapshot, ShadowMap* shadowMap) {
+    PROFILE_SCOPE("MultiView::render");
+    framePrograms.clear();
+    fallbackItems.clear();
+    lastViewCount = snapshot.viewCount;
+    instancedDraws = 0;
+    fallbackDraws = 0;
+
+    // Jeden průchod přes celé okno, pohledy odděluje ořez v multiview.vert
+    glEnable(GL_CLIP_DISTANCE0);
+    glEnable(GL_CLIP_DISTANCE1);
+    glEnable(GL_CLIP_DISTANCE2);
+    glEnable(GL_CLIP_DISTANCE3);
+
+    for (const auto& item : snapshot.items) {
+        if (!item.shader || !item.model || item.viewMask == 0) continue;
+
+        auto variant = variants.find(item.shader);
+        if (variant == variants.end()) {
+            fallbackItems.push_back(&item);
+            continue;
+        }
+
+        ShaderProgram* shader = variant->second;
+        shader->use(shader->getProgram());
+        applyViewUniforms(snapshot, shader);
+
+        // Spekulár počítá s pozicí hlavní kamery ve všech pohledech
+        if (shader->hasUniform("lightPosition")) {
+            shader->SetUniform("lightPosition", snapshot.lightPosition);
+        }
+        if (shader->hasUniform("cameraPosition")) {
+            shader->SetUniform("cameraPosition", snapshot.cameraPosition);
+        }
+        if (shadowMap) {
+            shadowMap->applyUniforms(shader);
+        }
+        // Linker vyřadí uniformy, které varianta nečte (konstantní shader normálu ani modelMatrix)
+        if (shader->hasUniform("modelMatrix")) {
+            shader->SetUniform("modelMatrix", item.matrices.model);
+        }
+        if (shader->hasUniform("normalMatrix")) {
+            shader->SetUniform("normalMatrix", item.matrices.normal);
+        }
+        if (shader->hasUniform("viewMask")) {
+            shader->SetUniform("viewMask", static_cast<int>(item.viewMask));
+        }
+        if (shader->hasUniform("materialIndex")) {
+            shader->SetUniform("materialIndex", static_cast<int>(item.material));
+        }
+
+        item.model->drawInstanced(snapshot.viewCount);
+        instancedDraws++;
+    }
+
+    glDisable(GL_CLIP_DISTANCE0);
+    glDisable(GL_CLIP_DISTANCE1);
+    glDisable(GL_CLIP_DISTANCE2);
+    glDisable(GL_CLIP_DISTANCE3);
+
+    if (!fallbackItems.empty()) {
+        renderFallback(snapshot, shadowMap);
+    }
+    glViewport(0, 0, snapshot.viewportWidth, snapshot.viewportHeight);
+}
+
+void MultiView::renderFallback(const RenderSnapshot& snapshot, ShadowMap* shadowMap) {
+    // Shadery bez multi-view varianty: každý pohled zvlášť s vlastním viewportem
+    for (int v = 0; v < snapshot.viewCount; v++) {
+        const glm::vec4& r = snapshot.viewRects[v];
+        glViewport(static_cast<GLint>(r.x * snapshot.viewportWidth), static_cast<GLint>(r.y * snapshot.viewportHeight),
+            static_cast<GLsizei>(r.z * snapshot.viewportWidth), static_cast<GLsizei>(r.w * snapshot.viewportHeight));
+
+        for (const RenderItem* item : fallbackItems) {
+            if ((item->viewMask & (1u << v)) == 0) continue;
+
+            ShaderProgram* shader = item->shader;
+            shader->use(shader->getProgram());
+            if (shader->hasUniform("lightPosition")) {
+                shader->SetUniform("lightPosition", snapshot.lightPosition);
+            }
+            if (shader->hasUniform("cameraPosition")) {
+                shader->SetUniform("cameraPosition", snapshot.cameraPosition);
+            }
+            if (shadowMap) {
+                shadowMap->applyUniforms(shader);
+            }
+
+            ObjectMatrices matrices = item->matrices;
+            matrices.mvp = snapshot.viewProjections[v] * matrices.model;
+            DrawableObject::draw(item->model, shader, matrices, item->material);
+            fallbackDraws++;
+        }
+    }
+}
+
+void MultiView::printStats() const {
+    printf("Multi-view: %d views, %d instanced draws, %d fallback draws\n",
+        lastViewCount, instancedDraws, fallbackDraws);
+}
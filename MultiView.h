@@ -0,0 +1,81 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <map>
+#include "RenderSnapshot.h"
+
+using namespace std;
+
+class Camera;
+class ShaderProgram;
+class ShadowMap;
+
+// Frustum jako 6 rovin (normála dovnitř, w = vzdálenost)
+struct Frustum {
+    glm::vec4 planes[6];
+
+    void fromMatrix(const glm::mat4& viewProjection);
+    bool intersectsSphere(const glm::vec3& center, float radius) const;
+};
+
+// Více pohledů na stejnou scénu (split-screen monitoring, zrcadlení).
+// Viditelnost se počítá jednou proti obálce všech frust a zpřesní se
+// na masku pohledů. Objekty se shaderem s multi-view variantou se kreslí
+// jedním instancovaným voláním do všech pohledů (instance = pohled),
+// ostatní postaru po jednotlivých viewportech.
+class MultiView {
+private:
+    struct View {
+        Camera* camera;          // nullptr = pevný pohled
+        glm::vec3 eye;
+        glm::vec3 center;
+        glm::vec4 rect;          // x, y (zdola), šířka, výška v poměru k oknu
+    };
+
+    // Lokace polí pohledů (SetUniform pole neumí)
+    struct ProgramState {
+        GLint viewProjections;
+        GLint viewRects;
+    };
+
+    vector<View> views;
+    bool enabled;
+    map<ShaderProgram*, ShaderProgram*> variants;     // běžný shader -> multi-view varianta
+    map<ShaderProgram*, ProgramState> programStates;
+
+    // Render vlákno: programy s nahranými poli v tomto snímku, položky bez varianty
+    vector<ShaderProgram*> framePrograms;
+    vector<const RenderItem*> fallbackItems;
+
+    // Statistiky posledního snímku (render vlákno)
+    int lastViewCount;
+    int instancedDraws;
+    int fallbackDraws;
+
+    void applyViewUniforms(const RenderSnapshot& snapshot, ShaderProgram* shader);
+    void renderFallback(const RenderSnapshot& snapshot, ShadowMap* shadowMap);
+public:
+    MultiView();
+
+    // Pohled sleduje kameru (zrcadlení hlavního pohledu do dalšího displeje)
+    void addCameraView(Camera* camera, const glm::vec4& rect);
+    // Pevný monitorovací pohled
+    void addFixedView(const glm::vec3& eye, const glm::vec3& center, const glm::vec4& rect);
+    void clearViews() { views.clear(); }
+    int getViewCount() const { return static_cast<int>(views.size()); }
+
+    void setEnabled(bool e) { enabled = e; }
+    bool isEnabled() const { return enabled && views.size() > 1; }
+
+    // Shader kreslený jedním průchodem (vertex shader multiview.vert)
+    void registerVariant(ShaderProgram* shader, ShaderProgram* multiViewShader);
+
+    // Hlavní vlákno: matice pohledů do snímku a maska viditelnosti položek
+    void prepare(RenderSnapshot& snapshot);
+    // Render vlákno: všechny pohledy
+    void render(const RenderSnapshot& snapshot, ShadowMap* shadowMap);
+
+    // Render vlákno
+    void printStats() const;
+};
@@ -0,0 +1,325 @@
+#include "ObjectStorage.h"
+#include "CompositeTransform.h"
+#include "JobSystem.h"
+#include "Scene.h"
+#include "ResourceManager.h"
+#include "Profiler.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <unordered_map>
+#include <stdio.h>
+
+ObjectStorage::ObjectStorage(Scene* owner) : owner(owner), resources(nullptr), dirtyCount(0) {}
+
+// Počty objektů na model a shader - reference se předávají po skupinách, ne po objektech
+template<typename T>
+static unordered_map<const T*, int> countReferences(const T* const* begin, const T* const* end) {
+    unordered_map<const T*, int> counts;
+    for (const T* const* it = begin; it != end; ++it) {
+        if (*it) counts[*it]++;
+    }
+    return counts;
+}
+
+ObjectStorage::~ObjectStorage() {
+    if (!resources) return;
+    for (const auto& entry : countReferences<Model>(models.data(), models.data() + models.size())) {
+        resources->release(entry.first, entry.second);
+    }
+    for (const auto& entry : countReferences<ShaderProgram>(shaders.data(), shaders.data() + shaders.size())) {
+        resources->release(entry.first, entry.second);
+    }
+}
+
+void ObjectStorage::setResourceManager(ResourceManager* manager) {
+    if (resources == manager) return;
+    if (resources) {
+        // Úložiště patří jen jedné scéně v jednom správci
+        printf("Warning: object storage already holds references of another resource manager\n");
+        return;
+    }
+    resources = manager;
+    for (const auto& entry : countReferences<Model>(models.data(), models.data() + models.size())) {
+        resources->addRef(entry.first, entry.second);
+    }
+    for (const auto& entry : countReferences<ShaderProgram>(shaders.data(), shaders.data() + shaders.size())) {
+        resources->addRef(entry.first, entry.second);
+    }
+}
+
+void ObjectStorage::addRefs(const Model* model, const ShaderProgram* shader) {
+    if (!resources) return;
+    if (model) resources->addRef(model);
+    if (shader) resources->addRef(shader);
+}
+
+void ObjectStorage::releaseRefs(const Model* model, const ShaderProgram* shader) {
+    if (!resources) return;
+    if (model) resources->release(model);
+    if (shader) resources->release(shader);
+}
+
+ObjectStorage& ObjectStorage::detached() {
+    static ObjectStorage storage;
+    return storage;
+}
+
+ObjectHandle ObjectStorage::create(DrawableObject* object, Model* model, ShaderProgram* shader, CompositeTransform* transform) {
+    unsigned int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        slot = static_cast<unsigned int>(slots.size());
+        Slot s;
+        s.generation = 0;
+        slots.push_back(s);
+    }
+
+    unsigned int index = static_cast<unsigned int>(objects.size());
+    slots[slot].index = index;
+
+    slotOf.push_back(slot);
+    objects.push_back(object);
+    models.push_back(model);
+    shaders.push_back(shader);
+    materials.push_back(0);
+    transforms.push_back(transform);
+    translations.push_back(glm::vec3(0.0f));
+    rotationAxes.push_back(glm::vec3(0.0f, 1.0f, 0.0f));
+    rotationAngles.push_back(0.0f);
+    scales.push_back(glm::vec3(1.0f));
+    worldMatrices.push_back(glm::mat4(1.0f));
+    flags.push_back(FLAG_STATIC | FLAG_CASTS_SHADOW | FLAG_DIRTY);
+    revisions.push_back(0);
+    dirtyCount++;
+    addRefs(model, shader);
+
+    return ObjectHandle(slot, slots[slot].generation);
+}
+
+ObjectHandle ObjectStorage::moveTo(ObjectHandle handle, ObjectStorage& target) {
+    unsigned int i = indexOf(handle);
+    ObjectHandle moved = target.create(objects[i], models[i], shaders[i], transforms[i]);
+
+    unsigned int j = target.indexOf(moved);
+    target.translations[j] = translations[i];
+    target.rotationAxes[j] = rotationAxes[i];
+    target.rotationAngles[j] = rotationAngles[i];
+    target.scales[j] = scales[i];
+    target.materials[j] = materials[i];
+    target.flags[j] = flags[i] | FLAG_DIRTY;
+    target.revisions[j] = revisions[i];
+
+    destroy(handle);
+    return moved;
+}
+
+void ObjectStorage::destroy(ObjectHandle handle) {
+    if (!isValid(handle)) return;
+
+    unsigned int index = slots[handle.slot].index;
+    unsigned int last = static_cast<unsigned int>(objects.size() - 1);
+    if (flags[index] & FLAG_DIRTY) dirtyCount--;
+    Model* model = models[index];
+    ShaderProgram* shader = shaders[index];
+
+    // Poslední objekt se přesune na uvolněné místo
+    if (index != last) {
+        slotOf[index] = slotOf[last];
+        objects[index] = objects[last];
+        models[index] = models[last];
+        shaders[index] = shaders[last];
+        materials[index] = materials[last];
+        transforms[index] = transforms[last];
+        translations[index] = translations[last];
+        rotationAxes[index] = rotationAxes[last];
+        rotationAngles[index] = rotationAngles[last];
+        scales[index] = scales[last];
+        worldMatrices[index] = worldMatrices[last];
+        flags[index] = flags[last];
+        revisions[index] = revisions[last];
+        slots[slotOf[index]].index = index;
+    }
+
+    slotOf.pop_back();
+    objects.pop_back();
+    models.pop_back();
+    shaders.pop_back();
+    materials.pop_back();
+    transforms.pop_back();
+    translations.pop_back();
+    rotationAxes.pop_back();
+    rotationAngles.pop_back();
+    scales.pop_back();
+    worldMatrices.pop_back();
+    flags.pop_back();
+    revisions.pop_back();
+
+    slots[handle.slot].generation++;
+    freeSlots.push_back(handle.slot);
+
+    // Až nakonec - poslední reference může prostředek smazat
+    releaseRefs(model, shader);
+}
+
+void ObjectStorage::reserve(size_t count) {
+    slotOf.reserve(count);
+    objects.reserve(count);
+    models.reserve(count);
+    shaders.reserve(count);
+    materials.reserve(count);
+    transforms.reserve(count);
+    translations.reserve(count);
+    rotationAxes.reserve(count);
+    rotationAngles.reserve(count);
+    scales.reserve(count);
+    worldMatrices.reserve(count);
+    flags.reserve(count);
+    revisions.reserve(count);
+    slots.reserve(count);
+}
+
+void ObjectStorage::appendBlock(size_t count, const unsigned short* modelIndices, Model* const* modelTable,
+    const unsigned short* shaderIndices, ShaderProgram* const* shaderTable,
+    const glm::vec3* translationData, const glm::vec3* axisData, const float* angleData,
+    const glm::vec3* scaleData, const unsigned char* flagData, const unsigned short* materialData) {
+    PROFILE_SCOPE("ObjectStorage::appendBlock");
+    size_t first = objects.size();
+    reserve(first + count);
+
+    // TRS pole mají v souboru stejné rozložení - kopie vcelku
+    translations.insert(translations.end(), translationData, translationData + count);
+    rotationAxes.insert(rotationAxes.end(), axisData, axisData + count);
+    rotationAngles.insert(rotationAngles.end(), angleData, angleData + count);
+    scales.insert(scales.end(), scaleData, scaleData + count);
+    flags.insert(flags.end(), flagData, flagData + count);
+    if (materialData) materials.insert(materials.end(), materialData, materialData + count);
+    else materials.resize(first + count, 0);
+
+    objects.resize(first + count, nullptr);
+    transforms.resize(first + count, nullptr);
+    worldMatrices.resize(first + count, glm::mat4(1.0f));
+    revisions.resize(first + count, 0);
+    models.resize(first + count);
+    shaders.resize(first + count);
+    slotOf.resize(first + count);
+
+    for (size_t i = 0; i < count; i++) {
+        size_t index = first + i;
+        models[index] = modelIndices[i] == 0xFFFF ? nullptr : modelTable[modelIndices[i]];
+        shaders[index] = shaderIndices[i] == 0xFFFF ? nullptr : shaderTable[shaderIndices[i]];
+        flags[index] |= FLAG_DIRTY;
+
+        // Uvolněné sloty se použijí znovu (streamování přidává a maže průběžně)
+        unsigned int slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            slot = static_cast<unsigned int>(slots.size());
+            Slot s;
+            s.generation = 0;
+            slots.push_back(s);
+        }
+        slots[slot].index = static_cast<unsigned int>(index);
+        slotOf[index] = slot;
+    }
+    dirtyCount += count;
+
+    if (resources) {
+        const Model* const* newModels = models.data() + first;
+        const ShaderProgram* const* newShaders = shaders.data() + first;
+        for (const auto& entry : countReferences<Model>(newModels, newModels + count)) {
+            resources->addRef(entry.first, entry.second);
+        }
+        for (const auto& entry : countReferences<ShaderProgram>(newShaders, newShaders + count)) {
+            resources->addRef(entry.first, entry.second);
+        }
+    }
+}
+
+glm::mat4 ObjectStorage::computeLocalMatrix(unsigned int index) const {
+    if (transforms[index]) {
+        return transforms[index]->getMatrix();
+    }
+
+    // T * R * S jako Transform(Translation, Rotation, Scale), bez násobení matic
+    glm::mat4 m = glm::rotate(glm::mat4(1.0f), rotationAngles[index], rotationAxes[index]);
+    const glm::vec3& s = scales[index];
+    m[0] *= s.x;
+    m[1] *= s.y;
+    m[2] *= s.z;
+    m[3] = glm::vec4(translations[index], 1.0f);
+    return m;
+}
+
+void ObjectStorage::updateWorldMatrices(JobSystem* jobs) {
+    if (dirtyCount == 0) return;
+    PROFILE_SCOPE("ObjectStorage::updateWorldMatrices");
+
+    auto updateRange = [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (flags[i] & FLAG_DIRTY) {
+                worldMatrices[i] = computeLocalMatrix(static_cast<unsigned int>(i));
+                flags[i] &= ~FLAG_DIRTY;
+            }
+        }
+    };
+
+    if (jobs) {
+        jobs->parallelFor(objects.size(), GRAIN, updateRange);
+    }
+    else {
+        updateRange(0, objects.size());
+    }
+    dirtyCount = 0;
+}
+
+void ObjectStorage::markDirty(unsigned int index) {
+    if (!(flags[index] & FLAG_DIRTY)) {
+        flags[index] |= FLAG_DIRTY;
+        dirtyCount++;
+    }
+}
+
+void ObjectStorage::notifyChanged(unsigned int index, bool transformChanged) {
+    if (transformChanged) {
+        revisions[index]++;
+        markDirty(index);
+    }
+    if (owner) owner->notifyObjectChanged();
+}
+
+void ObjectStorage::setModel(unsigned int index, Model* model) {
+    Model* previous = models[index];
+    models[index] = model;
+    addRefs(model, nullptr);
+    releaseRefs(previous, nullptr);
+}
+
+void ObjectStorage::setShader(unsigned int index, ShaderProgram* shader) {
+    ShaderProgram* previous = shaders[index];
+    shaders[index] = shader;
+    addRefs(nullptr, shader);
+    releaseRefs(nullptr, previous);
+}
+
+void ObjectStorage::setTransform(unsigned int index, CompositeTransform* transform) {
+    transforms[index] = transform;
+    notifyChanged(index, true);
+}
+
+void ObjectStorage::setLocalTransform(unsigned int index, const glm::vec3& translation, float angle, const glm::vec3& axis, const glm::vec3& scale) {
+    translations[index] = translation;
+    rotationAngles[index] = angle;
+    rotationAxes[index] = axis;
+    scales[index] = scale;
+    notifyChanged(index, true);
+}
+
+void ObjectStorage::setFlag(unsigned int index, Flags flag, bool value) {
+    if (value) flags[index] |= flag;
+    else flags[index] &= ~flag;
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+
+using namespace std;
+
+class DrawableObject;
+class Model;
+class ShaderProgram;
+class CompositeTransform;
+class Scene;
+class JobSystem;
+class ResourceManager;
+
+// Stabilní odkaz na objekt v ObjectStorage. Po smazání objektu se generace
+// slotu zvýší, takže starý handle je rozpoznatelně neplatný.
+struct ObjectHandle {
+    unsigned int slot;
+    unsigned int generation;
+
+    ObjectHandle() : slot(0xFFFFFFFFu), generation(0) {}
+    ObjectHandle(unsigned int s, unsigned int g) : slot(s), generation(g) {}
+};
+
+// Data objektů scény v hustých polích (SoA). Index v polích je pořadí objektu
+// ve scéně a při mazání se na uvolněné místo přesune poslední objekt.
+// DrawableObject je jen fasáda nad handle. Objekty přidané blokově
+// (appendBlock, binární scéna) fasádu nemají - getObject() vrací nullptr.
+// Úložiště scény v ResourceManageru drží za každý objekt referenci na jeho
+// model a shader, takže uvolnění prostředku nenechá ve scéně visící ukazatel.
+class ObjectStorage {
+public:
+    enum Flags {
+        FLAG_STATIC = 1,
+        FLAG_CASTS_SHADOW = 2,
+        FLAG_DIRTY = 4           // world matice se musí přepočítat
+    };
+private:
+    struct Slot {
+        unsigned int index;      // pozice v hustých polích
+        unsigned int generation;
+    };
+
+    static const size_t GRAIN = 256;  // objektů na úlohu při přepočtu matic
+
+    Scene* owner;                // scéna, které se hlásí změny (nullptr = bez scény)
+    ResourceManager* resources;  // komu patří reference na modely a shadery (nullptr = nedrží)
+    vector<Slot> slots;
+    vector<unsigned int> freeSlots;
+    size_t dirtyCount;
+
+    // Husté pole
+    vector<unsigned int> slotOf;
+    vector<DrawableObject*> objects;
+    vector<Model*> models;
+    vector<ShaderProgram*> shaders;
+    vector<unsigned short> materials;         // index do MaterialTable
+    vector<CompositeTransform*> transforms;   // kompozitní transformace, nullptr = lokální TRS
+    vector<glm::vec3> translations;
+    vector<glm::vec3> rotationAxes;
+    vector<float> rotationAngles;
+    vector<glm::vec3> scales;
+    vector<glm::mat4> worldMatrices;
+    vector<unsigned char> flags;
+    vector<unsigned int> revisions;
+
+    void markDirty(unsigned int index);
+    void addRefs(const Model* model, const ShaderProgram* shader);
+    void releaseRefs(const Model* model, const ShaderProgram* shader);
+public:
+    ObjectStorage(Scene* owner = nullptr);
+    ~ObjectStorage();
+    ObjectStorage(const ObjectStorage&) = delete;
+    ObjectStorage& operator=(const ObjectStorage&) = delete;
+
+    // Od teď drží reference (ResourceManager::addScene) - i na už přidané objekty
+    void setResourceManager(ResourceManager* manager);
+
+    // Objekty vytvořené mimo scénu žijí tady do Scene::addObject
+    static ObjectStorage& detached();
+
+    ObjectHandle create(DrawableObject* object, Model* model, ShaderProgram* shader, CompositeTransform* transform);
+    // Přesune objekt (včetně stavu) do jiného úložiště, vrací nový handle
+    ObjectHandle moveTo(ObjectHandle handle, ObjectStorage& target);
+    void destroy(ObjectHandle handle);
+    void reserve(size_t count);
+    // Přidá count objektů bez fasád najednou - pole se kopírují vcelku, žádná alokace na objekt.
+    // Model a shader se berou z tabulek podle indexu (0xFFFF = žádný), materiály nullptr = výchozí.
+    void appendBlock(size_t count, const unsigned short* modelIndices, Model* const* modelTable,
+        const unsigned short* shaderIndices, ShaderProgram* const* shaderTable,
+        const glm::vec3* translations, const glm::vec3* rotationAxes, const float* rotationAngles,
+        const glm::vec3* scales, const unsigned char* flags, const unsigned short* materialIndices = nullptr);
+
+    bool isValid(ObjectHandle handle) const {
+        return handle.slot < slots.size() && slots[handle.slot].generation == handle.generation;
+    }
+    unsigned int indexOf(ObjectHandle handle) const { return slots[handle.slot].index; }
+    // Handle objektu na indexu (i pro objekty z appendBlock)
+    ObjectHandle handleAt(unsigned int index) const { return ObjectHandle(slotOf[index], slots[slotOf[index]].generation); }
+    size_t size() const { return objects.size(); }
+
+    // Přepočítá world matice změněných objektů (s JobSystemem paralelně)
+    void updateWorldMatrices(JobSystem* jobs = nullptr);
+    glm::mat4 computeLocalMatrix(unsigned int index) const;
+
+    // Změna objektu - zvýší revizi a ohlásí ji scéně
+    void notifyChanged(unsigned int index, bool transformChanged);
+
+    // Přístup podle indexu
+    DrawableObject* getObject(unsigned int index) const { return objects[index]; }
+    Model* getModel(unsigned int index) const { return models[index]; }
+    ShaderProgram* getShader(unsigned int index) const { return shaders[index]; }
+    unsigned short getMaterial(unsigned int index) const { return materials[index]; }
+    CompositeTransform* getTransform(unsigned int index) const { return transforms[index]; }
+    unsigned int getRevision(unsigned int index) const { return revisions[index]; }
+    bool hasFlag(unsigned int index, Flags flag) const { return (flags[index] & flag) != 0; }
+
+    void setModel(unsigned int index, Model* model);
+    void setShader(unsigned int index, ShaderProgram* shader);
+    void setMaterial(unsigned int index, unsigned short material) { materials[index] = material; }
+    void setTransform(unsigned int index, CompositeTransform* transform);
+    void setLocalTransform(unsigned int index, const glm::vec3& translation, float angle, const glm::vec3& axis, const glm::vec3& scale);
+    void setFlag(unsigned int index, Flags flag, bool value);
+
+    // Celá pole pro dávkové zpracování
+    const vector<DrawableObject*>& getObjects() const { return objects; }
+    const vector<glm::mat4>& getWorldMatrices() const { return worldMatrices; }
+    const vector<Model*>& getModels() const { return models; }
+    const vector<ShaderProgram*>& getShaders() const { return shaders; }
+    const vector<unsigned short>& getMaterials() const { return materials; }
+    const vector<unsigned char>& getFlags() const { return flags; }
+    const vector<unsigned int>& getRevisions() const { return revisions; }
+    const vector<CompositeTransform*>& getTransforms() const { return transforms; }
+    const vector<glm::vec3>& getTranslations() const { return translations; }
+    const vector<glm::vec3>& getRotationAxes() const { return rotationAxes; }
+    const vector<float>& getRotationAngles() const { return rotationAngles; }
+    const vector<glm::vec3>& getScales() const { return scales; }
+};
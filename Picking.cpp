@@ -0,0 +1,89 @@
+#include "Picking.h"
+#include "Scene.h"
+#include "Model.h"
+#include "TriangleBVH.h"
+#include "FramePipeline.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+    struct Candidate {
+        unsigned int index;
+        float entry;             // vstup do obalové koule
+    };
+}
+
+PickResult Picker::pick(Scene& scene, const glm::vec3& origin, const glm::vec3& direction, float maxDistance) {
+    PROFILE_SCOPE("Picker::pick");
+    double start = FramePipeline::now();
+    PickResult result;
+    result.hit = false;
+    result.objectIndex = 0;
+    result.triangle = -1;
+    result.distance = maxDistance;
+    result.point = glm::vec3(0.0f);
+    result.candidates = 0;
+    result.tested = 0;
+
+    glm::vec3 dir = glm::normalize(direction);
+    const ObjectStorage& storage = scene.getStorage();
+    const auto& models = storage.getModels();
+    const auto& worldMatrices = storage.getWorldMatrices();
+
+    // Hrubá fáze: paprsek proti obalovým koulím (škálování = nejdelší sloupec matice)
+    vector<Candidate> candidates;
+    for (unsigned int i = 0; i < storage.size(); i++) {
+        Model* model = models[i];
+        if (!model) continue;
+        const glm::mat4& m = worldMatrices[i];
+        const glm::vec4& sphere = model->getBoundingSphere();
+        glm::vec3 center(m * glm::vec4(glm::vec3(sphere), 1.0f));
+        float scale = sqrtf(max(glm::dot(glm::vec3(m[0]), glm::vec3(m[0])),
+            max(glm::dot(glm::vec3(m[1]), glm::vec3(m[1])), glm::dot(glm::vec3(m[2]), glm::vec3(m[2])))));
+        float radius = sphere.w * scale;
+
+        glm::vec3 toCenter = center - origin;
+        float along = glm::dot(toCenter, dir);
+        float distanceSq = glm::dot(toCenter, toCenter) - along * along;
+        if (distanceSq > radius * radius) continue;
+        float halfChord = sqrtf(radius * radius - distanceSq);
+        if (along + halfChord < 0.0f) continue;
+
+        Candidate candidate;
+        candidate.index = i;
+        candidate.entry = max(0.0f, along - halfChord);
+        candidates.push_back(candidate);
+    }
+    result.candidates = static_cast<int>(candidates.size());
+    sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.entry < b.entry;
+    });
+
+    // Úzká fáze: BVH v prostoru modelu. Směr se nenormalizuje, t zůstává world vzdáleností.
+    for (const Candidate& candidate : candidates) {
+        if (candidate.entry >= result.distance) break;
+        result.tested++;
+
+        glm::mat4 inverseModel = glm::inverse(worldMatrices[candidate.index]);
+        glm::vec3 localOrigin(inverseModel * glm::vec4(origin, 1.0f));
+        glm::vec3 localDirection(inverseModel * glm::vec4(dir, 0.0f));
+
+        RayHit hit = models[candidate.index]->getBVH().intersect(localOrigin, localDirection, result.distance);
+        if (hit.triangle >= 0) {
+            result.hit = true;
+            result.objectIndex = candidate.index;
+            result.triangle = hit.triangle;
+            result.distance = hit.t;
+        }
+    }
+
+    if (result.hit) {
+        result.point = origin + dir * result.distance;
+    }
+    result.ms = FramePipeline::now() - start;
+    return result;
+}
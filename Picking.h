@@ -0,0 +1,26 @@
+#pragma once
+#include <glm/glm.hpp>
+
+class Scene;
+
+// Výsledek výběru myší
+struct PickResult {
+    bool hit;
+    unsigned int objectIndex;    // index v ObjectStorage scény
+    int triangle;                // trojúhelník modelu
+    float distance;              // od počátku paprsku ve world prostoru
+    glm::vec3 point;
+
+    // Statistika dotazu
+    int candidates;              // objekty, jejichž obalová koule paprsek protnul
+    int tested;                  // z nich prošly BVH (zbytek byl dál než zásah)
+    double ms;
+};
+
+// Výběr objektu paprskem: hrubá fáze přes obalové koule ve world prostoru,
+// pak paprsek převedený do prostoru modelu proti jeho BVH (od nejbližší koule).
+class Picker {
+public:
+    // World matice scény musí odpovídat zobrazenému snímku (updateWorldMatrices)
+    static PickResult pick(Scene& scene, const glm::vec3& origin, const glm::vec3& direction, float maxDistance = 1000.0f);
+};
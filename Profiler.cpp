@@ -0,0 +1,247 @@
+#include "Profiler.h"
+
+#if ZPG_PROFILING
+
+#include <GL/glew.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <stdio.h>
+
+using namespace std;
+
+namespace {
+
+    const size_t EVENTS_PER_THREAD = 1 << 17;
+    const int GPU_FRAMES = 4;            // výsledky se čtou o GPU_FRAMES snímků později
+    const int GPU_SCOPES_PER_FRAME = 256;
+
+    // Buffer jednoho vlákna - zapisuje jen vlastník, export čte publikovaný počet
+    struct ThreadBuffer {
+        int tid;
+        string name;
+        ProfileEvent* events;
+        atomic<size_t> count;
+        unsigned int generation;
+        size_t dropped;
+    };
+
+    struct GpuFrame {
+        GLuint queries[GPU_SCOPES_PER_FRAME * 2];
+        const char* names[GPU_SCOPES_PER_FRAME];
+        int count;
+        bool pending;
+    };
+
+    atomic<bool> capturing(false);
+    atomic<unsigned int> captureGeneration(0);
+
+    mutex registryMutex;
+    vector<ThreadBuffer*> registry;
+    thread_local ThreadBuffer* localBuffer = nullptr;
+
+    // GPU stav (jen vlákno s GL kontextem)
+    bool gpuReady = false;
+    GpuFrame gpuFrames[GPU_FRAMES];
+    int gpuFrameIndex = 0;
+    GLint64 gpuBaseNs = 0;
+    double cpuBaseUs = 0.0;
+    ThreadBuffer* gpuBuffer = nullptr;
+
+    ThreadBuffer* createBuffer(const char* name) {
+        ThreadBuffer* buffer = new ThreadBuffer();
+        buffer->events = new ProfileEvent[EVENTS_PER_THREAD];
+        buffer->count.store(0);
+        buffer->generation = captureGeneration.load();
+        buffer->dropped = 0;
+
+        lock_guard<mutex> lock(registryMutex);
+        buffer->tid = static_cast<int>(registry.size()) + 1;
+        buffer->name = name ? name : ("Thread " + to_string(buffer->tid));
+        registry.push_back(buffer);
+        return buffer;
+    }
+
+    void push(ThreadBuffer* buffer, const char* name, double start, double end) {
+        // Nový capture - vlákno si svůj buffer vynuluje samo
+        unsigned int generation = captureGeneration.load(memory_order_relaxed);
+        if (buffer->generation != generation) {
+            buffer->count.store(0, memory_order_relaxed);
+            buffer->dropped = 0;
+            buffer->generation = generation;
+        }
+
+        size_t index = buffer->count.load(memory_order_relaxed);
+        if (index >= EVENTS_PER_THREAD) {
+            buffer->dropped++;
+            return;
+        }
+        buffer->events[index].name = name;
+        buffer->events[index].start = start;
+        buffer->events[index].end = end;
+        buffer->count.store(index + 1, memory_order_release);
+    }
+
+    void writeEscaped(FILE* file, const string& text) {
+        for (char c : text) {
+            if (c == '"' || c == '\\') fputc('\\', file);
+            fputc(c, file);
+        }
+    }
+}
+
+double Profiler::now() {
+    using namespace std::chrono;
+    return duration<double, micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::beginCapture() {
+    captureGeneration.fetch_add(1);
+    capturing.store(true);
+    printf("Profiler: capture started\n");
+}
+
+void Profiler::endCapture() {
+    capturing.store(false);
+    printf("Profiler: capture stopped\n");
+}
+
+bool Profiler::isCapturing() {
+    return capturing.load(memory_order_relaxed);
+}
+
+void Profiler::setThreadName(const char* name) {
+    if (!localBuffer) {
+        localBuffer = createBuffer(name);
+    }
+    else {
+        lock_guard<mutex> lock(registryMutex);
+        localBuffer->name = name;
+    }
+}
+
+void Profiler::record(const char* name, double start, double end) {
+    if (!localBuffer) {
+        localBuffer = createBuffer(nullptr);
+    }
+    push(localBuffer, name, start, end);
+}
+
+bool Profiler::exportChromeTrace(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Unable to open trace file: %s\n", path);
+        return false;
+    }
+
+    unsigned int generation = captureGeneration.load();
+    size_t total = 0;
+    size_t dropped = 0;
+    bool first = true;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    lock_guard<mutex> lock(registryMutex);
+    for (auto buffer : registry) {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"",
+            first ? "" : ",\n", buffer->tid);
+        writeEscaped(file, buffer->name);
+        fprintf(file, "\"}}");
+        first = false;
+
+        // Buffer z předchozího capture se nepočítá
+        if (buffer->generation != generation) continue;
+
+        size_t count = buffer->count.load(memory_order_acquire);
+        for (size_t i = 0; i < count; i++) {
+            const ProfileEvent& e = buffer->events[i];
+            fprintf(file, ",\n{\"name\":\"");
+            writeEscaped(file, e.name);
+            fprintf(file, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                buffer->tid, e.start, e.end - e.start);
+        }
+        total += count;
+        dropped += buffer->dropped;
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    printf("Profiler: %d events written to %s (%d dropped)\n", static_cast<int>(total), path, static_cast<int>(dropped));
+    return true;
+}
+
+void Profiler::gpuInitialize() {
+    for (int f = 0; f < GPU_FRAMES; f++) {
+        glGenQueries(GPU_SCOPES_PER_FRAME * 2, gpuFrames[f].queries);
+        gpuFrames[f].count = 0;
+        gpuFrames[f].pending = false;
+    }
+    gpuFrameIndex = 0;
+
+    // Převod GPU času na CPU časovou osu
+    glGetInteger64v(GL_TIMESTAMP, &gpuBaseNs);
+    cpuBaseUs = now();
+
+    if (!gpuBuffer) {
+        gpuBuffer = createBuffer("GPU");
+    }
+    gpuReady = true;
+}
+
+void Profiler::gpuShutdown() {
+    if (!gpuReady) return;
+    for (int f = 0; f < GPU_FRAMES; f++) {
+        glDeleteQueries(GPU_SCOPES_PER_FRAME * 2, gpuFrames[f].queries);
+    }
+    gpuReady = false;
+}
+
+int Profiler::gpuBegin(const char* name) {
+    if (!gpuReady || !isCapturing()) return -1;
+
+    GpuFrame& frame = gpuFrames[gpuFrameIndex];
+    if (frame.count >= GPU_SCOPES_PER_FRAME) return -1;
+
+    int slot = frame.count++;
+    frame.names[slot] = name;
+    glQueryCounter(frame.queries[slot * 2], GL_TIMESTAMP);
+    return slot;
+}
+
+void Profiler::gpuEnd(int slot) {
+    if (!gpuReady) return;
+    glQueryCounter(gpuFrames[gpuFrameIndex].queries[slot * 2 + 1], GL_TIMESTAMP);
+}
+
+void Profiler::gpuCollect() {
+    if (!gpuReady) return;
+
+    gpuFrames[gpuFrameIndex].pending = gpuFrames[gpuFrameIndex].count > 0;
+    gpuFrameIndex = (gpuFrameIndex + 1) % GPU_FRAMES;
+
+    // Nejstarší snímek v kruhu - dotazy jsou GPU_FRAMES snímků staré
+    GpuFrame& frame = gpuFrames[gpuFrameIndex];
+    if (frame.pending) {
+        GLint available = 0;
+        glGetQueryObjectiv(frame.queries[frame.count * 2 - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            for (int i = 0; i < frame.count; i++) {
+                GLuint64 startNs = 0;
+                GLuint64 endNs = 0;
+                glGetQueryObjectui64v(frame.queries[i * 2], GL_QUERY_RESULT, &startNs);
+                glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &endNs);
+                double start = cpuBaseUs + (static_cast<double>(startNs) - gpuBaseNs) / 1000.0;
+                double end = cpuBaseUs + (static_cast<double>(endNs) - gpuBaseNs) / 1000.0;
+                push(gpuBuffer, frame.names[i], start, end);
+            }
+        }
+        // Nedostupné výsledky se zahodí, na GPU se nikdy nečeká
+    }
+    frame.count = 0;
+    frame.pending = false;
+}
+
+#endif
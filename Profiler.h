@@ -0,0 +1,81 @@
+#pragma once
+
+// Profiler lze úplně vypnout při překladu: -DZPG_PROFILING=0
+#ifndef ZPG_PROFILING
+#define ZPG_PROFILING 1
+#endif
+
+#if ZPG_PROFILING
+
+// Jedna změřená oblast (časy v mikrosekundách)
+struct ProfileEvent {
+    const char* name;        // musí žít po celou dobu běhu (řetězcový literál)
+    double start;
+    double end;
+};
+
+// CPU události se zapisují do bufferu vlákna bez zámků, GPU oblasti
+// přes dvojice GL_TIMESTAMP dotazů čtených o několik snímků později.
+// Záznam probíhá jen během capture, export do Chrome trace JSON na vyžádání.
+class Profiler {
+public:
+    static void beginCapture();
+    static void endCapture();
+    static bool isCapturing();
+    static bool exportChromeTrace(const char* path);
+
+    static void setThreadName(const char* name);
+    static double now();
+    static void record(const char* name, double start, double end);
+
+    // GPU část - volat jen z vlákna s GL kontextem
+    static void gpuInitialize();
+    static void gpuShutdown();
+    static int gpuBegin(const char* name);
+    static void gpuEnd(int slot);
+    static void gpuCollect();    // jednou za snímek po swapu
+};
+
+class ProfileScope {
+private:
+    const char* name;
+    double start;
+    bool active;
+public:
+    ProfileScope(const char* scopeName) : name(scopeName), start(0.0), active(Profiler::isCapturing()) {
+        if (active) start = Profiler::now();
+    }
+    ~ProfileScope() {
+        if (active) Profiler::record(name, start, Profiler::now());
+    }
+};
+
+class GpuProfileScope {
+private:
+    int slot;
+public:
+    GpuProfileScope(const char* scopeName) : slot(Profiler::gpuBegin(scopeName)) {}
+    ~GpuProfileScope() {
+        if (slot >= 0) Profiler::gpuEnd(slot);
+    }
+};
+
+#define ZPG_PROFILE_CONCAT_INNER(a, b) a##b
+#define ZPG_PROFILE_CONCAT(a, b) ZPG_PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope ZPG_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) GpuProfileScope ZPG_PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#define PROFILE_THREAD_NAME(name) Profiler::setThreadName(name)
+#define PROFILE_GPU_INITIALIZE() Profiler::gpuInitialize()
+#define PROFILE_GPU_SHUTDOWN() Profiler::gpuShutdown()
+#define PROFILE_GPU_COLLECT() Profiler::gpuCollect()
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_GPU_SCOPE(name) ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#define PROFILE_GPU_INITIALIZE() ((void)0)
+#define PROFILE_GPU_SHUTDOWN() ((void)0)
+#define PROFILE_GPU_COLLECT() ((void)0)
+
+#endif
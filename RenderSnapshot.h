@@ -0,0 +1,55 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include "MatrixBatch.h"
+
+using namespace std;
+
+class DrawableObject;
+class ShaderProgram;
+class Model;
+class Scene;
+
+// Jeden objekt k vykreslení - vše, co render vlákno potřebuje, zkopírované v hlavním vlákně
+struct RenderItem {
+    DrawableObject* object;
+    Model* model;
+    ShaderProgram* shader;
+    unsigned short material;     // index do MaterialTable
+    ObjectMatrices matrices;
+    bool staticObject;
+    bool castsShadow;
+    unsigned int revision;
+    unsigned int viewMask;       // bit i = viditelný v pohledu i (multi-view), jinak 1
+};
+
+// Neměnný obraz snímku předávaný render vláknu
+struct RenderSnapshot {
+    static const int MAX_VIEWS = 4;
+
+    vector<RenderItem> items;
+    Scene* scene;                // render vlákno ho nečte (scéna může být mezitím uvolněna)
+    unsigned int sceneId;        // klíč pro cache (Scene::getId)
+    unsigned int sceneRevision;
+    glm::mat4 viewProjection;
+    glm::vec3 lightPosition;
+    glm::vec3 cameraPosition;
+    int viewportWidth;
+    int viewportHeight;
+    bool shadowsEnabled;
+    int depthPrepassMode;        // DepthPrepassMode
+    bool showOverdraw;           // teplotní mapa stínovaných fragmentů na pixel
+    float impostorDistance;      // vegetace dál než tohle jako impostor, 0 = vypnuto
+    bool recordDrawList;         // statická scéna - render vlákno si items zaznamená
+    bool replayDrawList;         // beze změny - items jsou prázdné, přehraje se záznam
+    double frameTime;
+    long long frameIndex;
+    int objectsVisited;          // objekty prošlé v buildSnapshot (0 při přehrání záznamu)
+    int objectsCulled;
+    double inputTimestamp;       // nejstarší zpracovaná událost vstupu (ms, 0 = žádná)
+
+    // Multi-view (viewCount > 1): pohledy kreslené jedním průchodem
+    int viewCount;
+    glm::mat4 viewProjections[MAX_VIEWS];
+    glm::vec4 viewRects[MAX_VIEWS];    // x, y, šířka, výška v poměru k oknu (0..1)
+};
@@ -0,0 +1,152 @@
+#include "RenderStats.h"
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <cstdlib>
+
+using namespace std;
+
+FrameCounters RenderStats::counters = {};
+
+namespace {
+    atomic<long long> heapAllocations(0);
+    long long lastHeapAllocations = 0;
+
+    mutex historyMutex;
+    FrameCounters history[RenderStats::HISTORY];
+    int historyCount = 0;
+    int historyNext = 0;
+    FrameCounters lastFrame = {};
+
+    FILE* csvFile = nullptr;
+}
+
+// Počítání alokací - nahrazuje globální operator new/delete
+void* operator new(size_t size) {
+    heapAllocations.fetch_add(1, memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+// Velikostní varianty (C++14) volá kompilátor při známé velikosti objektu
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    operator delete[](p);
+}
+
+void RenderStats::endFrame(long long frameIndex) {
+    long long allocations = heapAllocations.load(memory_order_relaxed);
+    counters.heapAllocations = allocations - lastHeapAllocations;
+    lastHeapAllocations = allocations;
+
+    {
+        lock_guard<mutex> lock(historyMutex);
+        history[historyNext] = counters;
+        historyNext = (historyNext + 1) % HISTORY;
+        if (historyCount < HISTORY) historyCount++;
+        lastFrame = counters;
+    }
+
+    if (csvFile) {
+        const FrameCounters& c = counters;
+        fprintf(csvFile, "%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld\n", frameIndex,
+            c.drawCalls, c.triangles, c.programBinds, c.vaoBinds, c.uniformUploads,
+            c.bufferBytes, c.objectsVisited, c.objectsCulled, c.heapAllocations, c.inputLatencyUs);
+    }
+
+    counters = FrameCounters();
+}
+
+FrameCounters RenderStats::getLastFrame() {
+    lock_guard<mutex> lock(historyMutex);
+    return lastFrame;
+}
+
+FrameAverages RenderStats::getAverages() {
+    FrameAverages a = {};
+    lock_guard<mutex> lock(historyMutex);
+    a.frames = historyCount;
+    if (historyCount == 0) return a;
+
+    for (int i = 0; i < historyCount; i++) {
+        const FrameCounters& c = history[i];
+        a.drawCalls += c.drawCalls;
+        a.triangles += c.triangles;
+        a.programBinds += c.programBinds;
+        a.vaoBinds += c.vaoBinds;
+        a.uniformUploads += c.uniformUploads;
+        a.bufferBytes += c.bufferBytes;
+        a.objectsVisited += c.objectsVisited;
+        a.objectsCulled += c.objectsCulled;
+        a.heapAllocations += c.heapAllocations;
+        if (c.inputLatencyUs > 0) {
+            a.inputLatencyMs += c.inputLatencyUs / 1000.0;
+            a.inputFrames++;
+        }
+    }
+
+    double n = historyCount;
+    a.drawCalls /= n;
+    a.triangles /= n;
+    a.programBinds /= n;
+    a.vaoBinds /= n;
+    a.uniformUploads /= n;
+    a.bufferBytes /= n;
+    a.objectsVisited /= n;
+    a.objectsCulled /= n;
+    a.heapAllocations /= n;
+    if (a.inputFrames > 0) a.inputLatencyMs /= a.inputFrames;
+    return a;
+}
+
+long long RenderStats::getHeapAllocations() {
+    return heapAllocations.load(memory_order_relaxed);
+}
+
+void RenderStats::printSummary() {
+    FrameAverages a = getAverages();
+    if (a.frames == 0) return;
+
+    printf("Frame stats (avg of %d): draws %.1f, tris %.0f, programs %.1f, vaos %.1f, uniforms %.1f, "
+        "upload %.0f B, visited %.1f, culled %.1f, allocs %.1f\n",
+        a.frames, a.drawCalls, a.triangles, a.programBinds, a.vaoBinds, a.uniformUploads,
+        a.bufferBytes, a.objectsVisited, a.objectsCulled, a.heapAllocations);
+    if (a.inputFrames > 0) {
+        printf("Input latency (event -> swap): %.2f ms avg over %d frames\n", a.inputLatencyMs, a.inputFrames);
+    }
+}
+
+bool RenderStats::openCsv(const char* path) {
+    closeCsv();
+    csvFile = fopen(path, "w");
+    if (!csvFile) {
+        printf("Unable to open stats file: %s\n", path);
+        return false;
+    }
+    fprintf(csvFile, "frame,draw_calls,triangles,program_binds,vao_binds,uniform_uploads,"
+        "buffer_bytes,objects_visited,objects_culled,heap_allocations,input_latency_us\n");
+    return true;
+}
+
+void RenderStats::closeCsv() {
+    if (csvFile) {
+        fclose(csvFile);
+        csvFile = nullptr;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <stdio.h>
+
+// Čítače jednoho snímku
+struct FrameCounters {
+    long long drawCalls;
+    long long triangles;
+    long long programBinds;
+    long long vaoBinds;
+    long long uniformUploads;
+    long long bufferBytes;       // data nahraná do GL bufferů
+    long long objectsVisited;    // objekty prošlé při sestavení snímku
+    long long objectsCulled;
+    long long heapAllocations;   // volání operator new ve všech vláknech
+    long long inputLatencyUs;    // nejstarší událost vstupu -> swap (0 = snímek bez vstupu)
+};
+
+// Průměry přes posledních HISTORY snímků
+struct FrameAverages {
+    int frames;
+    double drawCalls;
+    double triangles;
+    double programBinds;
+    double vaoBinds;
+    double uniformUploads;
+    double bufferBytes;
+    double objectsVisited;
+    double objectsCulled;
+    double heapAllocations;
+    double inputLatencyMs;       // jen přes snímky se vstupem
+    int inputFrames;
+};
+
+// Levné čítače vykreslování. GL čítače zvyšuje jen vlákno s GL kontextem,
+// takže stačí obyčejné proměnné; alokace se počítají atomicky v operator new.
+class RenderStats {
+private:
+    static FrameCounters counters;
+public:
+    static const int HISTORY = 120;
+
+    static void drawCall(int vertices) {
+        counters.drawCalls++;
+        counters.triangles += vertices / 3;
+    }
+    static void programBind() { counters.programBinds++; }
+    static void vaoBind() { counters.vaoBinds++; }
+    static void uniformUpload(int count = 1) { counters.uniformUploads += count; }
+    static void bufferUpload(long long bytes) { counters.bufferBytes += bytes; }
+    static void objects(long long visited, long long culled) {
+        counters.objectsVisited += visited;
+        counters.objectsCulled += culled;
+    }
+    static void inputLatency(double ms) { counters.inputLatencyUs = static_cast<long long>(ms * 1000.0); }
+
+    // Uzavře snímek (GL vlákno): uloží čítače do historie a CSV, vynuluje je
+    static void endFrame(long long frameIndex);
+
+    // Z libovolného vlákna
+    static FrameCounters getLastFrame();
+    static FrameAverages getAverages();
+    static long long getHeapAllocations();
+    static void printSummary();
+
+    static bool openCsv(const char* path);
+    static void closeCsv();
+};
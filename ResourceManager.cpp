@@ -0,0 +1,169 @@
+#include "ResourceManager.h"
+#include "Profiler.h"
+#include <stdio.h>
+
+ResourceManager::ResourceManager() : vramBudget(0), evictionCount(0) {}
+
+ResourceManager::~ResourceManager() {
+    clear();
+}
+
+void ResourceManager::clear() {
+    // Mazání mimo zámek - scény při zániku uvolňují reference na modely a shadery
+    vector<Scene*> deadScenes;
+    {
+        lock_guard<mutex> lock(poolMutex);
+        deadScenes = scenes.takeAll();
+    }
+    for (auto scene : deadScenes) delete scene;
+
+    vector<Model*> deadModels;
+    vector<ShaderProgram*> deadShaders;
+    {
+        lock_guard<mutex> lock(poolMutex);
+        deadModels = models.takeAll();
+        deadShaders = shaders.takeAll();
+    }
+    for (auto model : deadModels) delete model;
+    for (auto shader : deadShaders) delete shader;
+}
+
+SceneHandle ResourceManager::addScene(const string& name, Scene* scene) {
+    SceneHandle handle;
+    {
+        lock_guard<mutex> lock(poolMutex);
+        handle = scenes.add(name, scene);
+    }
+    scene->getStorage().setResourceManager(this);
+    return handle;
+}
+
+void ResourceManager::release(ModelHandle handle) {
+    Model* dead;
+    {
+        lock_guard<mutex> lock(poolMutex);
+        dead = models.release(handle);
+    }
+    delete dead;
+}
+
+void ResourceManager::release(ShaderHandle handle) {
+    ShaderProgram* dead;
+    {
+        lock_guard<mutex> lock(poolMutex);
+        dead = shaders.release(handle);
+    }
+    delete dead;
+}
+
+void ResourceManager::release(SceneHandle handle) {
+    Scene* dead;
+    {
+        lock_guard<mutex> lock(poolMutex);
+        dead = scenes.release(handle);
+    }
+    delete dead;
+}
+
+void ResourceManager::addRef(const Model* model, int count) {
+    lock_guard<mutex> lock(poolMutex);
+    models.addRef(models.handleOf(model), count);
+}
+
+void ResourceManager::addRef(const ShaderProgram* shader, int count) {
+    lock_guard<mutex> lock(poolMutex);
+    shaders.addRef(shaders.handleOf(shader), count);
+}
+
+void ResourceManager::release(const Model* model, int count) {
+    Model* dead;
+    {
+        lock_guard<mutex> lock(poolMutex);
+        dead = models.release(models.handleOf(model), count);
+    }
+    delete dead;
+}
+
+void ResourceManager::release(const ShaderProgram* shader, int count) {
+    ShaderProgram* dead;
+    {
+        lock_guard<mutex> lock(poolMutex);
+        dead = shaders.release(shaders.handleOf(shader), count);
+    }
+    delete dead;
+}
+
+int ResourceManager::getModelCount() const {
+    lock_guard<mutex> lock(poolMutex);
+    int count = 0;
+    for (size_t i = 0; i < models.capacity(); i++) {
+        if (models.at(i)) count++;
+    }
+    return count;
+}
+
+size_t ResourceManager::getResidentBytes() const {
+    lock_guard<mutex> lock(poolMutex);
+    return residentBytes();
+}
+
+size_t ResourceManager::residentBytes() const {
+    size_t total = 0;
+    for (size_t i = 0; i < models.capacity(); i++) {
+        Model* model = models.at(i);
+        if (model && model->isResident()) total += model->getGpuBytes();
+    }
+    return total;
+}
+
+size_t ResourceManager::getModelBytes(ModelHandle handle) const {
+    lock_guard<mutex> lock(poolMutex);
+    Model* model = models.get(handle);
+    return (model && model->isResident()) ? model->getGpuBytes() : 0;
+}
+
+void ResourceManager::endFrame() {
+    unsigned long long frame = Model::getCurrentFrame();
+    Model::advanceFrame();
+    if (vramBudget == 0) return;
+
+    lock_guard<mutex> lock(poolMutex);
+    size_t resident = residentBytes();
+    if (resident <= vramBudget) return;
+    PROFILE_SCOPE("ResourceManager::evict");
+
+    // Nejdéle nekreslené modely; co se kreslilo v tomto snímku, zůstává
+    while (resident > vramBudget) {
+        Model* oldest = nullptr;
+        for (size_t i = 0; i < models.capacity(); i++) {
+            Model* model = models.at(i);
+            if (!model || !model->isResident() || model->getLastUsedFrame() >= frame) continue;
+            if (!oldest || model->getLastUsedFrame() < oldest->getLastUsedFrame()) {
+                oldest = model;
+            }
+        }
+        if (!oldest) break;
+
+        resident -= oldest->getGpuBytes();
+        oldest->unload();
+        evictionCount++;
+    }
+}
+
+void ResourceManager::printStats() const {
+    lock_guard<mutex> lock(poolMutex);
+    int total = 0;
+    int resident = 0;
+    for (size_t i = 0; i < models.capacity(); i++) {
+        Model* model = models.at(i);
+        if (!model) continue;
+        total++;
+        if (model->isResident()) resident++;
+    }
+
+    printf("Resources: %d/%d models resident, %.2f MB", resident, total, residentBytes() / (1024.0 * 1024.0));
+    if (vramBudget > 0) {
+        printf(" of %.2f MB budget", vramBudget / (1024.0 * 1024.0));
+    }
+    printf(", evictions %d, reloads %d\n", evictionCount, Model::getReloadCount());
+}
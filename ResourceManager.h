@@ -0,0 +1,202 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include "Model.h"
+#include "ShaderProgram.h"
+#include "Scene.h"
+
+using namespace std;
+
+// Typovaný odkaz na prostředek. Generace se zvýší při uvolnění, takže
+// handle na smazaný prostředek je neplatný i po znovupoužití slotu.
+template<typename T>
+struct ResourceHandle {
+    unsigned int index;
+    unsigned int generation;
+
+    ResourceHandle() : index(0xFFFFFFFFu), generation(0) {}
+    ResourceHandle(unsigned int i, unsigned int g) : index(i), generation(g) {}
+    bool isNull() const { return index == 0xFFFFFFFFu; }
+};
+
+typedef ResourceHandle<Model> ModelHandle;
+typedef ResourceHandle<ShaderProgram> ShaderHandle;
+typedef ResourceHandle<Scene> SceneHandle;
+
+// Tabulka prostředků jednoho typu s počítáním referencí.
+// add() vrací handle s jednou referencí (patří tomu, kdo prostředek přidal).
+// Reference drží i úložiště objektů scén (ObjectStorage) za každý objekt.
+// release() prostředek nemaže, jen ho vrátí - maže volající mimo zámek,
+// protože destruktor scény sám uvolňuje reference na modely a shadery.
+template<typename T>
+class ResourcePool {
+private:
+    struct Entry {
+        T* resource;
+        string name;
+        int refCount;
+        unsigned int generation;
+    };
+
+    vector<Entry> entries;
+    vector<unsigned int> freeEntries;
+    unordered_map<const T*, unsigned int> indices;   // ukazatel -> index (reference podle ukazatele)
+public:
+    ~ResourcePool() {
+        for (T* resource : takeAll()) delete resource;
+    }
+
+    ResourceHandle<T> add(const string& name, T* resource) {
+        unsigned int index;
+        if (!freeEntries.empty()) {
+            index = freeEntries.back();
+            freeEntries.pop_back();
+        }
+        else {
+            index = static_cast<unsigned int>(entries.size());
+            Entry e;
+            e.generation = 0;
+            entries.push_back(e);
+        }
+        Entry& e = entries[index];
+        e.resource = resource;
+        e.name = name;
+        e.refCount = 1;
+        indices[resource] = index;
+        return ResourceHandle<T>(index, e.generation);
+    }
+
+    // Handle podle ukazatele (null, pokud prostředek v tabulce není)
+    ResourceHandle<T> handleOf(const T* resource) const {
+        auto it = indices.find(resource);
+        if (it == indices.end()) return ResourceHandle<T>();
+        return ResourceHandle<T>(it->second, entries[it->second].generation);
+    }
+
+    T* get(ResourceHandle<T> handle) const {
+        if (handle.index >= entries.size()) return nullptr;
+        const Entry& e = entries[handle.index];
+        return e.generation == handle.generation ? e.resource : nullptr;
+    }
+
+    ResourceHandle<T> find(const string& name) const {
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (entries[i].resource && entries[i].name == name) {
+                return ResourceHandle<T>(static_cast<unsigned int>(i), entries[i].generation);
+            }
+        }
+        return ResourceHandle<T>();
+    }
+
+    void addRef(ResourceHandle<T> handle, int count = 1) {
+        if (get(handle)) entries[handle.index].refCount += count;
+    }
+
+    // Poslední reference zneplatní handle a vrátí prostředek ke smazání
+    T* release(ResourceHandle<T> handle, int count = 1) {
+        if (!get(handle)) return nullptr;
+        Entry& e = entries[handle.index];
+        e.refCount -= count;
+        if (e.refCount > 0) return nullptr;
+
+        T* resource = e.resource;
+        indices.erase(resource);
+        e.resource = nullptr;
+        e.name.clear();
+        e.generation++;
+        freeEntries.push_back(handle.index);
+        return resource;
+    }
+
+    // Vyprázdní tabulku a vrátí všechny prostředky ke smazání
+    vector<T*> takeAll() {
+        vector<T*> resources;
+        for (auto& e : entries) {
+            if (e.resource) resources.push_back(e.resource);
+        }
+        entries.clear();
+        freeEntries.clear();
+        indices.clear();
+        return resources;
+    }
+
+    int getRefCount(ResourceHandle<T> handle) const { return get(handle) ? entries[handle.index].refCount : 0; }
+    size_t capacity() const { return entries.size(); }
+    T* at(size_t index) const { return entries[index].resource; }
+    const string& nameAt(size_t index) const { return entries[index].name; }
+    // Jméno podle ukazatele (prázdné, pokud prostředek v tabulce není)
+    string nameOf(const T* resource) const {
+        for (const auto& e : entries) {
+            if (e.refCount > 0 && e.resource == resource) return e.name;
+        }
+        return string();
+    }
+};
+
+// Vlastník modelů, shaderů a scén. Sleduje obsazení VRAM modely a při
+// překročení rozpočtu vyhazuje nejdéle nekreslené modely; model se znovu
+// nahraje sám při dalším vykreslení.
+// Tabulky chrání zámek (hlavní vlákno přidává, render vlákno vyhazuje).
+class ResourceManager {
+private:
+    ResourcePool<Scene> scenes;            // scény se ruší první (drží ukazatele na modely)
+    ResourcePool<Model> models;
+    ResourcePool<ShaderProgram> shaders;
+    mutable mutex poolMutex;
+
+    size_t vramBudget;                     // 0 = bez omezení
+    int evictionCount;
+
+    size_t residentBytes() const;
+public:
+    ResourceManager();
+    ~ResourceManager();
+
+    ModelHandle addModel(const string& name, Model* model) { lock_guard<mutex> lock(poolMutex); return models.add(name, model); }
+    ShaderHandle addShader(const string& name, ShaderProgram* shader) { lock_guard<mutex> lock(poolMutex); return shaders.add(name, shader); }
+    // Objekty scény od teď drží reference na své modely a shadery
+    SceneHandle addScene(const string& name, Scene* scene);
+
+    Model* get(ModelHandle handle) const { lock_guard<mutex> lock(poolMutex); return models.get(handle); }
+    ShaderProgram* get(ShaderHandle handle) const { lock_guard<mutex> lock(poolMutex); return shaders.get(handle); }
+    Scene* get(SceneHandle handle) const { lock_guard<mutex> lock(poolMutex); return scenes.get(handle); }
+
+    ModelHandle findModel(const string& name) const { lock_guard<mutex> lock(poolMutex); return models.find(name); }
+    ShaderHandle findShader(const string& name) const { lock_guard<mutex> lock(poolMutex); return shaders.find(name); }
+    SceneHandle findScene(const string& name) const { lock_guard<mutex> lock(poolMutex); return scenes.find(name); }
+    // Pohodlnější přístup podle jména (nullptr, pokud neexistuje)
+    Model* getModel(const string& name) const { lock_guard<mutex> lock(poolMutex); return models.get(models.find(name)); }
+    ShaderProgram* getShader(const string& name) const { lock_guard<mutex> lock(poolMutex); return shaders.get(shaders.find(name)); }
+    string getName(const Model* model) const { lock_guard<mutex> lock(poolMutex); return models.nameOf(model); }
+    string getName(const ShaderProgram* shader) const { lock_guard<mutex> lock(poolMutex); return shaders.nameOf(shader); }
+
+    void addRef(ModelHandle handle) { lock_guard<mutex> lock(poolMutex); models.addRef(handle); }
+    void addRef(ShaderHandle handle) { lock_guard<mutex> lock(poolMutex); shaders.addRef(handle); }
+    void addRef(SceneHandle handle) { lock_guard<mutex> lock(poolMutex); scenes.addRef(handle); }
+    // Poslední release prostředek smaže - model jen z vlákna s GL kontextem
+    void release(ModelHandle handle);
+    void release(ShaderHandle handle);
+    void release(SceneHandle handle);
+
+    // Reference podle ukazatele pro úložiště objektů (prostředky mimo tabulku se ignorují)
+    void addRef(const Model* model, int count = 1);
+    void addRef(const ShaderProgram* shader, int count = 1);
+    void release(const Model* model, int count = 1);
+    void release(const ShaderProgram* shader, int count = 1);
+
+    int getModelCount() const;
+
+    // Uvolní vše ve správném pořadí (scény, modely, shadery)
+    void clear();
+
+    // VRAM (vlákno s GL kontextem)
+    void setVramBudget(size_t bytes) { vramBudget = bytes; }
+    size_t getVramBudget() const { return vramBudget; }
+    size_t getResidentBytes() const;
+    size_t getModelBytes(ModelHandle handle) const;
+    // Konec snímku: posune čítač snímků modelů a vynutí rozpočet
+    void endFrame();
+    void printStats() const;
+};
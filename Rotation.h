@@ -10,4 +10,6 @@ public:
     Rotation(float angle, const glm::vec3& axis);
     // Implementace virtuální metody
     glm::mat4 getMatrix() const override;
+    float getAngle() const { return angle; }
+    const glm::vec3& getAxis() const { return axis; }
 };
\ No newline at end of file
@@ -12,4 +12,5 @@ public:
     Scale(float uniform);
     // Implementace virtuální metody
     glm::mat4 getMatrix() const override;
+    const glm::vec3& getScale() const { return scale; }
 };
\ No newline at end of file
@@ -1,20 +1,54 @@
 #include "Scene.h"
+#include "CompositeTransform.h"
+#include <atomic>
 
-Scene::Scene(const string& sceneName) : name(sceneName) {}
+// Scény se sestavují i ve vlákně předpřípravy
+static atomic<unsigned int> nextSceneId(1);
+
+Scene::Scene(const string& sceneName)
+    : storage(this), name(sceneName), id(nextSceneId++), revision(0), changeRevision(0), staticCheckRevision(0), staticScene(true), animated(false) {}
 
 Scene::~Scene() {
-    for (auto obj : objects) {
-        delete obj;
+    // Destruktor fasády odebere objekt z úložiště - maže se od konce, bez přesunů.
+    // Objekty bez fasády (načtené blokově) zůstanou v polích a zaniknou s nimi.
+    for (size_t i = storage.size(); i > 0; i--) {
+        delete storage.getObjects()[i - 1];
+    }
+    for (auto transform : ownedTransforms) {
+        delete transform;
+    }
+}
+
+void Scene::setShader(ShaderProgram* shader) {
+    for (unsigned int i = 0; i < storage.size(); i++) {
+        storage.setShader(i, shader);
+        storage.notifyChanged(i, false);
     }
-    objects.clear();
 }
 
 void Scene::addObject(DrawableObject* drawable) {
-    objects.push_back(drawable);
+    drawable->attach(storage);
+    revision++;
+    changeRevision++;
+}
+
+bool Scene::isStatic() {
+    if (staticCheckRevision != changeRevision) {
+        staticScene = true;
+        const auto& flags = storage.getFlags();
+        for (size_t i = 0; i < flags.size(); i++) {
+            if (!(flags[i] & ObjectStorage::FLAG_STATIC)) {
+                staticScene = false;
+                break;
+            }
+        }
+        staticCheckRevision = changeRevision;
+    }
+    return staticScene;
 }
 
 const vector<DrawableObject*>& Scene::getObjects() const {
-    return objects;
+    return storage.getObjects();
 }
 
 const string& Scene::getName() const {
@@ -22,5 +56,5 @@ const string& Scene::getName() const {
 }
 
 int Scene::getObjectCount() const {
-    return static_cast<int>(objects.size());
+    return static_cast<int>(storage.size());
 }
\ No newline at end of file
@@ -7,14 +7,42 @@ using namespace std;
 
 class Scene {
 private:
-    vector<DrawableObject*> objects;
+    ObjectStorage storage;   // data objektů, DrawableObject je fasáda
     string name;
+    unsigned int id;         // jedinečné po celou dobu běhu (i po uvolnění a novém sestavení)
+    unsigned int revision;   // zvyšuje se při přidání nebo odebrání objektu
+    unsigned int changeRevision;   // zvyšuje se při jakékoli změně objektu
+    unsigned int staticCheckRevision;
+    bool staticScene;
+    bool animated;           // scéna se mění každý snímek (vyžaduje průběžné vykreslování)
+    vector<CompositeTransform*> ownedTransforms;   // kořeny transformací z továrny nebo ze souboru
 public:
     Scene(const string& sceneName);
     ~Scene();
 
     void addObject(DrawableObject* drawable);
+    // Po ObjectStorage::appendBlock (objekty bez fasád)
+    void notifyObjectsAdded() { revision++; changeRevision++; }
+    // Po ObjectStorage::destroy bez fasády (streamované dlaždice)
+    void notifyObjectsRemoved() { revision++; changeRevision++; }
+    // Scéna transformaci smaže ve svém destruktoru (i s potomky) - objekt ji jen používá
+    void adoptTransform(CompositeTransform* transform) { ownedTransforms.push_back(transform); }
     const vector<DrawableObject*>& getObjects() const;
+    // Stejný shader pro všechny objekty (i bez fasády)
+    void setShader(ShaderProgram* shader);
+    ObjectStorage& getStorage() { return storage; }
+    const ObjectStorage& getStorage() const { return storage; }
     const string& getName() const;
+    unsigned int getId() const { return id; }
     int getObjectCount() const;
+    unsigned int getRevision() const { return revision; }
+
+    // Volá DrawableObject při změně transformace, shaderu nebo příznaků
+    void notifyObjectChanged() { changeRevision++; }
+    unsigned int getChangeRevision() const { return changeRevision; }
+    // true, pokud jsou všechny objekty statické (přepočítá se jen po změně)
+    bool isStatic();
+
+    void setAnimated(bool a) { animated = a; }
+    bool isAnimated() const { return animated; }
 };
\ No newline at end of file
@@ -0,0 +1,402 @@
+#include "SceneFile.h"
+#include "Scene.h"
+#include "ResourceManager.h"
+#include "Transform.h"
+#include "Translation.h"
+#include "Rotation.h"
+#include "Scale.h"
+#include "MaterialTable.h"
+#include "Profiler.h"
+#include <stdio.h>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace SceneFormat;
+
+// Pole se kopírují přímo do vector<glm::vec3> - rozložení musí sedět
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed");
+
+namespace {
+    // Soubor namapovaný jen pro čtení
+    class MappedFile {
+    private:
+        const unsigned char* data;
+        size_t size;
+#ifdef _WIN32
+        HANDLE file;
+        HANDLE mapping;
+#endif
+    public:
+        MappedFile(const char* path) : data(nullptr), size(0) {
+#ifdef _WIN32
+            file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            mapping = NULL;
+            if (file == INVALID_HANDLE_VALUE) return;
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return;
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (!mapping) return;
+            data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            if (data) size = static_cast<size_t>(fileSize.QuadPart);
+#else
+            int fd = open(path, O_RDONLY);
+            if (fd < 0) return;
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0) {
+                void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    data = static_cast<const unsigned char*>(p);
+                    size = static_cast<size_t>(st.st_size);
+                    // Pole se čtou sekvenčně celá
+                    madvise(p, size, MADV_SEQUENTIAL | MADV_WILLNEED);
+                }
+            }
+            close(fd);
+#endif
+        }
+
+        ~MappedFile() {
+#ifdef _WIN32
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+            if (data) munmap(const_cast<unsigned char*>(data), size);
+#endif
+        }
+
+        const unsigned char* getData() const { return data; }
+        size_t getSize() const { return size; }
+    };
+
+    // Sestavení souboru v paměti, sekce se zarovnávají
+    class SectionWriter {
+    private:
+        vector<unsigned char> buffer;
+    public:
+        SectionWriter() : buffer(sizeof(Header), 0) {}
+
+        uint64_t append(const void* data, size_t bytes) {
+            while (buffer.size() % ALIGNMENT) buffer.push_back(0);
+            uint64_t offset = buffer.size();
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            buffer.insert(buffer.end(), p, p + bytes);
+            return offset;
+        }
+
+        vector<unsigned char>& getBuffer() { return buffer; }
+    };
+
+    // Uzly kompozitní transformace v pre-orderu: potomek má vždy větší index než rodič
+    class NodeWriter {
+    public:
+        vector<Node> nodes;
+        vector<uint32_t> children;
+        bool supported;
+
+        NodeWriter() : supported(true) {}
+
+        uint32_t write(const CompositeTransform* transform) {
+            uint32_t index = static_cast<uint32_t>(nodes.size());
+            Node node = {};
+            nodes.push_back(node);
+
+            if (const Transform* group = dynamic_cast<const Transform*>(transform)) {
+                vector<uint32_t> childNodes;
+                for (const CompositeTransform* child : group->getChildren()) {
+                    childNodes.push_back(write(child));
+                }
+                nodes[index].type = NODE_GROUP;
+                nodes[index].firstChild = static_cast<uint32_t>(children.size());
+                nodes[index].childCount = static_cast<uint32_t>(childNodes.size());
+                children.insert(children.end(), childNodes.begin(), childNodes.end());
+            }
+            else if (const Translation* t = dynamic_cast<const Translation*>(transform)) {
+                const glm::vec3& v = t->getTranslation();
+                nodes[index].type = NODE_TRANSLATION;
+                nodes[index].params[0] = v.x;
+                nodes[index].params[1] = v.y;
+                nodes[index].params[2] = v.z;
+            }
+            else if (const Rotation* r = dynamic_cast<const Rotation*>(transform)) {
+                nodes[index].type = NODE_ROTATION;
+                nodes[index].params[0] = r->getAngle();
+                nodes[index].params[1] = r->getAxis().x;
+                nodes[index].params[2] = r->getAxis().y;
+                nodes[index].params[3] = r->getAxis().z;
+            }
+            else if (const Scale* s = dynamic_cast<const Scale*>(transform)) {
+                const glm::vec3& v = s->getScale();
+                nodes[index].type = NODE_SCALE;
+                nodes[index].params[0] = v.x;
+                nodes[index].params[1] = v.y;
+                nodes[index].params[2] = v.z;
+            }
+            else {
+                supported = false;
+            }
+            return index;
+        }
+    };
+
+    // Index do tabulky jmen, jméno se přidá při prvním výskytu
+    template<typename T>
+    uint16_t tableIndex(const T* resource, const ResourceManager& resources, map<const T*, uint16_t>& indices, vector<string>& names) {
+        if (!resource) return NO_INDEX;
+        auto it = indices.find(resource);
+        if (it != indices.end()) return it->second;
+        uint16_t index = static_cast<uint16_t>(names.size());
+        indices[resource] = index;
+        names.push_back(resources.getName(resource));
+        return index;
+    }
+
+    CompositeTransform* buildTransform(const Node* nodes, const uint32_t* children, uint32_t index) {
+        const Node& node = nodes[index];
+        switch (node.type) {
+        case NODE_TRANSLATION:
+            return new Translation(node.params[0], node.params[1], node.params[2]);
+        case NODE_ROTATION:
+            return new Rotation(node.params[0], glm::vec3(node.params[1], node.params[2], node.params[3]));
+        case NODE_SCALE:
+            return new Scale(node.params[0], node.params[1], node.params[2]);
+        default: {
+            Transform* group = new Transform();
+            for (uint32_t c = 0; c < node.childCount; c++) {
+                group->addTransform(buildTransform(nodes, children, children[node.firstChild + c]));
+            }
+            return group;
+        }
+        }
+    }
+}
+
+bool SceneFile::save(const Scene& scene, const ResourceManager& resources, const char* path) {
+    PROFILE_SCOPE("SceneFile::save");
+    const ObjectStorage& storage = scene.getStorage();
+    size_t count = storage.size();
+
+    // Tabulky modelů a shaderů
+    map<const Model*, uint16_t> modelIndices;
+    map<const ShaderProgram*, uint16_t> shaderIndices;
+    vector<string> modelNames;
+    vector<string> shaderNames;
+    vector<uint16_t> models(count);
+    vector<uint16_t> shaders(count);
+    for (size_t i = 0; i < count; i++) {
+        models[i] = tableIndex<Model>(storage.getModels()[i], resources, modelIndices, modelNames);
+        shaders[i] = tableIndex<ShaderProgram>(storage.getShaders()[i], resources, shaderIndices, shaderNames);
+    }
+    for (const auto& name : modelNames) {
+        if (name.empty()) {
+            printf("Scene export: %s uses a model that is not in the resource manager\n", scene.getName().c_str());
+            return false;
+        }
+    }
+    if (modelNames.size() >= NO_INDEX || shaderNames.size() >= NO_INDEX) {
+        printf("Scene export: too many models or shaders\n");
+        return false;
+    }
+
+    // Kompozitní transformace - sdílená transformace se zapíše jednou
+    NodeWriter nodeWriter;
+    map<const CompositeTransform*, uint32_t> roots;
+    vector<uint32_t> transformRoots(count, NO_NODE);
+    for (size_t i = 0; i < count; i++) {
+        const CompositeTransform* transform = storage.getTransforms()[i];
+        if (!transform) continue;
+        auto it = roots.find(transform);
+        transformRoots[i] = it != roots.end() ? it->second : (roots[transform] = nodeWriter.write(transform));
+    }
+    if (!nodeWriter.supported) {
+        printf("Scene export: %s uses an unsupported transform type\n", scene.getName().c_str());
+        return false;
+    }
+
+    vector<char> strings;
+    auto addString = [&strings](const string& s) { strings.insert(strings.end(), s.begin(), s.end()); strings.push_back('\0'); };
+    addString(scene.getName());
+    for (const auto& name : modelNames) addString(name);
+    for (const auto& name : shaderNames) addString(name);
+
+    // Příznak DIRTY se nezapisuje
+    vector<unsigned char> flags(storage.getFlags().begin(), storage.getFlags().end());
+    for (auto& f : flags) f &= ~ObjectStorage::FLAG_DIRTY;
+
+    SectionWriter writer;
+    Header header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.objectCount = static_cast<uint32_t>(count);
+    header.nodeCount = static_cast<uint32_t>(nodeWriter.nodes.size());
+    header.childCount = static_cast<uint32_t>(nodeWriter.children.size());
+    header.modelCount = static_cast<uint32_t>(modelNames.size());
+    header.shaderCount = static_cast<uint32_t>(shaderNames.size());
+    header.sceneFlags = scene.isAnimated() ? SCENE_ANIMATED : 0;
+    header.sections[SECTION_TRANSLATIONS] = writer.append(storage.getTranslations().data(), count * sizeof(glm::vec3));
+    header.sections[SECTION_ROTATION_AXES] = writer.append(storage.getRotationAxes().data(), count * sizeof(glm::vec3));
+    header.sections[SECTION_ROTATION_ANGLES] = writer.append(storage.getRotationAngles().data(), count * sizeof(float));
+    header.sections[SECTION_SCALES] = writer.append(storage.getScales().data(), count * sizeof(glm::vec3));
+    header.sections[SECTION_FLAGS] = writer.append(flags.data(), count);
+    header.sections[SECTION_MODELS] = writer.append(models.data(), count * sizeof(uint16_t));
+    header.sections[SECTION_SHADERS] = writer.append(shaders.data(), count * sizeof(uint16_t));
+    header.sections[SECTION_MATERIALS] = writer.append(storage.getMaterials().data(), count * sizeof(uint16_t));
+    header.sections[SECTION_TRANSFORM_ROOTS] = writer.append(transformRoots.data(), count * sizeof(uint32_t));
+    header.sections[SECTION_NODES] = writer.append(nodeWriter.nodes.data(), nodeWriter.nodes.size() * sizeof(Node));
+    header.sections[SECTION_CHILDREN] = writer.append(nodeWriter.children.data(), nodeWriter.children.size() * sizeof(uint32_t));
+    header.sections[SECTION_STRINGS] = writer.append(strings.data(), strings.size());
+
+    vector<unsigned char>& buffer = writer.getBuffer();
+    header.fileSize = buffer.size();
+    memcpy(buffer.data(), &header, sizeof(header));
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        printf("Unable to open scene file for writing: %s\n", path);
+        return false;
+    }
+    bool ok = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    fclose(file);
+    if (!ok) {
+        printf("Error writing scene file: %s\n", path);
+        return false;
+    }
+    printf("Exported scene %s: %d objects, %d nodes, %.1f KB\n", scene.getName().c_str(),
+        static_cast<int>(count), static_cast<int>(nodeWriter.nodes.size()), buffer.size() / 1024.0);
+    return true;
+}
+
+Scene* SceneFile::load(const char* path, const ResourceManager& resources) {
+    PROFILE_SCOPE("SceneFile::load");
+    MappedFile file(path);
+    const unsigned char* data = file.getData();
+    if (!data) {
+        printf("Unable to open scene file: %s\n", path);
+        return nullptr;
+    }
+
+    // Kontrola hlavičky a rozsahů všech sekcí
+    Header header;
+    if (file.getSize() < sizeof(header)) {
+        printf("Invalid scene file: %s\n", path);
+        return nullptr;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.fileSize != file.getSize()) {
+        printf("Invalid scene file: %s\n", path);
+        return nullptr;
+    }
+
+    uint64_t n = header.objectCount;
+    const uint64_t sizes[SECTION_COUNT] = {
+        n * sizeof(glm::vec3), n * sizeof(glm::vec3), n * sizeof(float), n * sizeof(glm::vec3), n,
+        n * sizeof(uint16_t), n * sizeof(uint16_t), n * sizeof(uint16_t), n * sizeof(uint32_t),
+        uint64_t(header.nodeCount) * sizeof(Node), uint64_t(header.childCount) * sizeof(uint32_t),
+        header.fileSize - header.sections[SECTION_STRINGS]
+    };
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        if (header.sections[s] > header.fileSize || sizes[s] > header.fileSize - header.sections[s] ||
+            header.sections[s] % ALIGNMENT != 0) {
+            printf("Corrupted scene file (section %d): %s\n", s, path);
+            return nullptr;
+        }
+    }
+
+    // Tabulka řetězců: jméno scény, modely, shadery
+    const char* strings = reinterpret_cast<const char*>(data + header.sections[SECTION_STRINGS]);
+    const char* stringsEnd = reinterpret_cast<const char*>(data + header.fileSize);
+    vector<string> names;
+    for (const char* p = strings; p < stringsEnd && names.size() < 1 + header.modelCount + header.shaderCount; ) {
+        const char* end = static_cast<const char*>(memchr(p, '\0', stringsEnd - p));
+        if (!end) break;
+        names.push_back(string(p, end));
+        p = end + 1;
+    }
+    if (names.size() != 1 + header.modelCount + header.shaderCount) {
+        printf("Corrupted scene file (strings): %s\n", path);
+        return nullptr;
+    }
+
+    vector<Model*> modelTable(header.modelCount);
+    for (uint32_t m = 0; m < header.modelCount; m++) {
+        modelTable[m] = resources.getModel(names[1 + m]);
+        if (!modelTable[m]) printf("Scene %s: unknown model %s\n", path, names[1 + m].c_str());
+    }
+    vector<ShaderProgram*> shaderTable(header.shaderCount);
+    for (uint32_t s = 0; s < header.shaderCount; s++) {
+        shaderTable[s] = resources.getShader(names[1 + header.modelCount + s]);
+        if (!shaderTable[s]) printf("Scene %s: unknown shader %s\n", path, names[1 + header.modelCount + s].c_str());
+    }
+
+    const uint16_t* models = reinterpret_cast<const uint16_t*>(data + header.sections[SECTION_MODELS]);
+    const uint16_t* shaders = reinterpret_cast<const uint16_t*>(data + header.sections[SECTION_SHADERS]);
+    const uint16_t* materials = reinterpret_cast<const uint16_t*>(data + header.sections[SECTION_MATERIALS]);
+    const uint32_t* transformRoots = reinterpret_cast<const uint32_t*>(data + header.sections[SECTION_TRANSFORM_ROOTS]);
+    const Node* nodes = reinterpret_cast<const Node*>(data + header.sections[SECTION_NODES]);
+    const uint32_t* children = reinterpret_cast<const uint32_t*>(data + header.sections[SECTION_CHILDREN]);
+
+    // Indexy mimo tabulky by v appendBlock četly mimo paměť
+    for (uint64_t i = 0; i < n; i++) {
+        if ((models[i] != NO_INDEX && models[i] >= header.modelCount) ||
+            (shaders[i] != NO_INDEX && shaders[i] >= header.shaderCount) ||
+            materials[i] >= MaterialTable::MAX_MATERIALS ||
+            (transformRoots[i] != NO_NODE && transformRoots[i] >= header.nodeCount)) {
+            printf("Corrupted scene file (object %d): %s\n", static_cast<int>(i), path);
+            return nullptr;
+        }
+    }
+    for (uint32_t i = 0; i < header.nodeCount; i++) {
+        if (nodes[i].type != NODE_GROUP) continue;
+        if (uint64_t(nodes[i].firstChild) + nodes[i].childCount > header.childCount) {
+            printf("Corrupted scene file (node %d): %s\n", static_cast<int>(i), path);
+            return nullptr;
+        }
+        // Potomek má vždy větší index - jinak by šlo o cyklus
+        for (uint32_t c = 0; c < nodes[i].childCount; c++) {
+            uint32_t child = children[nodes[i].firstChild + c];
+            if (child <= i || child >= header.nodeCount) {
+                printf("Corrupted scene file (node %d): %s\n", static_cast<int>(i), path);
+                return nullptr;
+            }
+        }
+    }
+
+    Scene* scene = new Scene(names[0]);
+    scene->setAnimated((header.sceneFlags & SCENE_ANIMATED) != 0);
+    ObjectStorage& storage = scene->getStorage();
+    storage.appendBlock(static_cast<size_t>(n), models, modelTable.data(), shaders, shaderTable.data(),
+        reinterpret_cast<const glm::vec3*>(data + header.sections[SECTION_TRANSLATIONS]),
+        reinterpret_cast<const glm::vec3*>(data + header.sections[SECTION_ROTATION_AXES]),
+        reinterpret_cast<const float*>(data + header.sections[SECTION_ROTATION_ANGLES]),
+        reinterpret_cast<const glm::vec3*>(data + header.sections[SECTION_SCALES]),
+        data + header.sections[SECTION_FLAGS], materials);
+
+    // Hierarchie jen u objektů, které ji mají (sdílený kořen se vytvoří jednou)
+    if (header.nodeCount > 0) {
+        map<uint32_t, CompositeTransform*> built;
+        for (uint64_t i = 0; i < n; i++) {
+            uint32_t root = transformRoots[i];
+            if (root == NO_NODE) continue;
+            CompositeTransform*& transform = built[root];
+            if (!transform) {
+                transform = buildTransform(nodes, children, root);
+                scene->adoptTransform(transform);
+            }
+            storage.setTransform(static_cast<unsigned int>(i), transform);
+        }
+    }
+    scene->notifyObjectsAdded();
+    return scene;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+
+class Scene;
+class ResourceManager;
+
+// Binární formát scény (.zpgs), little endian.
+// Sekce odpovídají polím ObjectStorage (stejné typy i pořadí), takže se při
+// načtení kopírují vcelku bez parsování a bez alokace na objekt.
+// Modely a shadery se odkazují jménem z ResourceManageru přes tabulku řetězců,
+// materiály přímo indexem do MaterialTable (tabulka se plní v kódu vždy stejně).
+// Kompozitní transformace (hierarchie Transform/Translation/Rotation/Scale)
+// jsou uzly s tabulkou potomků; objekt bez transformace používá TRS pole.
+namespace SceneFormat {
+    const char MAGIC[4] = { 'Z', 'P', 'G', 'S' };
+    const uint32_t VERSION = 2;         // 2: SECTION_MATERIALS
+    const uint32_t ALIGNMENT = 16;
+    const uint16_t NO_INDEX = 0xFFFF;       // objekt bez modelu/shaderu
+    const uint32_t NO_NODE = 0xFFFFFFFFu;   // objekt bez kompozitní transformace
+
+    enum Section {
+        SECTION_TRANSLATIONS,       // vec3 na objekt
+        SECTION_ROTATION_AXES,      // vec3
+        SECTION_ROTATION_ANGLES,    // float
+        SECTION_SCALES,             // vec3
+        SECTION_FLAGS,              // uint8 (ObjectStorage::Flags)
+        SECTION_MODELS,             // uint16 index do tabulky modelů
+        SECTION_SHADERS,            // uint16 index do tabulky shaderů
+        SECTION_MATERIALS,          // uint16 index do MaterialTable
+        SECTION_TRANSFORM_ROOTS,    // uint32 uzel nebo NO_NODE
+        SECTION_NODES,              // Node
+        SECTION_CHILDREN,           // uint32 indexy uzlů
+        SECTION_STRINGS,            // jméno scény, modely, shadery (řetězce ukončené nulou)
+        SECTION_COUNT
+    };
+
+    enum NodeType {
+        NODE_GROUP,                 // Transform
+        NODE_TRANSLATION,           // params = x, y, z
+        NODE_ROTATION,              // params = úhel, osa x, y, z
+        NODE_SCALE                  // params = x, y, z
+    };
+
+    enum SceneFlags {
+        SCENE_ANIMATED = 1
+    };
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t objectCount;
+        uint32_t nodeCount;
+        uint32_t childCount;
+        uint32_t modelCount;
+        uint32_t shaderCount;
+        uint32_t sceneFlags;
+        uint64_t fileSize;
+        uint64_t sections[SECTION_COUNT];   // offset od začátku souboru
+    };
+
+    struct Node {
+        uint32_t type;
+        uint32_t firstChild;        // index do SECTION_CHILDREN (jen NODE_GROUP)
+        uint32_t childCount;
+        float params[4];
+    };
+}
+
+class SceneFile {
+public:
+    // Zapíše scénu v paměti; modely a shadery musí být v ResourceManageru
+    static bool save(const Scene& scene, const ResourceManager& resources, const char* path);
+    // Namapuje soubor a vytvoří scénu (nullptr při chybě)
+    static Scene* load(const char* path, const ResourceManager& resources);
+};
@@ -0,0 +1,33 @@
+#include "SceneGenerator.h"
+#include <random>
+#include <cmath>
+
+Scene* SceneGenerator::generateForest(const string& name, int objectCount, unsigned int seed,
+    Model* treeModel, ShaderProgram* treeShader, Model* bushModel, ShaderProgram* bushShader) {
+    Scene* scene = new Scene(name);
+    scene->getStorage().reserve(objectCount);
+    mt19937 rng(seed);
+
+    // Scéna 7: 100 objektů na (-20 až 20) x (-20 až 20)
+    float extent = 20.0f * sqrtf(objectCount / 100.0f);
+    if (extent < 20.0f) extent = 20.0f;
+    unsigned int steps = static_cast<unsigned int>(extent * 200.0f);   // krok 0.01 jako v createScenes
+
+    int treeCount = objectCount / 2;
+    for (int i = 0; i < objectCount; i++) {
+        bool isTree = i < treeCount;
+
+        float posX = (rng() % steps) / 100.0f - extent;
+        float posZ = (rng() % steps) / 100.0f - extent;
+        float rotationY = (rng() % 360) * 3.14159f / 180.0f;
+        // stromy 0.2 až 0.4, keře 0.15 až 0.35
+        float scale = (isTree ? 0.2f : 0.15f) + (rng() % 20) / 100.0f;
+
+        DrawableObject* object = isTree ? new DrawableObject(treeModel, treeShader)
+                                        : new DrawableObject(bushModel, bushShader);
+        object->setLocalTransform(glm::vec3(posX, -0.5f, posZ), rotationY, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(scale));
+        scene->addObject(object);
+    }
+
+    return scene;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include "Scene.h"
+
+using namespace std;
+
+class Model;
+class ShaderProgram;
+
+// Parametrický les podle scény 7: první polovina stromy, druhá keře,
+// náhodná pozice, rotace kolem Y a velikost. Plocha roste s počtem objektů,
+// takže hustota zůstává jako u původních 100 objektů na 40x40.
+// Stejný seed dává vždy stejnou scénu (nezávisle na rand()).
+class SceneGenerator {
+public:
+    // Modely a shader můžou být nullptr (měření bez GL).
+    // Objekty používají lokální TRS v ObjectStorage, žádné Transform alokace.
+    static Scene* generateForest(const string& name, int objectCount, unsigned int seed,
+        Model* treeModel, ShaderProgram* treeShader, Model* bushModel, ShaderProgram* bushShader);
+};
@@ -0,0 +1,258 @@
+#include "SceneLoader.h"
+#include "Scene.h"
+#include "FramePipeline.h"
+#include "Profiler.h"
+#include <stdio.h>
+
+SceneLoader::SceneLoader(ResourceManager& resources)
+    : unloadGuardFrames(1 + UNLOAD_GUARD_MARGIN), resources(resources), budgetBytes(0), requested(-1), stopping(false),
+    builds(0), prebuilds(0), hits(0), misses(0), unloads(0) {
+}
+
+SceneLoader::~SceneLoader() {
+    stop();
+}
+
+int SceneLoader::registerScene(const string& name, SceneFactory factory) {
+    lock_guard<mutex> lock(entryMutex);
+    Entry entry = { name, factory, nullptr, nullptr, SceneHandle(), false, -1, 0.0 };
+    entries.push_back(entry);
+    for (auto& row : transitions) row.push_back(0);
+    transitions.push_back(vector<int>(entries.size(), 0));
+    return static_cast<int>(entries.size()) - 1;
+}
+
+int SceneLoader::addScene(Scene* scene) {
+    int index = registerScene(scene->getName(), SceneFactory());
+    lock_guard<mutex> lock(entryMutex);
+    entries[index].scene = scene;
+    entries[index].handle = resources.addScene(scene->getName(), scene);
+    return index;
+}
+
+int SceneLoader::getCount() const {
+    lock_guard<mutex> lock(entryMutex);
+    return static_cast<int>(entries.size());
+}
+
+const string& SceneLoader::getName(int index) const {
+    lock_guard<mutex> lock(entryMutex);
+    return entries[index].name;
+}
+
+Scene* SceneLoader::get(int index) const {
+    lock_guard<mutex> lock(entryMutex);
+    return entries[index].scene;
+}
+
+Scene* SceneLoader::build(int index) {
+    SceneFactory factory;
+    string name;
+    ShaderProgram* shader;
+    {
+        lock_guard<mutex> lock(entryMutex);
+        factory = entries[index].factory;
+        name = entries[index].name;
+        shader = entries[index].shader;
+    }
+
+    Scene* scene = nullptr;
+    double start = FramePipeline::now();
+    {
+        PROFILE_SCOPE("SceneLoader::build");
+        lock_guard<mutex> lock(buildMutex);
+        scene = factory();
+        // Továrna zná jen výchozí shader, volba uživatele se vrací po každém sestavení
+        if (shader) scene->setShader(shader);
+    }
+    double ms = FramePipeline::now() - start;
+    SceneHandle handle = resources.addScene(name, scene);
+
+    lock_guard<mutex> lock(entryMutex);
+    Entry& entry = entries[index];
+    entry.scene = scene;
+    entry.handle = handle;
+    entry.building = false;
+    entry.buildMs = ms;
+    builds++;
+    builtCondition.notify_all();
+    return scene;
+}
+
+Scene* SceneLoader::acquire(int index) {
+    {
+        unique_lock<mutex> lock(entryMutex);
+        Entry& entry = entries[index];
+        // Předpříprava už běží - dokončit ji je levnější než stavět znovu
+        builtCondition.wait(lock, [&entry]() { return !entry.building; });
+        if (entry.scene) {
+            hits++;
+            return entry.scene;
+        }
+        entry.building = true;
+        misses++;
+    }
+    return build(index);
+}
+
+void SceneLoader::start() {
+    if (worker.joinable()) return;
+    stopping = false;
+    worker = thread(&SceneLoader::workerLoop, this);
+}
+
+void SceneLoader::stop() {
+    {
+        lock_guard<mutex> lock(entryMutex);
+        stopping = true;
+    }
+    workCondition.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void SceneLoader::workerLoop() {
+    PROFILE_THREAD_NAME("Scene prebuild");
+    while (true) {
+        int index;
+        {
+            unique_lock<mutex> lock(entryMutex);
+            workCondition.wait(lock, [this]() { return stopping || requested >= 0; });
+            if (stopping) return;
+            index = requested;
+            requested = -1;
+
+            Entry& entry = entries[index];
+            if (entry.scene || entry.building || !entry.factory) continue;
+            entry.building = true;
+            prebuilds++;
+        }
+        build(index);
+    }
+}
+
+void SceneLoader::onSwitch(int from, int to) {
+    int next;
+    {
+        lock_guard<mutex> lock(entryMutex);
+        if (from >= 0 && from != to) transitions[from][to]++;
+    }
+    next = predictNext(to);
+    if (next >= 0) prefetch(next);
+}
+
+int SceneLoader::predictNext(int index) const {
+    lock_guard<mutex> lock(entryMutex);
+    int count = static_cast<int>(entries.size());
+    if (count < 2) return -1;
+
+    // Nejčastější přechod z této scény, bez historie další v pořadí (klávesy 1-8)
+    int best = (index + 1) % count;
+    int bestCount = 0;
+    for (int i = 0; i < count; i++) {
+        if (i != index && transitions[index][i] > bestCount) {
+            best = i;
+            bestCount = transitions[index][i];
+        }
+    }
+    return best;
+}
+
+void SceneLoader::prefetch(int index) {
+    {
+        lock_guard<mutex> lock(entryMutex);
+        if (entries[index].scene || entries[index].building) return;
+        requested = index;
+    }
+    workCondition.notify_one();
+}
+
+size_t SceneLoader::estimateBytes(const Scene* scene) {
+    // Hustá pole ObjectStorage a fasády; Transform stromy se nepočítají
+    size_t perObject = sizeof(DrawableObject) + sizeof(glm::mat4) + 3 * sizeof(glm::vec3) +
+        sizeof(float) + 5 * sizeof(void*) + 2 * sizeof(unsigned int) + 1;
+    return static_cast<size_t>(scene->getObjectCount()) * perObject + sizeof(Scene);
+}
+
+size_t SceneLoader::getResidentBytes() const {
+    lock_guard<mutex> lock(entryMutex);
+    size_t total = 0;
+    for (const auto& entry : entries) {
+        if (entry.scene) total += estimateBytes(entry.scene);
+    }
+    return total;
+}
+
+void SceneLoader::setFramesInFlight(int frames) {
+    lock_guard<mutex> lock(entryMutex);
+    unloadGuardFrames = (frames > 0 ? frames : 0) + UNLOAD_GUARD_MARGIN;
+}
+
+void SceneLoader::markActive(int index, long long frameIndex) {
+    {
+        lock_guard<mutex> lock(entryMutex);
+        entries[index].lastActiveFrame = frameIndex;
+    }
+    if (budgetBytes == 0) return;
+
+    // Nad rozpočtem: uvolňují se nejdéle nepoužité scény s továrnou
+    while (getResidentBytes() > budgetBytes) {
+        int victim = -1;
+        {
+            lock_guard<mutex> lock(entryMutex);
+            long long oldest = frameIndex - unloadGuardFrames;
+            for (int i = 0; i < static_cast<int>(entries.size()); i++) {
+                const Entry& entry = entries[i];
+                if (i == index || !entry.scene || entry.building || !entry.factory) continue;
+                if (entry.lastActiveFrame < oldest) {
+                    oldest = entry.lastActiveFrame;
+                    victim = i;
+                }
+            }
+        }
+        if (victim < 0) break;
+        unload(victim);
+    }
+}
+
+void SceneLoader::unload(int index) {
+    SceneHandle handle;
+    {
+        lock_guard<mutex> lock(entryMutex);
+        Entry& entry = entries[index];
+        if (!entry.scene || entry.building || !entry.factory) return;
+        handle = entry.handle;
+        entry.scene = nullptr;
+        entry.handle = SceneHandle();
+        unloads++;
+    }
+    resources.release(handle);
+}
+
+void SceneLoader::setShader(int index, ShaderProgram* shader) {
+    lock_guard<mutex> lock(entryMutex);
+    entries[index].shader = shader;
+}
+
+void SceneLoader::clear() {
+    stop();
+    lock_guard<mutex> lock(entryMutex);
+    for (auto& entry : entries) {
+        if (entry.scene) {
+            resources.release(entry.handle);
+            entry.scene = nullptr;
+            entry.handle = SceneHandle();
+        }
+    }
+}
+
+void SceneLoader::printStats() const {
+    lock_guard<mutex> lock(entryMutex);
+    int resident = 0;
+    for (const auto& entry : entries) {
+        if (entry.scene) resident++;
+    }
+    printf("Scenes: %d/%d built, %d builds (%d prebuilt), %d hits, %d sync builds, %d unloads\n",
+        resident, static_cast<int>(entries.size()), builds, prebuilds, hits, misses, unloads);
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "ResourceManager.h"
+
+using namespace std;
+
+class Scene;
+class ShaderProgram;
+
+typedef function<Scene*()> SceneFactory;
+
+// Scény registrované jako továrny. Sestaví se až při prvním přepnutí,
+// vlákno předpřípravy mezitím staví pravděpodobnou další scénu.
+// Neaktivní scény s továrnou lze při překročení rozpočtu uvolnit.
+// Sestavená scéna patří ResourceManageru (pool scén).
+class SceneLoader {
+private:
+    struct Entry {
+        string name;
+        SceneFactory factory;    // prázdná = scéna přidaná hotová, neuvolňuje se
+        ShaderProgram* shader;   // zvolený uživatelem (F1-F4/G), nullptr = z továrny
+        Scene* scene;            // nullptr = nesestavená
+        SceneHandle handle;
+        bool building;
+        long long lastActiveFrame;
+        double buildMs;
+    };
+
+    // Scéna se uvolní nejdřív po (snímky v letu + rezerva) snímcích bez použití -
+    // snímky v letu ji ještě čtou
+    static const int UNLOAD_GUARD_MARGIN = 2;
+    int unloadGuardFrames;
+
+    ResourceManager& resources;
+    vector<Entry> entries;
+    vector<vector<int>> transitions;    // [odkud][kam] počty přepnutí
+    size_t budgetBytes;                 // 0 = bez omezení
+
+    mutable mutex entryMutex;
+    condition_variable builtCondition;
+    // Sestavení se nepřekrývají (DrawableObject vzniká ve sdíleném ObjectStorage::detached())
+    mutex buildMutex;
+
+    thread worker;
+    condition_variable workCondition;
+    int requested;                      // index k předpřípravě, -1 = nic
+    bool stopping;
+
+    // Statistiky
+    int builds;
+    int prebuilds;
+    int hits;
+    int misses;
+    int unloads;
+
+    void workerLoop();
+    Scene* build(int index);
+    static size_t estimateBytes(const Scene* scene);
+public:
+    SceneLoader(ResourceManager& resources);
+    ~SceneLoader();
+
+    int registerScene(const string& name, SceneFactory factory);
+    // Hotová scéna (bez továrny)
+    int addScene(Scene* scene);
+    int getCount() const;
+    const string& getName(int index) const;
+
+    // Sestavená scéna nebo nullptr (nestaví)
+    Scene* get(int index) const;
+    // Sestavená scéna, případně ji postaví hned (počká na rozpracovanou předpřípravu)
+    Scene* acquire(int index);
+
+    void start();
+    void stop();
+
+    // Hlavní vlákno: přepnutí scény - zapamatuje přechod a předpřipraví odhad další
+    void onSwitch(int from, int to);
+    int predictNext(int index) const;
+    void prefetch(int index);
+
+    // Hlavní vlákno každý snímek: razítko aktivní scény, uvolnění nad rozpočtem
+    void markActive(int index, long long frameIndex);
+    // Hloubka pipeline (FramePipeline), podle ní se drží nepoužité scény
+    void setFramesInFlight(int frames);
+    void setBudget(size_t bytes) { budgetBytes = bytes; }
+    size_t getResidentBytes() const;
+    void unload(int index);
+    // Shader zvolený pro scénu, použije se i po uvolnění a novém sestavení
+    void setShader(int index, ShaderProgram* shader);
+    // Uvolní všechny scény (před rušením GL kontextu)
+    void clear();
+
+    void printStats() const;
+};
@@ -1,5 +1,8 @@
 ﻿#include "ShaderProgram.h"
 #include "Camera.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "MaterialTable.h"
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -7,6 +10,71 @@
 
 using namespace std;
 
+// Společné deklarace fragment shaderů - jediná kopie, vkládá se za řádek #version.
+// Tabulka materiálů odpovídá struct Material (std140, MaterialTable::MAX_MATERIALS),
+// stín je 20-tap PCF z cube mapy hlavního světla (ShadowMap::applyUniforms).
+static const char* commonFragmentSource =
+    "struct Material {\n"
+    "    vec4 diffuse;\n"
+    "    vec4 ambient;\n"
+    "    vec4 specular;      // w = shininess\n"
+    "};\n"
+    "layout(std140) uniform Materials {\n"
+    "    Material materials[256];\n"
+    "};\n"
+    "uniform int materialIndex;\n"
+    "\n"
+    "uniform samplerCubeShadow shadowMap;\n"
+    "uniform float shadowFarPlane;\n"
+    "uniform int shadowsEnabled;\n"
+    "\n"
+    "const vec3 pcfOffsets[20] = vec3[](\n"
+    "    vec3( 1,  1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1,  1,  1),\n"
+    "    vec3( 1,  1, -1), vec3( 1, -1, -1), vec3(-1, -1, -1), vec3(-1,  1, -1),\n"
+    "    vec3( 1,  1,  0), vec3( 1, -1,  0), vec3(-1, -1,  0), vec3(-1,  1,  0),\n"
+    "    vec3( 1,  0,  1), vec3(-1,  0,  1), vec3( 1,  0, -1), vec3(-1,  0, -1),\n"
+    "    vec3( 0,  1,  1), vec3( 0, -1,  1), vec3( 0, -1, -1), vec3( 0,  1, -1)\n"
+    ");\n"
+    "\n"
+    "// 1.0 = osvětleno, 0.0 = ve stínu\n"
+    "float shadowFactor(vec3 worldPosition, vec3 lightPosition) {\n"
+    "    if (shadowsEnabled == 0) return 1.0;\n"
+    "    vec3 fromLight = worldPosition - lightPosition;\n"
+    "    float currentDepth = length(fromLight) / shadowFarPlane;\n"
+    "    if (currentDepth >= 1.0) return 1.0;\n"
+    "    vec3 dir = normalize(fromLight);\n"
+    "    float bias = 0.002;\n"
+    "    float diskRadius = 0.004;\n"
+    "    float lit = 0.0;\n"
+    "    for (int i = 0; i < 20; i++) {\n"
+    "        lit += texture(shadowMap, vec4(dir + pcfOffsets[i] * diskRadius, currentDepth - bias));\n"
+    "    }\n"
+    "    return lit / 20.0;\n"
+    "}\n";
+
+// Vloží společné deklarace za řádek #version; #line vrací čísla řádků
+// v chybových hláškách na řádky původního souboru
+static string withCommonDeclarations(const char* source) {
+    string code(source);
+    size_t versionEnd = 0;
+    size_t version = code.find("#version");
+    if (version != string::npos) {
+        versionEnd = code.find('\n', version);
+        versionEnd = (versionEnd == string::npos) ? code.size() : versionEnd + 1;
+    }
+    int line = 1;
+    for (size_t i = 0; i < versionEnd; i++) {
+        if (code[i] == '\n') line++;
+    }
+
+    string result = code.substr(0, versionEnd);
+    if (versionEnd > 0 && result[versionEnd - 1] != '\n') result += '\n';
+    result += commonFragmentSource;
+    result += "#line " + to_string(line) + "\n";
+    result += code.substr(versionEnd);
+    return result;
+}
+
 ShaderProgram::ShaderProgram()
     : vertexShader(0), fragmentShader(0), shaderProgram(0), m_camera(nullptr) {
 }
@@ -66,15 +134,20 @@ bool ShaderProgram::loadShaderFromFiles(const char* vertexPath, const char* frag
     fragmentFile.close();
 
     // Kompilace shaderů
-    return loadMainShader(vertexCode.c_str(), fragmentCode.c_str());
+    return loadMainShader(vertexCode.c_str(), fragmentCode.c_str(), true);
 }
 
-bool ShaderProgram::loadMainShader(const char* vertexSource, const char* fragmentSource) {
+bool ShaderProgram::loadMainShader(const char* vertexSource, const char* fragmentSource, bool withCommon) {
+    PROFILE_SCOPE("ShaderProgram::loadMainShader");
     vertexShader = glCreateShader(GL_VERTEX_SHADER);
     if (!compileShader(vertexShader, vertexSource)) return false;
 
     fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    if (!compileShader(fragmentShader, fragmentSource)) return false;
+    if (withCommon) {
+        string fragmentCode = withCommonDeclarations(fragmentSource);
+        if (!compileShader(fragmentShader, fragmentCode.c_str())) return false;
+    }
+    else if (!compileShader(fragmentShader, fragmentSource)) return false;
 
     shaderProgram = glCreateProgram();
     glAttachShader(shaderProgram, vertexShader);
@@ -92,11 +165,59 @@ bool ShaderProgram::loadMainShader(const char* vertexSource, const char* fragmen
         delete[] strInfoLog;
         return false;
     }
+
+    // Blok tabulky materiálů (shadery bez materiálu ho nemají)
+    GLuint materialBlock = glGetUniformBlockIndex(shaderProgram, "Materials");
+    if (materialBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(shaderProgram, materialBlock, MaterialTable::BINDING);
+    }
+
+    collectUniforms();
     return true;
 }
 
+void ShaderProgram::collectUniforms() {
+    uniformLocations.clear();
+
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    if (count <= 0 || maxLength <= 0) return;
+
+    GLchar* name = new GLchar[maxLength];
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(shaderProgram, static_cast<GLuint>(i), maxLength, &length, &size, &type, name);
+
+        // Uniformy v blocích (Materials) lokaci nemají
+        GLint location = glGetUniformLocation(shaderProgram, name);
+        if (location == -1) continue;
+
+        // Pole se hlásí jako "jmeno[0]", nastavují se přes "jmeno"
+        string uniformName(name, length);
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0) {
+            uniformName.erase(uniformName.size() - 3);
+        }
+        uniformLocations[uniformName] = location;
+    }
+    delete[] name;
+}
+
+GLint ShaderProgram::findUniform(const char* name) const {
+    auto it = uniformLocations.find(name);
+    return (it != uniformLocations.end()) ? it->second : -1;
+}
+
+bool ShaderProgram::hasUniform(const char* name) const {
+    return findUniform(name) != -1;
+}
+
 void ShaderProgram::use(GLuint program) {
     glUseProgram(program);
+    RenderStats::programBind();
 }
 
 GLuint ShaderProgram::getProgram() const {
@@ -104,9 +225,11 @@ GLuint ShaderProgram::getProgram() const {
 }
 
 void ShaderProgram::SetUniform(const char* name, float value) {
-    GLint location = glGetUniformLocation(shaderProgram, name);
+    PROFILE_SCOPE("ShaderProgram::SetUniform");
+    GLint location = findUniform(name);
     if (location != -1) {
         glUniform1f(location, value);
+        RenderStats::uniformUpload();
     }
     else {
         printf("Warning: uniform '%s' not found!\n", name);
@@ -114,9 +237,11 @@ void ShaderProgram::SetUniform(const char* name, float value) {
 }
 
 void ShaderProgram::SetUniform(const char* name, int value) {
-    GLint location = glGetUniformLocation(shaderProgram, name);
+    PROFILE_SCOPE("ShaderProgram::SetUniform");
+    GLint location = findUniform(name);
     if (location != -1) {
         glUniform1i(location, value);
+        RenderStats::uniformUpload();
     }
     else {
         printf("Warning: uniform '%s' not found!\n", name);
@@ -124,21 +249,37 @@ void ShaderProgram::SetUniform(const char* name, int value) {
 }
 
 void ShaderProgram::SetUniform(const char* name, const glm::vec3& value) {
-    GLint location = glGetUniformLocation(shaderProgram, name);
+    PROFILE_SCOPE("ShaderProgram::SetUniform");
+    GLint location = findUniform(name);
     if (location != -1) {
         glUniform3fv(location, 1, glm::value_ptr(value));
+        RenderStats::uniformUpload();
     }
-    else if (strcmp(name, "lightPosition") != 0 && strcmp(name, "cameraPosition") != 0) {
+    else {
+        printf("Warning: uniform '%s' not found!\n", name);
+    }
+}
+
+void ShaderProgram::SetUniform(const char* name, const glm::mat3& value) {
+    PROFILE_SCOPE("ShaderProgram::SetUniform");
+    GLint location = findUniform(name);
+    if (location != -1) {
+        glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
+        RenderStats::uniformUpload();
+    }
+    else {
         printf("Warning: uniform '%s' not found!\n", name);
     }
 }
 
 void ShaderProgram::SetUniform(const char* name, const glm::mat4& value) {
-    GLint location = glGetUniformLocation(shaderProgram, name);
+    PROFILE_SCOPE("ShaderProgram::SetUniform");
+    GLint location = findUniform(name);
     if (location != -1) {
         glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+        RenderStats::uniformUpload();
     }
-    else if (strcmp(name, "viewMatrix") != 0 && strcmp(name, "projectionMatrix") != 0) {
+    else {
         printf("Warning: uniform '%s' not found!\n", name);
     }
 }
@@ -3,6 +3,8 @@
 #include <stdio.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <string>
+#include <unordered_map>
 #include "Observer.h"
 
 class Camera;
@@ -15,24 +17,36 @@ private:
 
     Camera* m_camera;
 
+    // Lokace aktivních uniformů, zjištěné jednou po linkování
+    std::unordered_map<std::string, GLint> uniformLocations;
+
     bool compileShader(GLuint shader, const char* source);
+    void collectUniforms();
+    GLint findUniform(const char* name) const;
 public:
     ShaderProgram();
     ShaderProgram(Camera* camera);
     virtual ~ShaderProgram();
 
-    // Shader s barvami
-    bool loadMainShader(const char* vertexSource, const char* fragmentSource);
+    // Shader s barvami. withCommon = před fragment shader se vloží společné
+    // deklarace (tabulka materiálů, stínová mapa a shadowFactor)
+    bool loadMainShader(const char* vertexSource, const char* fragmentSource, bool withCommon = false);
 
+    // Fragment shadery ze souborů dostávají společné deklarace vždy
     bool loadShaderFromFiles(const char* vertexPath, const char* fragmentPath);
 
     void use(GLuint program);
     GLuint getProgram() const;
 
-    // Přetížené metody SetUniform
+    // Má program aktivní uniform tohoto jména? Volající tím přeskakuje uniformy,
+    // které program nepoužívá (např. původní shader nemá světlo ani materiál).
+    bool hasUniform(const char* name) const;
+
+    // Přetížené metody SetUniform - chybějící uniform je chyba volajícího a vypíše varování
     void SetUniform(const char* name, float value);
     void SetUniform(const char* name, int value);
     void SetUniform(const char* name, const glm::vec3& value);
+    void SetUniform(const char* name, const glm::mat3& value);
     void SetUniform(const char* name, const glm::mat4& value);
 
     // Observer metoda
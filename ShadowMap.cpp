@@ -0,0 +1,291 @@
+#include "ShadowMap.h"
+#include "RenderSnapshot.h"
+#include "ShaderProgram.h"
+#include "Model.h"
+#include "Profiler.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <stdio.h>
+
+using namespace std;
+
+static double elapsedMs(chrono::high_resolution_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+ShadowMap::ShadowMap(int resolution, float farPlane)
+    : staticCube(0), frameCube(0), activeCube(0), drawFbo(0), readFbo(0),
+    staticQuery(0), frameQuery(0), staticQueryPending(false), frameQueryPending(false),
+    resolution(resolution), nearPlane(0.05f), farPlane(farPlane), enabled(true),
+    depthShader(nullptr), cacheValid(false), cachedSceneId(0),
+    cachedLightPosition(0.0f), cachedRevision(0) {
+    stats = ShadowStats{ 0, 0.0, 0.0, 0.0, 0.0, 0 };
+}
+
+ShadowMap::~ShadowMap() {
+    if (depthShader) delete depthShader;
+    if (staticCube) glDeleteTextures(1, &staticCube);
+    if (frameCube) glDeleteTextures(1, &frameCube);
+    if (drawFbo) glDeleteFramebuffers(1, &drawFbo);
+    if (readFbo) glDeleteFramebuffers(1, &readFbo);
+    if (staticQuery) glDeleteQueries(1, &staticQuery);
+    if (frameQuery) glDeleteQueries(1, &frameQuery);
+}
+
+GLuint ShadowMap::createCubeTexture() {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+    for (int face = 0; face < 6; face++) {
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_DEPTH_COMPONENT24,
+            resolution, resolution, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    }
+    // Hardwarové porovnání hloubky (samplerCubeShadow), lineární filtr = 2x2 PCF navíc
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    return texture;
+}
+
+bool ShadowMap::initialize() {
+    depthShader = new ShaderProgram();
+    if (!depthShader->loadShaderFromFiles("shadow_depth.vert", "shadow_depth.frag")) {
+        printf("Loading shadow depth shader from files failed, using hardcoded version\n");
+        const char* vertex_shader =
+            "#version 330 core\n"
+            "layout(location=0) in vec3 vp;"
+            "uniform mat4 modelMatrix;"
+            "uniform mat4 lightSpaceMatrix;"
+            "out vec3 worldPosition;"
+            "void main() {"
+            "    vec4 wp = modelMatrix * vec4(vp, 1.0);"
+            "    worldPosition = wp.xyz;"
+            "    gl_Position = lightSpaceMatrix * wp;"
+            "}";
+
+        const char* fragment_shader =
+            "#version 330\n"
+            "in vec3 worldPosition;"
+            "uniform vec3 lightPosition;"
+            "uniform float shadowFarPlane;"
+            "void main() { gl_FragDepth = length(worldPosition - lightPosition) / shadowFarPlane; }";
+
+        if (!depthShader->loadMainShader(vertex_shader, fragment_shader)) {
+            return false;
+        }
+    }
+
+    staticCube = createCubeTexture();
+    frameCube = createCubeTexture();
+    activeCube = staticCube;
+
+    glGenFramebuffers(1, &drawFbo);
+    glGenFramebuffers(1, &readFbo);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, drawFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X, staticCube, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        printf("Error: shadow framebuffer incomplete (0x%x)\n", status);
+        return false;
+    }
+
+    glGenQueries(1, &staticQuery);
+    glGenQueries(1, &frameQuery);
+
+    printf("Shadow map initialized (%dx%d cube, far %.1f)\n", resolution, resolution, farPlane);
+    return true;
+}
+
+glm::mat4 ShadowMap::getFaceMatrix(const glm::vec3& lightPosition, int face) const {
+    static const glm::vec3 directions[6] = {
+        glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+    };
+    static const glm::vec3 ups[6] = {
+        glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+        glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)
+    };
+
+    glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane);
+    return projection * glm::lookAt(lightPosition, lightPosition + directions[face], ups[face]);
+}
+
+void ShadowMap::renderCasters(const RenderSnapshot& frame, const vector<RenderItem>& items, bool staticPass, GLuint target, bool clear) {
+    const glm::vec3& lightPosition = frame.lightPosition;
+    depthShader->use(depthShader->getProgram());
+    depthShader->SetUniform("lightPosition", lightPosition);
+    depthShader->SetUniform("shadowFarPlane", farPlane);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, drawFbo);
+    for (int face = 0; face < 6; face++) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, target, 0);
+        if (clear) {
+            glClear(GL_DEPTH_BUFFER_BIT);
+        }
+        depthShader->SetUniform("lightSpaceMatrix", getFaceMatrix(lightPosition, face));
+
+        for (const auto& item : items) {
+            if (!item.model || !item.castsShadow) continue;
+            if (item.staticObject != staticPass) continue;
+
+            depthShader->SetUniform("modelMatrix", item.matrices.model);
+            item.model->draw();
+        }
+    }
+}
+
+void ShadowMap::collectQueries() {
+    // Výsledky časovačů čteme až když jsou k dispozici, nikdy nečekáme na GPU
+    GLint available = 0;
+    if (staticQueryPending) {
+        glGetQueryObjectiv(staticQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(staticQuery, GL_QUERY_RESULT, &ns);
+            stats.lastStaticGpuMs = ns / 1.0e6;
+            staticQueryPending = false;
+        }
+    }
+    if (frameQueryPending) {
+        glGetQueryObjectiv(frameQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(frameQuery, GL_QUERY_RESULT, &ns);
+            stats.frameGpuMs = ns / 1.0e6;
+            frameQueryPending = false;
+        }
+    }
+}
+
+void ShadowMap::update(const RenderSnapshot& frame, const vector<RenderItem>& items) {
+    PROFILE_SCOPE("ShadowMap::update");
+    PROFILE_GPU_SCOPE("ShadowMap::update");
+    if (!enabled || !frame.scene || !depthShader) return;
+
+    auto frameStart = chrono::high_resolution_clock::now();
+    collectQueries();
+
+    // Otisk statických vrhačů - změní se při přidání objektu nebo změně jeho transformace
+    unsigned long long revision = frame.sceneRevision;
+    int dynamicCasters = 0;
+    for (const auto& item : items) {
+        if (!item.castsShadow) continue;
+        if (item.staticObject) {
+            revision = revision * 31 + item.revision + 1;
+        }
+        else {
+            dynamicCasters++;
+        }
+    }
+
+    glm::vec3 lightPosition = frame.lightPosition;
+    bool rebuild = !cacheValid || frame.sceneId != cachedSceneId ||
+        revision != cachedRevision || lightPosition != cachedLightPosition;
+
+    if (!rebuild && dynamicCasters == 0) {
+        // Ustálený stav - stačí vzorkovat cache
+        activeCube = staticCube;
+        stats.dynamicCasters = 0;
+        stats.frameGpuMs = 0.0;
+        stats.frameCpuMs = elapsedMs(frameStart);
+        return;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glViewport(0, 0, resolution, resolution);
+
+    if (rebuild) {
+        auto staticStart = chrono::high_resolution_clock::now();
+        bool timed = !staticQueryPending;
+        if (timed) glBeginQuery(GL_TIME_ELAPSED, staticQuery);
+
+        renderCasters(frame, items, true, staticCube, true);
+
+        if (timed) {
+            glEndQuery(GL_TIME_ELAPSED);
+            staticQueryPending = true;
+        }
+
+        cacheValid = true;
+        cachedSceneId = frame.sceneId;
+        cachedRevision = revision;
+        cachedLightPosition = lightPosition;
+        stats.staticRebuilds++;
+        stats.lastStaticCpuMs = elapsedMs(staticStart);
+    }
+
+    if (dynamicCasters > 0) {
+        bool timed = !frameQueryPending;
+        if (timed) glBeginQuery(GL_TIME_ELAPSED, frameQuery);
+
+        // Kopie cache do snímkové mapy a dokreslení dynamických vrhačů
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, readFbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFbo);
+        for (int face = 0; face < 6; face++) {
+            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, staticCube, 0);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, frameCube, 0);
+            glBlitFramebuffer(0, 0, resolution, resolution, 0, 0, resolution, resolution, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        }
+
+        renderCasters(frame, items, false, frameCube, false);
+
+        if (timed) {
+            glEndQuery(GL_TIME_ELAPSED);
+            frameQueryPending = true;
+        }
+        activeCube = frameCube;
+    }
+    else {
+        activeCube = staticCube;
+        stats.frameGpuMs = 0.0;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    stats.dynamicCasters = dynamicCasters;
+    stats.frameCpuMs = elapsedMs(frameStart);
+}
+
+void ShadowMap::bindTexture() {
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, enabled ? activeCube : 0);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void ShadowMap::applyUniforms(ShaderProgram* shader) {
+    if (!shader) return;
+
+    bindTexture();
+
+    // Shadery bez stínů (původní, konstantní) uniformy nemají
+    if (!shader->hasUniform("shadowsEnabled")) return;
+    shader->SetUniform("shadowMap", TEXTURE_UNIT);
+    shader->SetUniform("shadowFarPlane", farPlane);
+    shader->SetUniform("shadowsEnabled", enabled ? 1 : 0);
+}
+
+void ShadowMap::setEnabled(bool e) {
+    enabled = e;
+    if (enabled) {
+        cacheValid = false;
+    }
+}
+
+void ShadowMap::printStats() const {
+    printf("Shadows: rebuilds %d | last rebuild CPU %.3f ms GPU %.3f ms | per-frame CPU %.4f ms GPU %.3f ms (%d dynamic)\n",
+        stats.staticRebuilds, stats.lastStaticCpuMs, stats.lastStaticGpuMs,
+        stats.frameCpuMs, stats.frameGpuMs, stats.dynamicCasters);
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+using namespace std;
+
+class Scene;
+class ShaderProgram;
+struct RenderSnapshot;
+struct RenderItem;
+
+// Statistiky stínové mapy (časy v ms)
+struct ShadowStats {
+    int staticRebuilds;          // kolikrát se překreslila cache statických vrhačů
+    double lastStaticCpuMs;      // CPU čas posledního překreslení cache
+    double lastStaticGpuMs;      // GPU čas posledního překreslení cache
+    double frameCpuMs;           // CPU čas update() v posledním snímku
+    double frameGpuMs;           // GPU čas kompozice dynamických vrhačů
+    int dynamicCasters;          // počet dynamických vrhačů v posledním snímku
+};
+
+// Stínová cube mapa bodového světla.
+// Statické vrhače se vykreslí jednou do cache a překreslí se jen při pohybu
+// světla nebo změně statického objektu. Dynamické vrhače se každý snímek
+// dokreslí do kopie cache.
+class ShadowMap {
+private:
+    GLuint staticCube;       // cache statických vrhačů
+    GLuint frameCube;        // cache + dynamické vrhače
+    GLuint activeCube;       // textura, ze které se v tomto snímku vzorkuje
+    GLuint drawFbo;
+    GLuint readFbo;
+    GLuint staticQuery;
+    GLuint frameQuery;
+    bool staticQueryPending;
+    bool frameQueryPending;
+
+    int resolution;
+    float nearPlane;
+    float farPlane;
+    bool enabled;
+
+    ShaderProgram* depthShader;
+
+    // Stav cache
+    bool cacheValid;
+    unsigned int cachedSceneId;   // id místo ukazatele - scéna mohla být uvolněna a nová alokována na stejné adrese
+    glm::vec3 cachedLightPosition;
+    unsigned long long cachedRevision;
+
+    ShadowStats stats;
+
+    GLuint createCubeTexture();
+    glm::mat4 getFaceMatrix(const glm::vec3& lightPosition, int face) const;
+    void renderCasters(const RenderSnapshot& frame, const vector<RenderItem>& items, bool staticPass, GLuint target, bool clear);
+    void collectQueries();
+public:
+    static const int TEXTURE_UNIT = 1;
+
+    ShadowMap(int resolution = 1024, float farPlane = 50.0f);
+    ~ShadowMap();
+
+    bool initialize();
+
+    // Přestaví cache, pokud je to potřeba, a složí dynamické vrhače (render vlákno)
+    void update(const RenderSnapshot& frame, const vector<RenderItem>& items);
+    // Nastaví stínové uniformy pro daný shader
+    void applyUniforms(ShaderProgram* shader);
+    // Připojí aktivní cube mapu na TEXTURE_UNIT
+    void bindTexture();
+    // Vynutí překreslení cache v příštím snímku
+    void invalidate() { cacheValid = false; }
+
+    void setEnabled(bool e);
+    bool isEnabled() const { return enabled; }
+    float getFarPlane() const { return farPlane; }
+    const ShadowStats& getStats() const { return stats; }
+    void printStats() const;
+};
@@ -0,0 +1,465 @@
+#include "SoftwareRasterizer.h"
+#include "RenderSnapshot.h"
+#include "JobSystem.h"
+#include "FramePipeline.h"
+#include "Model.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define ZPG_USE_SSE 1
+#endif
+
+SoftwareRasterizer::SoftwareRasterizer(JobSystem* jobs)
+    : jobs(jobs), width(0), height(0), stride(0), tilesX(0), tilesY(0), materialTable(nullptr), lightPosition(0.0f), cameraPosition(0.0f) {
+    stats = SoftwareStats{ 0, 0, 0, 0, 0, 0, 0.0, 0.0 };
+}
+
+void SoftwareRasterizer::resize(int w, int h) {
+    width = max(w, 1);
+    height = max(h, 1);
+    stride = (width + 3) & ~3;
+    tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    color.assign(static_cast<size_t>(stride) * height, 0);
+    depth.assign(static_cast<size_t>(stride) * height, 1.0f);
+    tilePixels.assign(tilesX * tilesY, 0);
+    for (auto& chunk : chunks) {
+        chunk.bins.clear();
+    }
+}
+
+void SoftwareRasterizer::clear() {
+    // Jako glClear s výchozí černou a hloubkou 1
+    fill(color.begin(), color.end(), 0xFF000000u);
+    fill(depth.begin(), depth.end(), 1.0f);
+}
+
+void SoftwareRasterizer::setShading(const ShaderProgram* shader, SoftwareShading shading) {
+    for (auto& entry : shadings) {
+        if (entry.first == shader) {
+            entry.second = shading;
+            return;
+        }
+    }
+    shadings.push_back(make_pair(shader, shading));
+}
+
+void SoftwareRasterizer::render(const RenderSnapshot& frame) {
+    if (frame.viewportWidth != width || frame.viewportHeight != height) {
+        resize(frame.viewportWidth, frame.viewportHeight);
+    }
+
+    frameDraws.clear();
+    for (const auto& item : frame.items) {
+        if (!item.model || !item.shader) continue;
+
+        SoftwareDraw draw;
+        draw.vertices = item.model->getVertexData();
+        draw.vertexCount = item.model->getNumberOfVertices();
+        draw.matrices = item.matrices;
+        draw.shading = SOFTWARE_ATTRIBUTE;
+        draw.material = item.material;
+        for (const auto& entry : shadings) {
+            if (entry.first == item.shader) draw.shading = entry.second;
+        }
+        frameDraws.push_back(draw);
+    }
+    render(frameDraws, frame.lightPosition, frame.cameraPosition);
+}
+
+void SoftwareRasterizer::render(const vector<SoftwareDraw>& draws, const glm::vec3& light, const glm::vec3& camera) {
+    PROFILE_SCOPE("SoftwareRasterizer::render");
+    if (width == 0) resize(800, 600);
+    lightPosition = light;
+    cameraPosition = camera;
+    if (materialTable) frameMaterials = materialTable->getAll();
+    else frameMaterials.assign(1, MaterialTable::getDefault());
+    clear();
+
+    // Prefixové součty trojúhelníků - úseky pak nezávisí na hranicích vykreslení
+    drawOffsets.resize(draws.size() + 1);
+    drawOffsets[0] = 0;
+    for (size_t i = 0; i < draws.size(); i++) {
+        drawOffsets[i + 1] = drawOffsets[i] + draws[i].vertexCount / 3;
+    }
+    size_t total = drawOffsets.back();
+
+    int threads = jobs ? jobs->getThreadCount() : 1;
+    size_t chunkCount = (total + MIN_CHUNK_TRIANGLES - 1) / MIN_CHUNK_TRIANGLES;
+    chunkCount = max<size_t>(1, min<size_t>(chunkCount, static_cast<size_t>(threads) * 4));
+    size_t chunkSize = (total + chunkCount - 1) / chunkCount;
+    if (chunks.size() < chunkCount) chunks.resize(chunkCount);
+    int tileCount = tilesX * tilesY;
+    for (size_t c = 0; c < chunks.size(); c++) {
+        Chunk& chunk = chunks[c];
+        chunk.begin = min(total, c * chunkSize);
+        chunk.end = c < chunkCount ? min(total, chunk.begin + chunkSize) : chunk.begin;
+        chunk.triangles.clear();
+        chunk.bins.resize(tileCount);
+        for (auto& bin : chunk.bins) bin.clear();
+        chunk.culled = 0;
+        chunk.clipped = 0;
+    }
+
+    double start = FramePipeline::now();
+    {
+        PROFILE_SCOPE("SoftwareRasterizer::geometry");
+        auto geometry = [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++) processChunk(chunks[c], draws);
+        };
+        if (jobs) jobs->parallelFor(chunkCount, 1, geometry);
+        else geometry(0, chunkCount);
+    }
+    double geometryEnd = FramePipeline::now();
+    {
+        PROFILE_SCOPE("SoftwareRasterizer::raster");
+        auto raster = [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; t++) rasterizeTile(static_cast<int>(t));
+        };
+        if (jobs) jobs->parallelFor(tileCount, 1, raster);
+        else raster(0, tileCount);
+    }
+    double rasterEnd = FramePipeline::now();
+
+    stats.draws = static_cast<int>(draws.size());
+    stats.triangles = static_cast<long long>(total);
+    stats.culled = 0;
+    stats.clipped = 0;
+    stats.binned = 0;
+    stats.pixelsShaded = 0;
+    for (size_t c = 0; c < chunkCount; c++) {
+        stats.culled += chunks[c].culled;
+        stats.clipped += chunks[c].clipped;
+        for (const auto& bin : chunks[c].bins) stats.binned += bin.size();
+    }
+    for (long long pixels : tilePixels) stats.pixelsShaded += pixels;
+    stats.geometryMs = geometryEnd - start;
+    stats.rasterMs = rasterEnd - geometryEnd;
+}
+
+void SoftwareRasterizer::processChunk(Chunk& chunk, const vector<SoftwareDraw>& draws) {
+    if (chunk.begin >= chunk.end) return;
+    size_t d = upper_bound(drawOffsets.begin(), drawOffsets.end(), chunk.begin) - drawOffsets.begin() - 1;
+
+    ClipVertex in[3];
+    for (size_t t = chunk.begin; t < chunk.end; t++) {
+        while (t >= drawOffsets[d + 1]) d++;
+        const SoftwareDraw& draw = draws[d];
+        const float* v = draw.vertices + (t - drawOffsets[d]) * 18;
+
+        // Vertex shader nejdřív jen pro pozice - většina trojúhelníků se zahodí
+        unsigned int outside[6] = { 0, 0, 0, 0, 0, 0 };
+        for (int i = 0; i < 3; i++) {
+            const glm::vec4 c = draw.matrices.mvp * glm::vec4(v[i * 6], v[i * 6 + 1], v[i * 6 + 2], 1.0f);
+            in[i].position = c;
+            outside[0] += c.x < -c.w;
+            outside[1] += c.x > c.w;
+            outside[2] += c.y < -c.w;
+            outside[3] += c.y > c.w;
+            outside[4] += c.z < -c.w;
+            outside[5] += c.z > c.w;
+        }
+
+        // Celý za jednou rovinou frusta
+        bool rejected = false;
+        for (int p = 0; p < 6; p++) rejected |= outside[p] == 3;
+        if (!rejected && outside[4] == 0) {
+            // Bez středu pixelu v obálce (vzdálené drobné trojúhelníky) nebo degenerovaný
+            float sx[3], sy[3];
+            for (int i = 0; i < 3; i++) {
+                float invW = 1.0f / in[i].position.w;
+                sx[i] = (in[i].position.x * invW * 0.5f + 0.5f) * width;
+                sy[i] = (in[i].position.y * invW * 0.5f + 0.5f) * height;
+            }
+            float area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sx[2] - sx[0]) * (sy[1] - sy[0]);
+            rejected = fabs(area) < 1e-8f ||
+                ceil(min(sx[0], min(sx[1], sx[2])) - 0.5f) > floor(max(sx[0], max(sx[1], sx[2])) - 0.5f) ||
+                ceil(min(sy[0], min(sy[1], sy[2])) - 0.5f) > floor(max(sy[0], max(sy[1], sy[2])) - 0.5f);
+        }
+        if (rejected) {
+            chunk.culled++;
+            continue;
+        }
+
+        // Atributy jen pro trojúhelníky, které se budou rasterizovat
+        for (int i = 0; i < 3; i++) {
+            glm::vec4 p(v[i * 6], v[i * 6 + 1], v[i * 6 + 2], 1.0f);
+            glm::vec3 a(v[i * 6 + 3], v[i * 6 + 4], v[i * 6 + 5]);
+            glm::vec4 world = draw.matrices.model * p;
+            in[i].world = glm::vec3(world.x, world.y, world.z);
+            in[i].attribute = draw.shading == SOFTWARE_ATTRIBUTE ? a : draw.matrices.normal * a;
+        }
+        if (outside[4] == 0) {
+            emitTriangle(chunk, in, draw);
+            continue;
+        }
+
+        // Sutherland-Hodgman proti blízké rovině z >= -w, vznikne 3- nebo 4-úhelník
+        ClipVertex polygon[4];
+        int count = 0;
+        for (int i = 0; i < 3; i++) {
+            const ClipVertex& a = in[i];
+            const ClipVertex& b = in[(i + 1) % 3];
+            float da = a.position.z + a.position.w;
+            float db = b.position.z + b.position.w;
+            if (da >= 0.0f) polygon[count++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f)) {
+                float s = da / (da - db);
+                ClipVertex& o = polygon[count++];
+                o.position = a.position + (b.position - a.position) * s;
+                o.world = a.world + (b.world - a.world) * s;
+                o.attribute = a.attribute + (b.attribute - a.attribute) * s;
+            }
+        }
+        chunk.clipped++;
+        if (count >= 3) emitTriangle(chunk, polygon, draw);
+        if (count == 4) {
+            ClipVertex second[3] = { polygon[0], polygon[2], polygon[3] };
+            emitTriangle(chunk, second, draw);
+        }
+    }
+}
+
+void SoftwareRasterizer::emitTriangle(Chunk& chunk, const ClipVertex* vertices, const SoftwareDraw& draw) {
+    Triangle triangle;
+    for (int i = 0; i < 3; i++) {
+        const ClipVertex& c = vertices[i];
+        ScreenVertex& s = triangle.v[i];
+        s.invW = 1.0f / c.position.w;
+        s.x = (c.position.x * s.invW * 0.5f + 0.5f) * width;
+        s.y = (c.position.y * s.invW * 0.5f + 0.5f) * height;
+        s.z = c.position.z * s.invW * 0.5f + 0.5f;
+        s.world = c.world * s.invW;
+        s.attribute = c.attribute * s.invW;
+    }
+
+    // Bez ořezu odvrácených stěn (GL_CULL_FACE se nepoužívá), jen sjednocení orientace
+    float area = (triangle.v[1].x - triangle.v[0].x) * (triangle.v[2].y - triangle.v[0].y) -
+        (triangle.v[2].x - triangle.v[0].x) * (triangle.v[1].y - triangle.v[0].y);
+    if (fabs(area) < 1e-8f) {
+        chunk.culled++;
+        return;
+    }
+    if (area < 0.0f) {
+        swap(triangle.v[1], triangle.v[2]);
+        area = -area;
+    }
+    triangle.invArea = 1.0f / area;
+    triangle.shading = draw.shading;
+    triangle.material = draw.material < frameMaterials.size() ? draw.material : MaterialTable::DEFAULT_MATERIAL;
+
+    // Pixely, jejichž střed leží v obálce; malé vzdálené trojúhelníky často žádný nemají
+    float minX = min(triangle.v[0].x, min(triangle.v[1].x, triangle.v[2].x));
+    float maxX = max(triangle.v[0].x, max(triangle.v[1].x, triangle.v[2].x));
+    float minY = min(triangle.v[0].y, min(triangle.v[1].y, triangle.v[2].y));
+    float maxY = max(triangle.v[0].y, max(triangle.v[1].y, triangle.v[2].y));
+    int x0 = max(0, static_cast<int>(ceil(minX - 0.5f)));
+    int x1 = min(width - 1, static_cast<int>(floor(maxX - 0.5f)));
+    int y0 = max(0, static_cast<int>(ceil(minY - 0.5f)));
+    int y1 = min(height - 1, static_cast<int>(floor(maxY - 0.5f)));
+    if (x0 > x1 || y0 > y1) {
+        chunk.culled++;
+        return;
+    }
+
+    int index = static_cast<int>(chunk.triangles.size());
+    chunk.triangles.push_back(triangle);
+    for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ty++) {
+        for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++) {
+            chunk.bins[ty * tilesX + tx].push_back(index);
+        }
+    }
+}
+
+void SoftwareRasterizer::rasterizeTile(int tile) {
+    int x0 = (tile % tilesX) * TILE_SIZE;
+    int y0 = (tile / tilesX) * TILE_SIZE;
+    int x1 = min(x0 + TILE_SIZE, width);
+    int y1 = min(y0 + TILE_SIZE, height);
+
+    // Pořadí úseků = pořadí odeslání, výsledek nezávisí na počtu vláken
+    long long pixels = 0;
+    for (const auto& chunk : chunks) {
+        if (chunk.begin >= chunk.end) continue;
+        for (int index : chunk.bins[tile]) {
+            pixels += rasterizeTriangle(chunk.triangles[index], x0, y0, x1, y1);
+        }
+    }
+    tilePixels[tile] = pixels;
+}
+
+long long SoftwareRasterizer::rasterizeTriangle(const Triangle& t, int tileX0, int tileY0, int tileX1, int tileY1) {
+    const ScreenVertex& v0 = t.v[0];
+    const ScreenVertex& v1 = t.v[1];
+    const ScreenVertex& v2 = t.v[2];
+
+    // Hranové funkce e(x, y) = A * x + B * y + C; e0 je váha v0 (hrana v1 -> v2) atd.
+    float a0 = v1.y - v2.y, b0 = v2.x - v1.x, c0 = (v2.y - v1.y) * v1.x - (v2.x - v1.x) * v1.y;
+    float a1 = v2.y - v0.y, b1 = v0.x - v2.x, c1 = (v0.y - v2.y) * v2.x - (v0.x - v2.x) * v2.y;
+    float a2 = v0.y - v1.y, b2 = v1.x - v0.x, c2 = (v1.y - v0.y) * v0.x - (v1.x - v0.x) * v0.y;
+
+    float minX = min(v0.x, min(v1.x, v2.x));
+    float maxX = max(v0.x, max(v1.x, v2.x));
+    float minY = min(v0.y, min(v1.y, v2.y));
+    float maxY = max(v0.y, max(v1.y, v2.y));
+    int x0 = max(tileX0, static_cast<int>(ceil(minX - 0.5f)));
+    int x1 = min(tileX1 - 1, static_cast<int>(floor(maxX - 0.5f)));
+    int y0 = max(tileY0, static_cast<int>(ceil(minY - 0.5f)));
+    int y1 = min(tileY1 - 1, static_cast<int>(floor(maxY - 0.5f)));
+    if (x0 > x1 || y0 > y1) return 0;
+
+    float dz1 = (v1.z - v0.z) * t.invArea;
+    float dz2 = (v2.z - v0.z) * t.invArea;
+    long long shaded = 0;
+
+#ifdef ZPG_USE_SSE
+    // Skupiny 4 pixelů zarovnané na 4 (dlaždice i stride jsou násobky 4)
+    x0 &= ~3;
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 limit = _mm_set1_ps(static_cast<float>(x1 + 1));
+    const __m128 A0 = _mm_set1_ps(a0), A1 = _mm_set1_ps(a1), A2 = _mm_set1_ps(a2);
+    const __m128 step0 = _mm_set1_ps(a0 * 4.0f), step1 = _mm_set1_ps(a1 * 4.0f), step2 = _mm_set1_ps(a2 * 4.0f);
+    const __m128 Z0 = _mm_set1_ps(v0.z), DZ1 = _mm_set1_ps(dz1), DZ2 = _mm_set1_ps(dz2);
+    const __m128 invArea = _mm_set1_ps(t.invArea);
+
+    for (int y = y0; y <= y1; y++) {
+        float py = y + 0.5f;
+        __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x0)), offsets);
+        __m128 e0 = _mm_add_ps(_mm_mul_ps(A0, px), _mm_set1_ps(b0 * py + c0));
+        __m128 e1 = _mm_add_ps(_mm_mul_ps(A1, px), _mm_set1_ps(b1 * py + c1));
+        __m128 e2 = _mm_add_ps(_mm_mul_ps(A2, px), _mm_set1_ps(b2 * py + c2));
+        float* depthRow = &depth[static_cast<size_t>(y) * stride];
+        unsigned int* colorRow = &color[static_cast<size_t>(y) * stride];
+
+        for (int x = x0; x <= x1; x += 4) {
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                _mm_and_ps(_mm_cmpge_ps(e2, zero), _mm_cmplt_ps(px, limit)));
+            if (_mm_movemask_ps(inside)) {
+                __m128 l1 = _mm_mul_ps(e1, invArea);
+                __m128 l2 = _mm_mul_ps(e2, invArea);
+                __m128 z = _mm_add_ps(Z0, _mm_add_ps(_mm_mul_ps(DZ1, e1), _mm_mul_ps(DZ2, e2)));
+                __m128 old = _mm_loadu_ps(depthRow + x);
+                __m128 pass = _mm_and_ps(inside, _mm_cmplt_ps(z, old));
+                int mask = _mm_movemask_ps(pass);
+                if (mask) {
+                    _mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, old)));
+                    float w1[4], w2[4];
+                    _mm_storeu_ps(w1, l1);
+                    _mm_storeu_ps(w2, l2);
+                    for (int i = 0; i < 4; i++) {
+                        if (mask & (1 << i)) {
+                            colorRow[x + i] = shade(t, w1[i], w2[i]);
+                            shaded++;
+                        }
+                    }
+                }
+            }
+            e0 = _mm_add_ps(e0, step0);
+            e1 = _mm_add_ps(e1, step1);
+            e2 = _mm_add_ps(e2, step2);
+            px = _mm_add_ps(px, _mm_set1_ps(4.0f));
+        }
+    }
+#else
+    for (int y = y0; y <= y1; y++) {
+        float py = y + 0.5f;
+        float* depthRow = &depth[static_cast<size_t>(y) * stride];
+        unsigned int* colorRow = &color[static_cast<size_t>(y) * stride];
+        for (int x = x0; x <= x1; x++) {
+            float px = x + 0.5f;
+            float e0 = a0 * px + b0 * py + c0;
+            float e1 = a1 * px + b1 * py + c1;
+            float e2 = a2 * px + b2 * py + c2;
+            if (e0 < 0.0f || e1 < 0.0f || e2 < 0.0f) continue;
+
+            float z = v0.z + dz1 * e1 + dz2 * e2;
+            if (z >= depthRow[x]) continue;
+            depthRow[x] = z;
+            colorRow[x] = shade(t, e1 * t.invArea, e2 * t.invArea);
+            shaded++;
+        }
+    }
+#endif
+    return shaded;
+}
+
+unsigned int SoftwareRasterizer::shade(const Triangle& t, float l1, float l2) const {
+    // Perspektivně správná interpolace: atributy/w lineárně, pak dělení interpolovaným 1/w
+    float l0 = 1.0f - l1 - l2;
+    float invW = t.v[0].invW * l0 + t.v[1].invW * l1 + t.v[2].invW * l2;
+    float w = 1.0f / invW;
+    glm::vec3 attribute = (t.v[0].attribute * l0 + t.v[1].attribute * l1 + t.v[2].attribute * l2) * w;
+
+    // Stejný výpočet jako *.frag
+    const Material& material = frameMaterials[t.material];
+    const glm::vec3 objectColor(material.diffuse);
+    glm::vec3 result;
+    if (t.shading == SOFTWARE_ATTRIBUTE) {
+        result = attribute;
+    }
+    else if (t.shading == SOFTWARE_CONSTANT) {
+        result = objectColor;
+    }
+    else {
+        glm::vec3 world = (t.v[0].world * l0 + t.v[1].world * l1 + t.v[2].world * l2) * w;
+        glm::vec3 norm = glm::normalize(attribute);
+        glm::vec3 lightDir = glm::normalize(lightPosition - world);
+        float diff = max(glm::dot(norm, lightDir), 0.0f);
+        result = glm::vec3(material.ambient) + objectColor * diff;
+
+        if (t.shading != SOFTWARE_LAMBERT) {
+            glm::vec3 viewDir = glm::normalize(cameraPosition - world);
+            float spec;
+            if (t.shading == SOFTWARE_PHONG) {
+                glm::vec3 reflectDir = glm::reflect(-lightDir, norm);
+                spec = pow(max(glm::dot(viewDir, reflectDir), 0.0f), material.specular.w);
+            }
+            else {
+                glm::vec3 halfDir = glm::normalize(lightDir + viewDir);
+                spec = pow(max(glm::dot(norm, halfDir), 0.0f), material.specular.w);
+            }
+            result += glm::vec3(material.specular) * spec;
+        }
+    }
+
+    unsigned int r = static_cast<unsigned int>(min(max(result.x, 0.0f), 1.0f) * 255.0f + 0.5f);
+    unsigned int g = static_cast<unsigned int>(min(max(result.y, 0.0f), 1.0f) * 255.0f + 0.5f);
+    unsigned int b = static_cast<unsigned int>(min(max(result.z, 0.0f), 1.0f) * 255.0f + 0.5f);
+    return 0xFF000000u | (b << 16) | (g << 8) | r;
+}
+
+bool SoftwareRasterizer::writePPM(const char* path) const {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        printf("Cannot write image %s\n", path);
+        return false;
+    }
+
+    // PPM je shora dolů, buffer zdola nahoru
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    vector<unsigned char> row(static_cast<size_t>(width) * 3);
+    for (int y = height - 1; y >= 0; y--) {
+        const unsigned int* src = &color[static_cast<size_t>(y) * stride];
+        for (int x = 0; x < width; x++) {
+            row[x * 3] = src[x] & 0xFF;
+            row[x * 3 + 1] = (src[x] >> 8) & 0xFF;
+            row[x * 3 + 2] = (src[x] >> 16) & 0xFF;
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    fclose(file);
+    printf("Wrote %s (%dx%d)\n", path, width, height);
+    return true;
+}
+
+void SoftwareRasterizer::printStats() const {
+    printf("Software rasterizer: %d draws, %lld triangles (%lld culled, %lld near-clipped), %lld tile bins, "
+        "%lld pixels shaded, geometry %.2f ms, raster %.2f ms\n",
+        stats.draws, stats.triangles, stats.culled, stats.clipped, stats.binned, stats.pixelsShaded,
+        stats.geometryMs, stats.rasterMs);
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include "MatrixBatch.h"
+#include "MaterialTable.h"
+
+using namespace std;
+
+class JobSystem;
+class ShaderProgram;
+struct RenderSnapshot;
+
+// Osvětlovací modely shaderů přepsané do C++ (bez stínů)
+enum SoftwareShading {
+    SOFTWARE_ATTRIBUTE,      // původní shader - atribut location 1 jako barva
+    SOFTWARE_CONSTANT,
+    SOFTWARE_LAMBERT,
+    SOFTWARE_PHONG,
+    SOFTWARE_BLINN
+};
+
+// Jedno vykreslení: data ve formátu Model (6 floatů na vrchol), matice z MatrixBatch
+struct SoftwareDraw {
+    const float* vertices;
+    int vertexCount;
+    ObjectMatrices matrices;
+    SoftwareShading shading;
+    unsigned short material;     // index do MaterialTable
+};
+
+// Statistiky posledního snímku
+struct SoftwareStats {
+    int draws;
+    long long triangles;         // vstupní trojúhelníky
+    long long culled;            // mimo frustum, degenerované nebo bez pokrytého pixelu
+    long long clipped;           // oříznuté blízkou rovinou
+    long long binned;            // odkazy trojúhelník -> dlaždice
+    long long pixelsShaded;
+    double geometryMs;
+    double rasterMs;
+};
+
+// Softwarový rasterizér bez GPU (CI a render uzly bez grafické karty).
+// Geometrie: trojúhelníky se rozdělí na úseky, každá úloha je transformuje,
+// ořízne blízkou rovinou a roztřídí do přihrádek dlaždic TILE_SIZE x TILE_SIZE.
+// Rasterizace: úloha na dlaždici projde přihrádky všech úseků v pořadí odeslání,
+// hranové funkce a hloubkový test počítá po 4 pixelech (SSE), stínuje se po pixelu.
+// Dlaždice se nepřekrývají, takže zápisy do bufferů nepotřebují synchronizaci.
+class SoftwareRasterizer {
+private:
+    static const int TILE_SIZE = 64;             // násobek 4 - skupiny pixelů nepřesahují dlaždici
+    static const int MIN_CHUNK_TRIANGLES = 2048;
+
+    // Vrchol na obrazovce: pixely, hloubka 0..1, 1/w a atributy vynásobené 1/w
+    struct ScreenVertex {
+        float x, y, z, invW;
+        glm::vec3 world;
+        glm::vec3 attribute;
+    };
+
+    struct Triangle {
+        ScreenVertex v[3];
+        float invArea;
+        SoftwareShading shading;
+        unsigned short material;     // platný index do frameMaterials
+    };
+
+    // Úsek trojúhelníků jedné úlohy s vlastními přihrádkami (bez zámků)
+    struct Chunk {
+        size_t begin;
+        size_t end;
+        vector<Triangle> triangles;
+        vector<vector<int>> bins;
+        long long culled;
+        long long clipped;
+    };
+
+    struct ClipVertex {
+        glm::vec4 position;
+        glm::vec3 world;
+        glm::vec3 attribute;
+    };
+
+    JobSystem* jobs;
+    int width;
+    int height;
+    int stride;                  // šířka zarovnaná na 4 (SSE čte celé skupiny)
+    int tilesX;
+    int tilesY;
+    vector<unsigned int> color;  // RGBA8, řádky zdola nahoru jako v GL
+    vector<float> depth;
+
+    vector<SoftwareDraw> frameDraws;
+    vector<size_t> drawOffsets;  // první trojúhelník každého vykreslení
+    vector<Chunk> chunks;
+    vector<long long> tilePixels;
+    vector<pair<const ShaderProgram*, SoftwareShading>> shadings;
+    const MaterialTable* materialTable;
+    vector<Material> frameMaterials;     // kopie tabulky pro snímek (tabulka se může měnit)
+    glm::vec3 lightPosition;
+    glm::vec3 cameraPosition;
+
+    SoftwareStats stats;
+
+    void processChunk(Chunk& chunk, const vector<SoftwareDraw>& draws);
+    void emitTriangle(Chunk& chunk, const ClipVertex* vertices, const SoftwareDraw& draw);
+    void rasterizeTile(int tile);
+    long long rasterizeTriangle(const Triangle& triangle, int x0, int y0, int x1, int y1);
+    unsigned int shade(const Triangle& triangle, float l1, float l2) const;
+public:
+    // jobs == nullptr = vše ve volajícím vlákně
+    SoftwareRasterizer(JobSystem* jobs = nullptr);
+
+    void resize(int width, int height);
+    void clear();
+
+    // Shader scény -> osvětlovací model (neznámý = SOFTWARE_ATTRIBUTE)
+    void setShading(const ShaderProgram* shader, SoftwareShading shading);
+    // Materiály objektů (nullptr = všude výchozí materiál)
+    void setMaterials(const MaterialTable* table) { materialTable = table; }
+    // Položky snímku se stejnými maticemi jako GL cesta (draw list se nepoužívá)
+    void render(const RenderSnapshot& frame);
+    void render(const vector<SoftwareDraw>& draws, const glm::vec3& lightPosition, const glm::vec3& cameraPosition);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    // Řádek má getStride() pixelů, platných je prvních getWidth()
+    int getStride() const { return stride; }
+    const vector<unsigned int>& getColorBuffer() const { return color; }
+    bool writePPM(const char* path) const;
+
+    const SoftwareStats& getStats() const { return stats; }
+    void printStats() const;
+};
@@ -16,4 +16,5 @@ public:
     void removeTransform(CompositeTransform* transform);
     // Vynásobí child matice dohromady
     glm::mat4 getMatrix() const override;
+    const vector<CompositeTransform*>& getChildren() const { return children; }
 };
\ No newline at end of file
@@ -10,4 +10,5 @@ public:
     Translation(float x, float y, float z);
     // Implementace virtuální metody
     glm::mat4 getMatrix() const override;
+    const glm::vec3& getTranslation() const { return translation; }
 };
\ No newline at end of file
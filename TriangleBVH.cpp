@@ -0,0 +1,359 @@
+#include "TriangleBVH.h"
+#include "FramePipeline.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define ZPG_USE_SSE 1
+#endif
+
+static float surfaceArea(const glm::vec3& minimum, const glm::vec3& maximum) {
+    glm::vec3 e = maximum - minimum;
+    return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+// Möller-Trumbore pro jeden trojúhelník (v0 + hrany e1, e2)
+static bool intersectTriangle(const glm::vec3& v0, const glm::vec3& e1, const glm::vec3& e2,
+    const glm::vec3& origin, const glm::vec3& direction, float& t) {
+    glm::vec3 p = glm::cross(direction, e2);
+    float det = glm::dot(e1, p);
+    if (std::fabs(det) <= 1e-12f) return false;
+    float invDet = 1.0f / det;
+
+    glm::vec3 s = origin - v0;
+    float u = glm::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) return false;
+    glm::vec3 q = glm::cross(s, e1);
+    float v = glm::dot(direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    t = glm::dot(e2, q) * invDet;
+    return t > 0.0f;
+}
+
+TriangleBVH::TriangleBVH(const float* vertices, int vertexCount, int stride) : triangleCount(vertexCount / 3), buildMs(0.0) {
+    PROFILE_SCOPE("TriangleBVH::build");
+    double start = FramePipeline::now();
+    if (triangleCount == 0) return;
+
+    vector<BuildTriangle> triangles(triangleCount);
+    vector<int> order(triangleCount);
+    for (int i = 0; i < triangleCount; i++) {
+        const float* a = vertices + (i * 3) * stride;
+        const float* b = vertices + (i * 3 + 1) * stride;
+        const float* c = vertices + (i * 3 + 2) * stride;
+        glm::vec3 p0(a[0], a[1], a[2]);
+        glm::vec3 p1(b[0], b[1], b[2]);
+        glm::vec3 p2(c[0], c[1], c[2]);
+        triangles[i].minimum = glm::min(p0, glm::min(p1, p2));
+        triangles[i].maximum = glm::max(p0, glm::max(p1, p2));
+        triangles[i].centroid = (p0 + p1 + p2) * (1.0f / 3.0f);
+        order[i] = i;
+    }
+
+    // Horní odhad: 2n - 1 uzlů, (n + 3) / 4 paketů
+    nodes.reserve(2 * triangleCount);
+    packets.reserve((triangleCount + LEAF_SIZE - 1) / LEAF_SIZE * 2);
+    nodes.resize(1);
+    build(vertices, stride, triangles, order, 0, 0, triangleCount, 0);
+    buildMs = FramePipeline::now() - start;
+}
+
+void TriangleBVH::build(const float* vertices, int stride, vector<BuildTriangle>& triangles, vector<int>& order,
+    unsigned int nodeIndex, int begin, int end, int depth) {
+    glm::vec3 boundsMin = triangles[order[begin]].minimum;
+    glm::vec3 boundsMax = triangles[order[begin]].maximum;
+    glm::vec3 centroidMin = triangles[order[begin]].centroid;
+    glm::vec3 centroidMax = centroidMin;
+    for (int i = begin + 1; i < end; i++) {
+        const BuildTriangle& tri = triangles[order[i]];
+        boundsMin = glm::min(boundsMin, tri.minimum);
+        boundsMax = glm::max(boundsMax, tri.maximum);
+        centroidMin = glm::min(centroidMin, tri.centroid);
+        centroidMax = glm::max(centroidMax, tri.centroid);
+    }
+
+    Node& node = nodes[nodeIndex];
+    for (int axis = 0; axis < 3; axis++) {
+        node.minimum[axis] = boundsMin[axis];
+        node.maximum[axis] = boundsMax[axis];
+    }
+
+    int count = end - begin;
+    // Hloubka je omezená zásobníkem průchodu
+    if (count <= LEAF_SIZE || depth >= STACK_SIZE - 1) {
+        makeLeaf(vertices, stride, order, nodeIndex, begin, end);
+        return;
+    }
+
+    // SAH přes BINS přihrádek podle těžiště na každé ose
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float bestCost = FLT_MAX;
+    for (int axis = 0; axis < 3; axis++) {
+        float extent = centroidMax[axis] - centroidMin[axis];
+        if (extent <= 0.0f) continue;
+        float scale = BINS / extent;
+
+        int binCount[BINS] = {};
+        glm::vec3 binMin[BINS], binMax[BINS];
+        for (int i = begin; i < end; i++) {
+            const BuildTriangle& tri = triangles[order[i]];
+            int bin = min(BINS - 1, static_cast<int>((tri.centroid[axis] - centroidMin[axis]) * scale));
+            binMin[bin] = binCount[bin] ? glm::min(binMin[bin], tri.minimum) : tri.minimum;
+            binMax[bin] = binCount[bin] ? glm::max(binMax[bin], tri.maximum) : tri.maximum;
+            binCount[bin]++;
+        }
+
+        // Zleva a zprava kumulované plochy, rovina za přihrádkou split
+        float leftArea[BINS - 1];
+        int leftCount[BINS - 1];
+        glm::vec3 accMin(FLT_MAX), accMax(-FLT_MAX);
+        int accCount = 0;
+        for (int b = 0; b < BINS - 1; b++) {
+            if (binCount[b]) {
+                accMin = glm::min(accMin, binMin[b]);
+                accMax = glm::max(accMax, binMax[b]);
+                accCount += binCount[b];
+            }
+            leftArea[b] = accCount ? surfaceArea(accMin, accMax) : 0.0f;
+            leftCount[b] = accCount;
+        }
+        accMin = glm::vec3(FLT_MAX);
+        accMax = glm::vec3(-FLT_MAX);
+        accCount = 0;
+        for (int b = BINS - 1; b > 0; b--) {
+            if (binCount[b]) {
+                accMin = glm::min(accMin, binMin[b]);
+                accMax = glm::max(accMax, binMax[b]);
+                accCount += binCount[b];
+            }
+            if (leftCount[b - 1] == 0 || accCount == 0) continue;
+            float cost = leftArea[b - 1] * leftCount[b - 1] + surfaceArea(accMin, accMax) * accCount;
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b;
+            }
+        }
+    }
+
+    // Cena průchodu 1, trojúhelníku 1 (relativně k ploše rodiče)
+    float parentArea = surfaceArea(boundsMin, boundsMax);
+    bool splitWorthIt = bestAxis >= 0 && (parentArea <= 0.0f || 1.0f + bestCost / parentArea < count);
+    if (!splitWorthIt && count <= MAX_LEAF_SIZE) {
+        makeLeaf(vertices, stride, order, nodeIndex, begin, end);
+        return;
+    }
+
+    int middle = begin;
+    if (bestAxis >= 0) {
+        float scale = BINS / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+        float minimum = centroidMin[bestAxis];
+        middle = static_cast<int>(partition(order.begin() + begin, order.begin() + end, [&](int i) {
+            int bin = min(BINS - 1, static_cast<int>((triangles[i].centroid[bestAxis] - minimum) * scale));
+            return bin < bestSplit;
+        }) - order.begin());
+    }
+    // Stejná těžiště (nebo nepoužitelné dělení) - půlení podle pořadí
+    if (middle == begin || middle == end) {
+        middle = begin + count / 2;
+    }
+
+    // Sourozenci vedle sebe; node může po resize ukazovat jinam
+    unsigned int left = static_cast<unsigned int>(nodes.size());
+    nodes.resize(nodes.size() + 2);
+    nodes[nodeIndex].first = left;
+    nodes[nodeIndex].count = 0;
+    build(vertices, stride, triangles, order, left, begin, middle, depth + 1);
+    build(vertices, stride, triangles, order, left + 1, middle, end, depth + 1);
+}
+
+void TriangleBVH::makeLeaf(const float* vertices, int stride, const vector<int>& order, unsigned int nodeIndex, int begin, int end) {
+    Node& node = nodes[nodeIndex];
+    node.first = static_cast<unsigned int>(packets.size());
+    node.count = 0;
+
+    for (int i = begin; i < end; i += 4) {
+        TrianglePacket packet = {};
+        for (int lane = 0; lane < 4; lane++) {
+            if (i + lane >= end) {
+                packet.ids[lane] = -1;
+                continue;
+            }
+            int tri = order[i + lane];
+            const float* a = vertices + (tri * 3) * stride;
+            const float* b = vertices + (tri * 3 + 1) * stride;
+            const float* c = vertices + (tri * 3 + 2) * stride;
+            for (int axis = 0; axis < 3; axis++) {
+                packet.v0[axis][lane] = a[axis];
+                packet.e1[axis][lane] = b[axis] - a[axis];
+                packet.e2[axis][lane] = c[axis] - a[axis];
+            }
+            packet.ids[lane] = tri;
+        }
+        packets.push_back(packet);
+        node.count++;
+    }
+}
+
+void TriangleBVH::intersectPacket(const TrianglePacket& packet, const glm::vec3& origin, const glm::vec3& direction,
+    RayHit& hit) {
+#ifdef ZPG_USE_SSE
+    // Möller-Trumbore pro 4 trojúhelníky najednou
+    __m128 dx = _mm_set1_ps(direction.x), dy = _mm_set1_ps(direction.y), dz = _mm_set1_ps(direction.z);
+    __m128 e1x = _mm_load_ps(packet.e1[0]), e1y = _mm_load_ps(packet.e1[1]), e1z = _mm_load_ps(packet.e1[2]);
+    __m128 e2x = _mm_load_ps(packet.e2[0]), e2y = _mm_load_ps(packet.e2[1]), e2z = _mm_load_ps(packet.e2[2]);
+
+    // p = d x e2, det = e1 . p
+    __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+    __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+
+    // s = o - v0, u = s . p
+    __m128 sx = _mm_sub_ps(_mm_set1_ps(origin.x), _mm_load_ps(packet.v0[0]));
+    __m128 sy = _mm_sub_ps(_mm_set1_ps(origin.y), _mm_load_ps(packet.v0[1]));
+    __m128 sz = _mm_sub_ps(_mm_set1_ps(origin.z), _mm_load_ps(packet.v0[2]));
+    __m128 u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz));
+
+    // q = s x e1, v = d . q, t = e2 . q
+    __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+    __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+    __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+    __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz));
+    __m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz));
+
+    // Prázdné místo v paketu má det = 0 a neprojde prvním testem
+    __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+    u = _mm_mul_ps(u, invDet);
+    v = _mm_mul_ps(v, invDet);
+    t = _mm_mul_ps(t, invDet);
+
+    __m128 zero = _mm_setzero_ps();
+    __m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+    __m128 mask = _mm_cmpgt_ps(absDet, _mm_set1_ps(1e-12f));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+    mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+    mask = _mm_and_ps(mask, _mm_cmpgt_ps(t, zero));
+    mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(hit.t)));
+
+    int bits = _mm_movemask_ps(mask);
+    if (!bits) return;
+    alignas(16) float ts[4];
+    _mm_store_ps(ts, t);
+    for (int lane = 0; lane < 4; lane++) {
+        if ((bits & (1 << lane)) && ts[lane] < hit.t) {
+            hit.t = ts[lane];
+            hit.triangle = packet.ids[lane];
+        }
+    }
+#else
+    for (int lane = 0; lane < 4; lane++) {
+        if (packet.ids[lane] < 0) continue;
+        glm::vec3 v0(packet.v0[0][lane], packet.v0[1][lane], packet.v0[2][lane]);
+        glm::vec3 e1(packet.e1[0][lane], packet.e1[1][lane], packet.e1[2][lane]);
+        glm::vec3 e2(packet.e2[0][lane], packet.e2[1][lane], packet.e2[2][lane]);
+        float t;
+        if (intersectTriangle(v0, e1, e2, origin, direction, t) && t < hit.t) {
+            hit.t = t;
+            hit.triangle = packet.ids[lane];
+        }
+    }
+#endif
+}
+
+// Vstupní t do AABB uzlu, FLT_MAX = mine nebo až za maxT
+static float intersectNode(const TriangleBVH::Node& node, const glm::vec3& origin, const glm::vec3& invDirection, float maxT) {
+    float tMin = 0.0f;
+    float tMax = maxT;
+    for (int axis = 0; axis < 3; axis++) {
+        float t1 = (node.minimum[axis] - origin[axis]) * invDirection[axis];
+        float t2 = (node.maximum[axis] - origin[axis]) * invDirection[axis];
+        tMin = max(tMin, min(t1, t2));
+        tMax = min(tMax, max(t1, t2));
+    }
+    return tMin <= tMax ? tMin : FLT_MAX;
+}
+
+RayHit TriangleBVH::intersect(const glm::vec3& origin, const glm::vec3& direction, float maxT) const {
+    RayHit hit;
+    hit.t = maxT;
+    hit.triangle = -1;
+    if (nodes.empty()) return hit;
+
+    glm::vec3 invDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    if (intersectNode(nodes[0], origin, invDirection, hit.t) == FLT_MAX) return hit;
+
+    // Zásobník vzdálenějších sourozenců se vstupním t (přeskočí se, pokud už je zásah blíž)
+    unsigned int stack[STACK_SIZE];
+    float stackT[STACK_SIZE];
+    int top = 0;
+    unsigned int index = 0;
+
+    while (true) {
+        const Node& node = nodes[index];
+        if (node.count) {
+            for (unsigned int p = 0; p < node.count; p++) {
+                intersectPacket(packets[node.first + p], origin, direction, hit);
+            }
+        }
+        else {
+            unsigned int nearChild = node.first;
+            unsigned int farChild = node.first + 1;
+            float nearT = intersectNode(nodes[nearChild], origin, invDirection, hit.t);
+            float farT = intersectNode(nodes[farChild], origin, invDirection, hit.t);
+            if (farT < nearT) {
+                swap(nearChild, farChild);
+                swap(nearT, farT);
+            }
+            if (nearT != FLT_MAX) {
+                if (farT != FLT_MAX) {
+                    stack[top] = farChild;
+                    stackT[top] = farT;
+                    top++;
+                }
+                index = nearChild;
+                continue;
+            }
+        }
+
+        // Další čekající uzel, který může být blíž než dosavadní zásah
+        bool found = false;
+        while (top > 0) {
+            top--;
+            if (stackT[top] < hit.t) {
+                index = stack[top];
+                found = true;
+                break;
+            }
+        }
+        if (!found) break;
+    }
+    return hit;
+}
+
+RayHit TriangleBVH::intersectBruteForce(const float* vertices, int vertexCount, int stride,
+    const glm::vec3& origin, const glm::vec3& direction, float maxT) {
+    RayHit hit;
+    hit.t = maxT;
+    hit.triangle = -1;
+    for (int tri = 0; tri < vertexCount / 3; tri++) {
+        const float* a = vertices + (tri * 3) * stride;
+        const float* b = vertices + (tri * 3 + 1) * stride;
+        const float* c = vertices + (tri * 3 + 2) * stride;
+        glm::vec3 v0(a[0], a[1], a[2]);
+        glm::vec3 e1(b[0] - a[0], b[1] - a[1], b[2] - a[2]);
+        glm::vec3 e2(c[0] - a[0], c[1] - a[1], c[2] - a[2]);
+        float t;
+        if (intersectTriangle(v0, e1, e2, origin, direction, t) && t < hit.t) {
+            hit.t = t;
+            hit.triangle = tri;
+        }
+    }
+    return hit;
+}
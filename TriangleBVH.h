@@ -0,0 +1,69 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+
+using namespace std;
+
+// Zásah paprsku (t v jednotkách směru paprsku)
+struct RayHit {
+    float t;
+    int triangle;            // index trojúhelníku v modelu, -1 = nic
+};
+
+// BVH nad trojúhelníky modelu pro výběr myší.
+// Stavba binovaným SAH, sourozenci leží v poli vedle sebe (levý = first,
+// pravý = first + 1) a uzel má 32 B. Trojúhelníky listů jsou přeskládané
+// do paketů po 4 (SoA), paprsek se testuje proti celému paketu najednou (SSE).
+class TriangleBVH {
+public:
+    struct Node {
+        float minimum[3];
+        unsigned int first;  // vnitřní uzel: levý potomek, list: první paket
+        float maximum[3];
+        unsigned int count;  // 0 = vnitřní uzel, jinak počet paketů listu
+    };
+
+    // Čtyři trojúhelníky jako v0 + hrany e1, e2 po složkách; prázdné místo má nulové hrany
+    struct alignas(16) TrianglePacket {
+        float v0[3][4];
+        float e1[3][4];
+        float e2[3][4];
+        int ids[4];
+    };
+private:
+    static const int BINS = 12;
+    static const int LEAF_SIZE = 4;          // tolik a méně trojúhelníků je vždy list
+    static const int MAX_LEAF_SIZE = 16;     // list větší než jeden paket, pokud se dělení nevyplatí
+    static const int STACK_SIZE = 64;
+
+    struct BuildTriangle {
+        glm::vec3 minimum;
+        glm::vec3 maximum;
+        glm::vec3 centroid;
+    };
+
+    vector<Node> nodes;
+    vector<TrianglePacket> packets;
+    int triangleCount;
+    double buildMs;
+
+    void build(const float* vertices, int stride, vector<BuildTriangle>& triangles, vector<int>& order,
+        unsigned int nodeIndex, int begin, int end, int depth);
+    void makeLeaf(const float* vertices, int stride, const vector<int>& order, unsigned int nodeIndex, int begin, int end);
+    static void intersectPacket(const TrianglePacket& packet, const glm::vec3& origin, const glm::vec3& direction,
+        RayHit& hit);
+public:
+    // vertices: pozice na začátku každého vrcholu, stride ve floatech (Model: 6)
+    TriangleBVH(const float* vertices, int vertexCount, int stride);
+
+    // Nejbližší zásah s t v (0, maxT). direction nemusí být normalizovaný.
+    RayHit intersect(const glm::vec3& origin, const glm::vec3& direction, float maxT) const;
+    // Test všech trojúhelníků bez BVH (srovnání a ověření)
+    static RayHit intersectBruteForce(const float* vertices, int vertexCount, int stride,
+        const glm::vec3& origin, const glm::vec3& direction, float maxT);
+
+    int getTriangleCount() const { return triangleCount; }
+    int getNodeCount() const { return static_cast<int>(nodes.size()); }
+    size_t getBytes() const { return nodes.size() * sizeof(Node) + packets.size() * sizeof(TrianglePacket); }
+    double getBuildMs() const { return buildMs; }
+};
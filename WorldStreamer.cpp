@@ -0,0 +1,400 @@
+#include "WorldStreamer.h"
+#include "Scene.h"
+#include "FramePipeline.h"
+#include "Profiler.h"
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <stdio.h>
+
+WorldStreamer::WorldStreamer(float tileSize, float loadRadius, unsigned int seed)
+    : tileSize(tileSize), loadRadius(loadRadius), minDistance(3.0f), seed(seed), uploadBudget(512), threadCount(0),
+    scene(nullptr), sceneId(0), residentTiles(0), residentObjects(0), focus(0.0f), stopping(false),
+    generated(0), evicted(0), generateMsTotal(0.0), lastIntegrateMs(0.0), maxIntegrateMs(0.0) {
+    for (int i = 0; i < MODEL_COUNT; i++) {
+        modelTable[i] = nullptr;
+        shaderTable[i] = nullptr;
+        materialIndices[i] = 0;
+    }
+}
+
+WorldStreamer::~WorldStreamer() {
+    stop();
+    reset();
+}
+
+void WorldStreamer::setModels(Model* treeModel, Model* bushModel, Model* terrainModel, ShaderProgram* shader) {
+    modelTable[MODEL_TREE] = treeModel;
+    modelTable[MODEL_BUSH] = bushModel;
+    modelTable[MODEL_TERRAIN] = terrainModel;
+    setShader(shader);
+}
+
+void WorldStreamer::setShader(ShaderProgram* shader) {
+    // Čte jen integrate() na hlavním vlákně, generátory shader nepotřebují
+    for (int i = 0; i < MODEL_COUNT; i++) {
+        shaderTable[i] = shader;
+    }
+}
+
+void WorldStreamer::setMaterials(unsigned short tree, unsigned short bush, unsigned short terrain) {
+    materialIndices[MODEL_TREE] = tree;
+    materialIndices[MODEL_BUSH] = bush;
+    materialIndices[MODEL_TERRAIN] = terrain;
+}
+
+void WorldStreamer::start(int threads) {
+    if (!workers.empty()) return;
+    if (threads <= 0) {
+        // Generování nemá brát jádra job systému - stačí dvě vlákna
+        int hardware = static_cast<int>(thread::hardware_concurrency());
+        threads = hardware > 2 ? 2 : 1;
+    }
+    threadCount = threads;
+    stopping = false;
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(thread(&WorldStreamer::workerLoop, this));
+    }
+}
+
+void WorldStreamer::stop() {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    workCondition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+long long WorldStreamer::keyOf(int x, int z) {
+    return (static_cast<long long>(x) << 32) | static_cast<unsigned int>(z);
+}
+
+unsigned int WorldStreamer::tileSeed(unsigned int seed, int x, int z) {
+    // Stejná dlaždice má vždy stejný obsah, nezávisle na pořadí generování
+    unsigned int h = seed;
+    h ^= static_cast<unsigned int>(x) * 73856093u;
+    h ^= static_cast<unsigned int>(z) * 19349663u;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+float WorldStreamer::distanceTo(const Tile* tile, const glm::vec3& eye) const {
+    float dx = (tile->x + 0.5f) * tileSize - eye.x;
+    float dz = (tile->z + 0.5f) * tileSize - eye.z;
+    return sqrtf(dx * dx + dz * dz);
+}
+
+void WorldStreamer::workerLoop() {
+    PROFILE_THREAD_NAME("World streaming");
+    while (true) {
+        Tile* tile;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            workCondition.wait(lock, [this]() { return stopping || !requests.empty(); });
+            if (stopping) return;
+
+            // Nejbližší dlaždice ke kameře v okamžiku výběru
+            auto nearest = requests.begin();
+            float nearestDistance = distanceTo(*nearest, focus);
+            for (auto it = requests.begin() + 1; it != requests.end(); ++it) {
+                float distance = distanceTo(*it, focus);
+                if (distance < nearestDistance) {
+                    nearest = it;
+                    nearestDistance = distance;
+                }
+            }
+            tile = *nearest;
+            requests.erase(nearest);
+            tile->state = TILE_GENERATING;
+        }
+
+        generate(tile);
+
+        lock_guard<mutex> lock(queueMutex);
+        if (tile->cancelled) {
+            delete tile;
+            continue;
+        }
+        tile->state = TILE_FINISHED;
+        finished.push_back(tile);
+        generated++;
+        generateMsTotal += tile->generateMs;
+    }
+}
+
+void WorldStreamer::generate(Tile* tile) const {
+    PROFILE_SCOPE("WorldStreamer::generate");
+    double start = FramePipeline::now();
+    mt19937 rng(tileSeed(seed, tile->x, tile->z));
+
+    glm::vec3 origin(tile->x * tileSize, 0.0f, tile->z * tileSize);
+    glm::vec3 up(0.0f, 1.0f, 0.0f);
+
+    // Terén: plain (-1 až 1) roztažený na dlaždici, jako Scale(50, 0.5, 50) ve scéně 7
+    tile->modelIndices.push_back(MODEL_TERRAIN);
+    tile->translations.push_back(origin + glm::vec3(tileSize * 0.5f, -1.0f, tileSize * 0.5f));
+    tile->rotationAxes.push_back(up);
+    tile->rotationAngles.push_back(0.0f);
+    tile->scales.push_back(glm::vec3(tileSize * 0.5f, 0.5f, tileSize * 0.5f));
+
+    // Poisson-disk (Bridson) uvnitř dlaždice zmenšené o polovinu minDistance z každé
+    // strany - body sousedních dlaždic jsou pak od sebe aspoň minDistance bez
+    // znalosti sousedů, takže dlaždice jdou generovat nezávisle a paralelně.
+    float margin = minDistance * 0.5f;
+    float extent = tileSize - 2.0f * margin;
+    float cellSize = minDistance / sqrtf(2.0f);
+    int gridSize = static_cast<int>(ceilf(extent / cellSize));
+    vector<int> grid(gridSize * gridSize, -1);
+    vector<glm::vec2> points;
+    vector<int> active;
+
+    auto random01 = [&rng]() { return (rng() % 100000) / 100000.0f; };
+    auto cellOf = [cellSize, gridSize](float v) {
+        int c = static_cast<int>(v / cellSize);
+        return c < gridSize ? c : gridSize - 1;
+    };
+    auto accept = [&](const glm::vec2& p) {
+        int cx = cellOf(p.x);
+        int cy = cellOf(p.y);
+        grid[cy * gridSize + cx] = static_cast<int>(points.size());
+        active.push_back(static_cast<int>(points.size()));
+        points.push_back(p);
+    };
+
+    accept(glm::vec2(random01() * extent, random01() * extent));
+    while (!active.empty()) {
+        int slot = static_cast<int>(rng() % active.size());
+        glm::vec2 center = points[active[slot]];
+        bool found = false;
+
+        for (int attempt = 0; attempt < POISSON_ATTEMPTS && !found; attempt++) {
+            // Mezikruží minDistance až 2 * minDistance
+            float angle = random01() * 6.2831853f;
+            float radius = minDistance * (1.0f + random01());
+            glm::vec2 candidate(center.x + cosf(angle) * radius, center.y + sinf(angle) * radius);
+            if (candidate.x < 0.0f || candidate.y < 0.0f || candidate.x >= extent || candidate.y >= extent) continue;
+
+            int cx = cellOf(candidate.x);
+            int cy = cellOf(candidate.y);
+            bool free = true;
+            for (int y = max(0, cy - 2); y <= min(gridSize - 1, cy + 2) && free; y++) {
+                for (int x = max(0, cx - 2); x <= min(gridSize - 1, cx + 2); x++) {
+                    int other = grid[y * gridSize + x];
+                    if (other >= 0) {
+                        glm::vec2 d = points[other] - candidate;
+                        if (d.x * d.x + d.y * d.y < minDistance * minDistance) {
+                            free = false;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (free) {
+                accept(candidate);
+                found = true;
+            }
+        }
+
+        if (!found) {
+            active[slot] = active.back();
+            active.pop_back();
+        }
+    }
+
+    // Stromy a keře napůl, rotace kolem Y a velikost jako ve scéně 7
+    for (const auto& p : points) {
+        bool isTree = (rng() & 1) != 0;
+        float rotationY = (rng() % 360) * 3.14159f / 180.0f;
+        float scale = (isTree ? 0.2f : 0.15f) + (rng() % 20) / 100.0f;
+
+        tile->modelIndices.push_back(isTree ? MODEL_TREE : MODEL_BUSH);
+        tile->translations.push_back(origin + glm::vec3(margin + p.x, -0.5f, margin + p.y));
+        tile->rotationAxes.push_back(up);
+        tile->rotationAngles.push_back(rotationY);
+        tile->scales.push_back(glm::vec3(scale));
+    }
+
+    tile->flags.assign(tile->modelIndices.size(), ObjectStorage::FLAG_STATIC | ObjectStorage::FLAG_CASTS_SHADOW);
+    tile->materials.resize(tile->modelIndices.size());
+    for (size_t i = 0; i < tile->modelIndices.size(); i++) {
+        tile->materials[i] = materialIndices[tile->modelIndices[i]];
+    }
+    tile->generateMs = FramePipeline::now() - start;
+}
+
+void WorldStreamer::integrate(Tile* tile) {
+    ObjectStorage& storage = scene->getStorage();
+    size_t first = storage.size();
+    size_t count = tile->modelIndices.size();
+
+    storage.appendBlock(count, tile->modelIndices.data(), modelTable, tile->modelIndices.data(), shaderTable,
+        tile->translations.data(), tile->rotationAxes.data(), tile->rotationAngles.data(),
+        tile->scales.data(), tile->flags.data(), tile->materials.data());
+
+    tile->handles.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        tile->handles.push_back(storage.handleAt(static_cast<unsigned int>(first + i)));
+    }
+
+    // Data generátoru už nejsou potřeba
+    tile->modelIndices = vector<unsigned short>();
+    tile->translations = vector<glm::vec3>();
+    tile->rotationAxes = vector<glm::vec3>();
+    tile->rotationAngles = vector<float>();
+    tile->scales = vector<glm::vec3>();
+    tile->flags = vector<unsigned char>();
+    tile->materials = vector<unsigned short>();
+
+    tile->state = TILE_RESIDENT;
+    residentTiles++;
+    residentObjects += count;
+}
+
+void WorldStreamer::evict(Tile* tile) {
+    // Volá se pod queueMutex (stav rozpracované dlaždice mění generátor)
+    switch (tile->state) {
+    case TILE_QUEUED:
+        requests.erase(find(requests.begin(), requests.end(), tile));
+        delete tile;
+        break;
+    case TILE_GENERATING:
+        tile->cancelled = true;
+        break;
+    case TILE_FINISHED:
+        finished.erase(find(finished.begin(), finished.end(), tile));
+        delete tile;
+        break;
+    case TILE_READY:
+        ready.erase(find(ready.begin(), ready.end(), tile));
+        delete tile;
+        break;
+    case TILE_RESIDENT: {
+        ObjectStorage& storage = scene->getStorage();
+        for (const auto& handle : tile->handles) {
+            storage.destroy(handle);
+        }
+        residentTiles--;
+        residentObjects -= tile->handles.size();
+        evicted++;
+        delete tile;
+        break;
+    }
+    }
+}
+
+void WorldStreamer::reset() {
+    // Objekty předchozí scény zanikly s ní, zahazují se jen záznamy dlaždic
+    lock_guard<mutex> lock(queueMutex);
+    for (auto& entry : tiles) {
+        Tile* tile = entry.second;
+        if (tile->state == TILE_GENERATING) tile->cancelled = true;
+        else delete tile;
+    }
+    tiles.clear();
+    requests.clear();
+    finished.clear();
+    ready.clear();
+    residentTiles = 0;
+    residentObjects = 0;
+}
+
+void WorldStreamer::update(Scene* target, const glm::vec3& eye) {
+    PROFILE_SCOPE("WorldStreamer::update");
+    if (target->getId() != sceneId) {
+        reset();
+        scene = target;
+        sceneId = target->getId();
+    }
+
+    int centerX = static_cast<int>(floorf(eye.x / tileSize));
+    int centerZ = static_cast<int>(floorf(eye.z / tileSize));
+    int reach = static_cast<int>(ceilf(loadRadius / tileSize));
+    // Hystereze - dlaždice na hranici se nenačítají a neodebírají každý snímek
+    float evictRadius = loadRadius + tileSize;
+    bool removed = false;
+    bool requested = false;
+
+    {
+        lock_guard<mutex> lock(queueMutex);
+        focus = eye;
+
+        for (auto it = tiles.begin(); it != tiles.end();) {
+            if (distanceTo(it->second, eye) > evictRadius) {
+                removed = removed || it->second->state == TILE_RESIDENT;
+                evict(it->second);
+                it = tiles.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        for (int z = centerZ - reach; z <= centerZ + reach; z++) {
+            for (int x = centerX - reach; x <= centerX + reach; x++) {
+                long long key = keyOf(x, z);
+                if (tiles.find(key) != tiles.end()) continue;
+
+                Tile* tile = new Tile();
+                tile->x = x;
+                tile->z = z;
+                if (distanceTo(tile, eye) > loadRadius) {
+                    delete tile;
+                    continue;
+                }
+                tile->state = TILE_QUEUED;
+                tile->cancelled = false;
+                tile->generateMs = 0.0;
+                tiles[key] = tile;
+                requests.push_back(tile);
+                requested = true;
+            }
+        }
+
+        for (auto tile : finished) {
+            tile->state = TILE_READY;
+            ready.push_back(tile);
+        }
+        finished.clear();
+    }
+    if (requested) workCondition.notify_all();
+    if (removed) scene->notifyObjectsRemoved();
+
+    // Vkládání s rozpočtem na snímek, nejbližší dlaždice první.
+    // Aspoň jedna dlaždice za snímek, i když je větší než rozpočet.
+    lastIntegrateMs = 0.0;
+    if (ready.empty()) return;
+
+    double start = FramePipeline::now();
+    sort(ready.begin(), ready.end(), [this, &eye](const Tile* a, const Tile* b) {
+        return distanceTo(a, eye) < distanceTo(b, eye);
+    });
+    int uploaded = 0;
+    size_t taken = 0;
+    while (taken < ready.size()) {
+        int count = static_cast<int>(ready[taken]->modelIndices.size());
+        if (uploaded > 0 && uploaded + count > uploadBudget) break;
+        integrate(ready[taken]);
+        uploaded += count;
+        taken++;
+    }
+    ready.erase(ready.begin(), ready.begin() + taken);
+    scene->notifyObjectsAdded();
+
+    lastIntegrateMs = FramePipeline::now() - start;
+    if (lastIntegrateMs > maxIntegrateMs) maxIntegrateMs = lastIntegrateMs;
+}
+
+void WorldStreamer::printStats() const {
+    lock_guard<mutex> lock(queueMutex);
+    printf("World streaming: %d tiles resident (%zu objects), %zu pending, %d generated on %d threads (avg %.2f ms), %d evicted, integrate max %.2f ms/frame\n",
+        residentTiles, residentObjects, tiles.size() - residentTiles, generated, threadCount,
+        generated > 0 ? generateMsTotal / generated : 0.0, evicted, maxIntegrateMs);
+}
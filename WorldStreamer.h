@@ -0,0 +1,123 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "ObjectStorage.h"
+
+using namespace std;
+
+class Scene;
+class Model;
+class ShaderProgram;
+
+// Neomezený les po čtvercových dlaždicích kolem kamery.
+// Obsah dlaždice (Poisson-disk rozmístění stromů a keřů + kus terénu) generují
+// vlastní vlákna deterministicky ze seedu a souřadnic dlaždice. Hlavní vlákno
+// hotové dlaždice vkládá do scény s rozpočtem objektů na snímek a vzdálené
+// dlaždice odebírá.
+class WorldStreamer {
+private:
+    enum TileState {
+        TILE_QUEUED,         // čeká ve frontě generátoru
+        TILE_GENERATING,
+        TILE_FINISHED,       // vygenerovaná, hlavní vlákno si ji ještě nepřevzalo
+        TILE_READY,          // čeká na vložení (rozpočet snímku)
+        TILE_RESIDENT        // objekty jsou ve scéně
+    };
+
+    struct Tile {
+        int x;
+        int z;
+        TileState state;
+        bool cancelled;      // odebraná během generování, smaže ji generátor
+
+        // Výsledek generátoru ve tvaru pro ObjectStorage::appendBlock
+        vector<unsigned short> modelIndices;
+        vector<glm::vec3> translations;
+        vector<glm::vec3> rotationAxes;
+        vector<float> rotationAngles;
+        vector<glm::vec3> scales;
+        vector<unsigned char> flags;
+        vector<unsigned short> materials;
+        double generateMs;
+
+        vector<ObjectHandle> handles;    // objekty ve scéně (TILE_RESIDENT)
+    };
+
+    // Indexy do tabulky modelů
+    enum TileModel { MODEL_TREE = 0, MODEL_BUSH = 1, MODEL_TERRAIN = 2, MODEL_COUNT = 3 };
+
+    static const int POISSON_ATTEMPTS = 30;
+
+    float tileSize;
+    float loadRadius;            // dlaždice se středem blíž než loadRadius se načítají
+    float minDistance;           // Poisson-disk: nejmenší vzdálenost mezi objekty
+    unsigned int seed;
+    int uploadBudget;            // objektů vložených do scény za snímek
+    int threadCount;
+
+    Model* modelTable[MODEL_COUNT];
+    ShaderProgram* shaderTable[MODEL_COUNT];
+    unsigned short materialIndices[MODEL_COUNT];     // MaterialTable podle druhu modelu
+
+    // Hlavní vlákno
+    Scene* scene;
+    unsigned int sceneId;
+    map<long long, Tile*> tiles;
+    vector<Tile*> ready;
+    int residentTiles;
+    size_t residentObjects;
+
+    // Sdíleno s generátory
+    mutable mutex queueMutex;
+    condition_variable workCondition;
+    deque<Tile*> requests;
+    vector<Tile*> finished;
+    glm::vec3 focus;             // generuje se nejdřív dlaždice nejbližší kameře
+    bool stopping;
+    vector<thread> workers;
+
+    // Statistiky
+    int generated;
+    int evicted;
+    double generateMsTotal;
+    double lastIntegrateMs;
+    double maxIntegrateMs;
+
+    static long long keyOf(int x, int z);
+    static unsigned int tileSeed(unsigned int seed, int x, int z);
+    float distanceTo(const Tile* tile, const glm::vec3& eye) const;
+
+    void workerLoop();
+    void generate(Tile* tile) const;
+    void integrate(Tile* tile);
+    void evict(Tile* tile);
+    void reset();
+public:
+    WorldStreamer(float tileSize = 32.0f, float loadRadius = 96.0f, unsigned int seed = 42);
+    ~WorldStreamer();
+
+    // Stejný shader pro stromy, keře i terén (jako scéna 7)
+    void setModels(Model* treeModel, Model* bushModel, Model* terrainModel, ShaderProgram* shader);
+    // Hlavní vlákno: shader pro dlaždice vložené od teď (přepnutí F1-F4/G),
+    // objekty už ve scéně přepne volající
+    void setShader(ShaderProgram* shader);
+    // Před start(), generátory je jen čtou
+    void setMaterials(unsigned short tree, unsigned short bush, unsigned short terrain);
+    void setUploadBudget(int objects) { uploadBudget = objects; }
+    // threads = 0 podle počtu jader
+    void start(int threads = 0);
+    void stop();
+
+    // Hlavní vlákno každý snímek: dlaždice kolem eye. Jiná scéna než minule
+    // (přepnutí po uvolnění a novém sestavení) začíná od prázdného světa.
+    void update(Scene* target, const glm::vec3& eye);
+    // Některé dlaždice v dosahu ještě nejsou ve scéně
+    bool hasPendingWork() const { return tiles.size() > static_cast<size_t>(residentTiles); }
+
+    void printStats() const;
+};
@@ -0,0 +1,381 @@
+// Mikrobenchmarky CPU části (Google Benchmark), samostatný cíl bez main.cpp.
+//
+// Překlad z kořene repozitáře, např.:
+//   g++ -O2 -std=c++17 -I. benchmarks/micro_benchmarks.cpp Transform.cpp Rotation.cpp Scale.cpp
+//       Translation.cpp Camera.cpp Scene.cpp DrawableObject.cpp MatrixBatch.cpp JobSystem.cpp
+//       SceneGenerator.cpp ObjectStorage.cpp Model.cpp Profiler.cpp RenderStats.cpp
+//       SceneFile.cpp ResourceManager.cpp ShaderProgram.cpp TriangleBVH.cpp FramePipeline.cpp
+//       SoftwareRasterizer.cpp MaterialTable.cpp
+//       -lbenchmark -lglfw -lGLEW -lGL -pthread -o micro_benchmarks
+//
+// Velikosti scén 1k/10k/100k/1M, les se generuje vždy se seedem 42.
+// BM_SceneTraversalLegacy (Transform strom na objekt) vs. BM_SceneTraversalDense
+// a BM_SceneTraversalCached (ObjectStorage) porovnává rozložení dat při 1M objektech.
+#include <benchmark/benchmark.h>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "Transform.h"
+#include "Translation.h"
+#include "Rotation.h"
+#include "Scale.h"
+#include "Camera.h"
+#include "Scene.h"
+#include "DrawableObject.h"
+#include "MatrixBatch.h"
+#include "SceneGenerator.h"
+#include "Model.h"
+#include "SceneFile.h"
+#include "ResourceManager.h"
+#include "TriangleBVH.h"
+#include "SoftwareRasterizer.h"
+#include "JobSystem.h"
+#include "sphere.h"
+#include "tree.h"
+#include <random>
+#include <cmath>
+
+static const unsigned int FOREST_SEED = 42;
+
+static void addSceneSizes(benchmark::internal::Benchmark* b) {
+    b->Arg(1000)->Arg(10000)->Arg(100000)->Arg(1000000);
+    b->Unit(benchmark::kMicrosecond);
+}
+
+// Transform::getMatrix
+
+static void BM_TransformFlat(benchmark::State& state) {
+    // Jako objekt ve scéně 7: posun, rotace, měřítko
+    Transform t;
+    t.addTransform(new Translation(1.0f, -0.5f, 2.0f));
+    t.addTransform(new Rotation(0.7f, glm::vec3(0.0f, 1.0f, 0.0f)));
+    t.addTransform(new Scale(0.3f));
+
+    for (auto _ : state) {
+        glm::mat4 m = t.getMatrix();
+        benchmark::DoNotOptimize(m);
+    }
+}
+BENCHMARK(BM_TransformFlat);
+
+static void BM_TransformNested(benchmark::State& state) {
+    // Řetěz hloubky range(0), v každé úrovni TRS + další Transform
+    Transform root;
+    Transform* level = &root;
+    for (int d = 0; d < state.range(0); d++) {
+        level->addTransform(new Translation(0.1f, 0.0f, 0.0f));
+        level->addTransform(new Rotation(0.1f, glm::vec3(0.0f, 1.0f, 0.0f)));
+        level->addTransform(new Scale(0.99f));
+        Transform* child = new Transform();
+        level->addTransform(child);
+        level = child;
+    }
+
+    for (auto _ : state) {
+        glm::mat4 m = root.getMatrix();
+        benchmark::DoNotOptimize(m);
+    }
+}
+BENCHMARK(BM_TransformNested)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
+// Camera
+
+static void BM_CameraMove(benchmark::State& state) {
+    Camera camera;
+    int i = 0;
+    for (auto _ : state) {
+        if (i++ & 1) camera.moveForward(0.016f);
+        else camera.moveLeft(0.016f);
+        benchmark::DoNotOptimize(camera.getViewMatrix());
+    }
+}
+BENCHMARK(BM_CameraMove);
+
+static void BM_CameraRotate(benchmark::State& state) {
+    Camera camera;
+    float direction = 1.0f;
+    for (auto _ : state) {
+        camera.rotate(direction * 3.0f, direction * 1.5f);
+        direction = -direction;
+        benchmark::DoNotOptimize(camera.getViewMatrix());
+    }
+}
+BENCHMARK(BM_CameraRotate);
+
+static void BM_CameraUpdateViewMatrix(benchmark::State& state) {
+    // updateViewMatrix je privátní - pohyb s nulovým krokem ho jen přepočítá
+    Camera camera;
+    for (auto _ : state) {
+        camera.moveForward(0.0f);
+        benchmark::DoNotOptimize(camera.getViewMatrix());
+    }
+}
+BENCHMARK(BM_CameraUpdateViewMatrix);
+
+// Scéna
+
+// Les s původním rozložením: každý objekt má vlastní Transform strom na haldě
+struct LegacyForest {
+    Scene* scene;
+    vector<Transform*> transforms;
+
+    LegacyForest(int objectCount) : scene(new Scene("Legacy forest")) {
+        // Stejná sekvence jako SceneGenerator::generateForest
+        mt19937 rng(FOREST_SEED);
+        float extent = 20.0f * sqrtf(objectCount / 100.0f);
+        if (extent < 20.0f) extent = 20.0f;
+        unsigned int steps = static_cast<unsigned int>(extent * 200.0f);
+
+        for (int i = 0; i < objectCount; i++) {
+            float posX = (rng() % steps) / 100.0f - extent;
+            float posZ = (rng() % steps) / 100.0f - extent;
+            float rotationY = (rng() % 360) * 3.14159f / 180.0f;
+            float scale = (i < objectCount / 2 ? 0.2f : 0.15f) + (rng() % 20) / 100.0f;
+
+            Transform* t = new Transform();
+            t->addTransform(new Translation(posX, -0.5f, posZ));
+            t->addTransform(new Rotation(rotationY, glm::vec3(0.0f, 1.0f, 0.0f)));
+            t->addTransform(new Scale(scale));
+            transforms.push_back(t);
+            scene->addObject(new DrawableObject(nullptr, nullptr, t));
+        }
+    }
+    ~LegacyForest() {
+        delete scene;
+        for (auto t : transforms) delete t;
+    }
+};
+
+static void BM_SceneGenerate(benchmark::State& state) {
+    for (auto _ : state) {
+        Scene* forest = SceneGenerator::generateForest("Forest", static_cast<int>(state.range(0)), FOREST_SEED,
+            nullptr, nullptr, nullptr, nullptr);
+        benchmark::DoNotOptimize(forest);
+        delete forest;
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SceneGenerate)->Apply(addSceneSizes)->Unit(benchmark::kMillisecond);
+
+static void BM_SceneTraversalLegacy(benchmark::State& state) {
+    // Původní rozložení: model matice přes Transform strom každého objektu
+    LegacyForest forest(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        float sum = 0.0f;
+        for (const auto& drawable : forest.scene->getObjects()) {
+            sum += drawable->getModelMatrix()[3][0];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SceneTraversalLegacy)->Apply(addSceneSizes);
+
+static void BM_SceneTraversalDense(benchmark::State& state) {
+    // Stejný výpočet z hustých TRS polí ObjectStorage
+    Scene* forest = SceneGenerator::generateForest("Forest", static_cast<int>(state.range(0)), FOREST_SEED,
+        nullptr, nullptr, nullptr, nullptr);
+    const ObjectStorage& storage = forest->getStorage();
+    unsigned int count = static_cast<unsigned int>(storage.size());
+
+    for (auto _ : state) {
+        float sum = 0.0f;
+        for (unsigned int i = 0; i < count; i++) {
+            sum += storage.computeLocalMatrix(i)[3][0];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    delete forest;
+}
+BENCHMARK(BM_SceneTraversalDense)->Apply(addSceneSizes);
+
+static void BM_SceneTraversalCached(benchmark::State& state) {
+    // Statická scéna: world matice jsou spočítané, jen se čtou
+    Scene* forest = SceneGenerator::generateForest("Forest", static_cast<int>(state.range(0)), FOREST_SEED,
+        nullptr, nullptr, nullptr, nullptr);
+    forest->getStorage().updateWorldMatrices();
+    const vector<glm::mat4>& worldMatrices = forest->getStorage().getWorldMatrices();
+
+    for (auto _ : state) {
+        float sum = 0.0f;
+        for (const auto& m : worldMatrices) {
+            sum += m[3][0];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    delete forest;
+}
+BENCHMARK(BM_SceneTraversalCached)->Apply(addSceneSizes);
+
+static void BM_SceneMatrixBatch(benchmark::State& state) {
+    // Update snímku na CPU: model, MVP a normálové matice (jedno vlákno)
+    Scene* forest = SceneGenerator::generateForest("Forest", static_cast<int>(state.range(0)), FOREST_SEED,
+        nullptr, nullptr, nullptr, nullptr);
+    forest->getStorage().updateWorldMatrices();
+    glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 4.0f / 3.0f, 0.1f, 100.0f) *
+        glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    MatrixBatch batch;
+
+    for (auto _ : state) {
+        batch.compute(forest->getStorage(), viewProjection);
+        benchmark::DoNotOptimize(batch.get(0));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    delete forest;
+}
+BENCHMARK(BM_SceneMatrixBatch)->Apply(addSceneSizes);
+
+static void BM_SceneFileLoad(benchmark::State& state) {
+    // Načtení binární scény (mmap + kopie polí), cíl pro 1M objektů je pod 100 ms
+    ResourceManager resources;
+    Scene* forest = SceneGenerator::generateForest("Forest", static_cast<int>(state.range(0)), FOREST_SEED,
+        nullptr, nullptr, nullptr, nullptr);
+    const char* path = "bm_forest.zpgs";
+    bool saved = SceneFile::save(*forest, resources, path);
+    delete forest;
+    if (!saved) {
+        state.SkipWithError("Unable to write scene file");
+        return;
+    }
+
+    for (auto _ : state) {
+        Scene* loaded = SceneFile::load(path, resources);
+        benchmark::DoNotOptimize(loaded);
+        state.PauseTiming();
+        delete loaded;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    remove(path);
+}
+BENCHMARK(BM_SceneFileLoad)->Apply(addSceneSizes)->Unit(benchmark::kMillisecond);
+
+// Výběr myší - paprsky z koule kolem modelu tree (~15k trojúhelníků) ke středu
+
+static const int TREE_VERTICES = 92814 / 6;
+
+static void makePickRays(vector<glm::vec3>& origins, vector<glm::vec3>& directions) {
+    mt19937 rng(FOREST_SEED);
+    for (int i = 0; i < 256; i++) {
+        float yaw = (rng() % 3600) / 3600.0f * 6.2831853f;
+        float height = (rng() % 2000) / 1000.0f - 1.0f;
+        glm::vec3 origin(cosf(yaw) * 5.0f, height * 3.0f, sinf(yaw) * 5.0f);
+        glm::vec3 target((rng() % 200) / 100.0f - 1.0f, (rng() % 400) / 100.0f - 1.0f, (rng() % 200) / 100.0f - 1.0f);
+        origins.push_back(origin);
+        directions.push_back(target - origin);
+    }
+}
+
+static void BM_PickTreeBruteForce(benchmark::State& state) {
+    vector<glm::vec3> origins, directions;
+    makePickRays(origins, directions);
+    size_t i = 0;
+    for (auto _ : state) {
+        RayHit hit = TriangleBVH::intersectBruteForce((float*)tree, TREE_VERTICES, 6, origins[i & 255], directions[i & 255], 1e30f);
+        benchmark::DoNotOptimize(hit);
+        i++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PickTreeBruteForce)->Unit(benchmark::kMicrosecond);
+
+static void BM_PickTreeBVH(benchmark::State& state) {
+    TriangleBVH bvh((float*)tree, TREE_VERTICES, 6);
+    vector<glm::vec3> origins, directions;
+    makePickRays(origins, directions);
+    size_t i = 0;
+    for (auto _ : state) {
+        RayHit hit = bvh.intersect(origins[i & 255], directions[i & 255], 1e30f);
+        benchmark::DoNotOptimize(hit);
+        i++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PickTreeBVH)->Unit(benchmark::kMicrosecond);
+
+static void BM_TreeBVHBuild(benchmark::State& state) {
+    for (auto _ : state) {
+        TriangleBVH bvh((float*)tree, TREE_VERTICES, 6);
+        benchmark::DoNotOptimize(bvh.getNodeCount());
+    }
+}
+BENCHMARK(BM_TreeBVHBuild)->Unit(benchmark::kMillisecond);
+
+// Softwarový rasterizér - mřížka 7x7 stromů v 800x600, argument = počet vláken
+static void BM_SoftwareRasterForest(benchmark::State& state) {
+    JobSystem jobs((int)state.range(0) - 1);
+    SoftwareRasterizer rasterizer(&jobs);
+    rasterizer.resize(800, 600);
+
+    glm::vec3 cameraPosition(0.0f, 3.0f, 12.0f);
+    glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 800.0f / 600.0f, 0.1f, 100.0f) *
+        glm::lookAt(cameraPosition, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    vector<SoftwareDraw> draws;
+    for (int z = -3; z <= 3; z++) {
+        for (int x = -3; x <= 3; x++) {
+            SoftwareDraw draw;
+            draw.vertices = (const float*)tree;
+            draw.vertexCount = TREE_VERTICES;
+            draw.matrices.model = glm::translate(glm::mat4(1.0f), glm::vec3(x * 3.0f, 0.0f, z * 3.0f));
+            draw.matrices.mvp = viewProjection * draw.matrices.model;
+            draw.matrices.normal = glm::mat3(1.0f);
+            draw.shading = SOFTWARE_PHONG;
+            draw.material = MaterialTable::DEFAULT_MATERIAL;
+            draws.push_back(draw);
+        }
+    }
+
+    for (auto _ : state) {
+        rasterizer.render(draws, glm::vec3(0.0f, 10.0f, 0.0f), cameraPosition);
+        benchmark::DoNotOptimize(rasterizer.getColorBuffer().data());
+    }
+    state.SetItemsProcessed(state.iterations() * (long long)draws.size() * (TREE_VERTICES / 3));
+}
+BENCHMARK(BM_SoftwareRasterForest)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond);
+
+// Model - potřebuje GL kontext, použije se skryté okno
+
+static GLFWwindow* createHiddenContext() {
+    static GLFWwindow* window = nullptr;
+    static bool attempted = false;
+    if (attempted) return window;
+    attempted = true;
+
+    if (!glfwInit()) return nullptr;
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    window = glfwCreateWindow(64, 64, "micro_benchmarks", NULL, NULL);
+    if (!window) return nullptr;
+    glfwMakeContextCurrent(window);
+
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK) {
+        glfwDestroyWindow(window);
+        window = nullptr;
+    }
+    return window;
+}
+
+static void BM_ModelConstruction(benchmark::State& state, float* vertices, int numberOfFloats) {
+    if (!createHiddenContext()) {
+        state.SkipWithError("OpenGL context not available");
+        return;
+    }
+
+    for (auto _ : state) {
+        Model* model = new Model(vertices, numberOfFloats);
+        benchmark::DoNotOptimize(model);
+        delete model;
+    }
+    glFinish();
+    state.SetBytesProcessed(state.iterations() * numberOfFloats * sizeof(float));
+}
+BENCHMARK_CAPTURE(BM_ModelConstruction, sphere, (float*)sphere, 17280);
+BENCHMARK_CAPTURE(BM_ModelConstruction, tree, (float*)tree, 92814);
+
+BENCHMARK_MAIN();
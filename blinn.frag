@@ -6,11 +6,14 @@ in vec3 worldNormal;
 uniform vec3 lightPosition;
 uniform vec3 cameraPosition;
 
+// Materiály (materials, materialIndex) a shadowFactor() vkládá ShaderProgram
+
 out vec4 fragColor;
 
 void main() {
-    vec4 objectColor = vec4(0.385, 0.647, 0.812, 1.0);
-    vec4 ambient = vec4(0.1, 0.1, 0.1, 1.0);
+    Material material = materials[materialIndex];
+    vec4 objectColor = material.diffuse;
+    vec4 ambient = material.ambient;
     
     // Diffuse
     vec3 norm = normalize(worldNormal);
@@ -21,8 +24,9 @@ void main() {
     // Blinn-Phong specular
     vec3 viewDir = normalize(cameraPosition - worldPosition);
     vec3 halfDir = normalize(lightDir + viewDir);
-    float spec = pow(max(dot(norm, halfDir), 0.0), 32.0);
-    vec4 specular = spec * vec4(1.0, 1.0, 1.0, 1.0);
+    float spec = pow(max(dot(norm, halfDir), 0.0), material.specular.w);
+    vec4 specular = spec * vec4(material.specular.rgb, 1.0);
     
-    fragColor = ambient + diffuse + specular;
+    float shadow = shadowFactor(worldPosition, lightPosition);
+    fragColor = ambient + shadow * (diffuse + specular);
 }
\ No newline at end of file
@@ -3,8 +3,10 @@
 in vec3 worldPosition;
 in vec3 worldNormal;
 
+// Materiály (materials, materialIndex) vkládá ShaderProgram
+
 out vec4 fragColor;
 
 void main() {
-    fragColor = vec4(0.385, 0.647, 0.812, 1.0);
+    fragColor = materials[materialIndex].diffuse;
 }
\ No newline at end of file
@@ -0,0 +1,5 @@
+#version 330
+
+// Jen hloubka, barva se nezapisuje (glColorMask)
+void main() {
+}
@@ -0,0 +1,12 @@
+#version 330
+
+layout(location=0) in vec3 vp;
+
+// Stejný výpočet jako phong.vert - hloubka musí sedět bit po bitu (GL_EQUAL)
+uniform mat4 mvpMatrix;
+
+invariant gl_Position;
+
+void main() {
+    gl_Position = mvpMatrix * vec4(vp, 1.0);
+}
@@ -5,14 +5,17 @@ in vec3 worldNormal;
 
 uniform vec3 lightPosition;
 
+// Materiály (materials, materialIndex) a shadowFactor() vkládá ShaderProgram
+
 out vec4 fragColor;
 
 void main() {
     // Object color
-    vec4 objectColor = vec4(0.385, 0.647, 0.812, 1.0);
+    Material material = materials[materialIndex];
+    vec4 objectColor = material.diffuse;
     
     // Ambient
-    vec4 ambient = vec4(0.1, 0.1, 0.1, 1.0);
+    vec4 ambient = material.ambient;
     
     // Diffuse (Lambert)
     vec3 norm = normalize(worldNormal);
@@ -21,5 +24,6 @@ void main() {
     vec4 diffuse = diff * objectColor;
     
     // I = Ia + Id
-    fragColor = ambient + diffuse;
+    float shadow = shadowFactor(worldPosition, lightPosition);
+    fragColor = ambient + shadow * diffuse;
 }
\ No newline at end of file
@@ -1,11 +1,162 @@
 ﻿#include "Application.h"
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
 
-int main() {
+int main(int argc, char** argv) {
     Application* app = new Application();
+
+    // --frames-in-flight N (0 = bez render vlákna)
+    // --job-threads N (celkový počet vláken job systému)
+    // --job-scaling [objekty] (jen měření, bez okna)
+    // --stats-csv soubor.csv (čítače každého snímku)
+    // --vram-budget MB (rozpočet VRAM pro modely, nejdéle nekreslené se vyhazují)
+    // --continuous (kreslí každý snímek, i když se nic nezměnilo)
+    // --scene-budget MB (paměť sestavených scén, nejdéle nepoužité se uvolňují)
+    // --scene-dir adresář (scény sceneN.zpgs místo sestavení v kódu)
+    // --export-scenes adresář [--forest N] (zapíše scény do .zpgs a skončí)
+    // --stream-world (scéna 7 jako neomezený les po dlaždicích kolem kamery)
+    // --depth-prepass off|on|auto (hloubkový předprůchod, auto podle změřeného overdraw)
+    // --dynamic-resolution ms [--resolution-scale min:max] (offscreen rozlišení podle GPU času snímku)
+    // --impostor-distance D (vegetace dál než D jako impostor, 0 = vypnuto)
+    // --capture soubor.y4m|soubor.raw|prefix [--capture-fps N] (záznam snímků přes PBO, PNG pro ostatní přípony)
+    // --views N (2-4 pohledy v jednom průchodu, split-screen)
+    // --max-queued-frames N (snímky ve frontě ovladače, 0 = bez omezení)
+    // --benchmark [--warmup N] [--frames M] [--output soubor.json] [--context osmesa|egl|native] [--size WxH] [--trace soubor.json]
+    //     [--backend gl|software] [--scenes 6,7 (čísla kláves scén)] [--image prefix (software: snímky scén do .ppm)]
+    bool benchmark = false;
+    const char* exportDirectory = nullptr;
+    int exportForest = 0;
+    BenchmarkSettings benchmarkSettings;
+    const char* capturePath = nullptr;
+    int captureFps = 60;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc) {
+            app->setFramesInFlight(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--job-threads") == 0 && i + 1 < argc) {
+            app->setJobThreads(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--job-scaling") == 0) {
+            int objectCount = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            app->runJobScaling(objectCount > 0 ? objectCount : 100000);
+            delete app;
+            return 0;
+        }
+        else if (strcmp(argv[i], "--stats-csv") == 0 && i + 1 < argc) {
+            app->setStatsCsv(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--vram-budget") == 0 && i + 1 < argc) {
+            app->setVramBudget(static_cast<size_t>(atoi(argv[++i])));
+        }
+        else if (strcmp(argv[i], "--scene-budget") == 0 && i + 1 < argc) {
+            app->setSceneBudget(static_cast<size_t>(atoi(argv[++i])));
+        }
+        else if (strcmp(argv[i], "--scene-dir") == 0 && i + 1 < argc) {
+            app->setSceneDirectory(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--export-scenes") == 0 && i + 1 < argc) {
+            exportDirectory = argv[++i];
+        }
+        else if (strcmp(argv[i], "--forest") == 0 && i + 1 < argc) {
+            exportForest = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--stream-world") == 0) {
+            app->setWorldStreaming(true);
+        }
+        else if (strcmp(argv[i], "--depth-prepass") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            app->setDepthPrepassMode(strcmp(mode, "on") == 0 ? PREPASS_ON : strcmp(mode, "off") == 0 ? PREPASS_OFF : PREPASS_AUTO);
+        }
+        else if (strcmp(argv[i], "--dynamic-resolution") == 0 && i + 1 < argc) {
+            app->setDynamicResolution(atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--resolution-scale") == 0 && i + 1 < argc) {
+            float minScale = 0.5f, maxScale = 1.0f;
+            sscanf(argv[++i], "%f:%f", &minScale, &maxScale);
+            app->setResolutionScale(minScale, maxScale);
+        }
+        else if (strcmp(argv[i], "--impostor-distance") == 0 && i + 1 < argc) {
+            app->setImpostorDistance(static_cast<float>(atof(argv[++i])));
+        }
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            capturePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--capture-fps") == 0 && i + 1 < argc) {
+            captureFps = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--views") == 0 && i + 1 < argc) {
+            app->setViewCount(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--max-queued-frames") == 0 && i + 1 < argc) {
+            app->setMaxQueuedFrames(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--continuous") == 0) {
+            app->setOnDemandRendering(false);
+        }
+        else if (strcmp(argv[i], "--benchmark") == 0) {
+            benchmark = true;
+        }
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            benchmarkSettings.warmupFrames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            benchmarkSettings.measuredFrames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            benchmarkSettings.outputPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--context") == 0 && i + 1 < argc) {
+            benchmarkSettings.contextApi = argv[++i];
+        }
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            sscanf(argv[++i], "%dx%d", &benchmarkSettings.width, &benchmarkSettings.height);
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            benchmarkSettings.tracePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc) {
+            benchmarkSettings.backend = argv[++i];
+        }
+        else if (strcmp(argv[i], "--scenes") == 0 && i + 1 < argc) {
+            // Klávesy 1-8 = indexy 0-7
+            for (const char* p = argv[++i]; *p; ) {
+                int key = static_cast<int>(strtol(p, const_cast<char**>(&p), 10));
+                if (key > 0) benchmarkSettings.scenes.push_back(key - 1);
+                if (*p == ',') p++;
+                else if (*p) break;
+            }
+        }
+        else if (strcmp(argv[i], "--image") == 0 && i + 1 < argc) {
+            benchmarkSettings.imagePrefix = argv[++i];
+        }
+    }
+
+    if (capturePath) {
+        app->setCapture(capturePath, captureFps);
+    }
+
+    if (benchmark) {
+        app->setBenchmark(benchmarkSettings);
+        app->initialization();
+        app->createShaders();
+        app->createModels();
+        app->createScenes();
+        int result = app->runBenchmark();
+
+        delete app;
+        return result;
+    }
+
     app->initialization();
     app->createShaders();
     app->createModels();
     app->createScenes();
+    if (exportDirectory) {
+        int result = app->exportScenes(exportDirectory, exportForest);
+        delete app;
+        return result;
+    }
     app->run();
 
     delete app;
@@ -0,0 +1,46 @@
+#version 330
+
+layout(location=0) in vec3 vp;
+layout(location=1) in vec3 vn;
+
+// Všechny pohledy v jednom průchodu: instance = index pohledu
+const int MAX_VIEWS = 4;
+
+uniform mat4 modelMatrix;
+uniform mat3 normalMatrix;
+uniform mat4 viewProjections[MAX_VIEWS];
+uniform vec4 viewRects[MAX_VIEWS];   // měřítko a posun v NDC (sx, sy, ox, oy)
+uniform int viewMask;                // bit = objekt je v daném pohledu vidět
+
+out vec3 worldPosition;
+out vec3 worldNormal;
+
+void main() {
+    int view = gl_InstanceID;
+    vec4 wp = modelMatrix * vec4(vp, 1.0);
+    worldPosition = wp.xyz / wp.w;
+    worldNormal = normalMatrix * vn;
+
+    if (((viewMask >> view) & 1) == 0) {
+        // Mimo frustum pohledu - trojúhelník se celý ořízne
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        gl_ClipDistance[0] = -1.0;
+        gl_ClipDistance[1] = -1.0;
+        gl_ClipDistance[2] = -1.0;
+        gl_ClipDistance[3] = -1.0;
+        return;
+    }
+
+    vec4 clip = viewProjections[view] * wp;
+
+    // Ořez na okraje pohledu (jinak by trojúhelníky přesahovaly do sousedních)
+    gl_ClipDistance[0] = clip.w + clip.x;
+    gl_ClipDistance[1] = clip.w - clip.x;
+    gl_ClipDistance[2] = clip.w + clip.y;
+    gl_ClipDistance[3] = clip.w - clip.y;
+
+    // Přesun do obdélníku pohledu na obrazovce
+    vec4 rect = viewRects[view];
+    clip.xy = clip.xy * rect.xy + rect.zw * clip.w;
+    gl_Position = clip;
+}
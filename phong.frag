@@ -6,14 +6,17 @@ in vec3 worldNormal;
 uniform vec3 lightPosition;
 uniform vec3 cameraPosition;
 
+// Materiály (materials, materialIndex) a shadowFactor() vkládá ShaderProgram
+
 out vec4 fragColor;
 
 void main() {
     // Object color
-    vec4 objectColor = vec4(0.385, 0.647, 0.812, 1.0);
+    Material material = materials[materialIndex];
+    vec4 objectColor = material.diffuse;
     
     // Ambient
-    vec4 ambient = vec4(0.1, 0.1, 0.1, 1.0);
+    vec4 ambient = material.ambient;
     
     // Diffuse (Lambert)
     vec3 norm = normalize(worldNormal);
@@ -24,9 +27,10 @@ void main() {
     // Specular (Phong)
     vec3 viewDir = normalize(cameraPosition - worldPosition);
     vec3 reflectDir = reflect(-lightDir, norm);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
-    vec4 specular = spec * vec4(1.0, 1.0, 1.0, 1.0);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.specular.w);
+    vec4 specular = spec * vec4(material.specular.rgb, 1.0);
     
     // I = Ia + Id + Is
-    fragColor = ambient + diffuse + specular;
+    float shadow = shadowFactor(worldPosition, lightPosition);
+    fragColor = ambient + shadow * (diffuse + specular);
 }
\ No newline at end of file
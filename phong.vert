@@ -3,17 +3,20 @@
 layout(location=0) in vec3 vp;
 layout(location=1) in vec3 vn;
 
+// Předpočítané na CPU (MatrixBatch)
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
+uniform mat4 mvpMatrix;
+uniform mat3 normalMatrix;
 
 out vec3 worldPosition;
 out vec3 worldNormal;
+// Stejná hloubka jako v hloubkovém předprůchodu (GL_EQUAL)
+invariant gl_Position;
 
 void main() {
     vec4 wp = modelMatrix * vec4(vp, 1.0);
     worldPosition = wp.xyz / wp.w;
-    worldNormal = mat3(transpose(inverse(modelMatrix))) * vn;
+    worldNormal = normalMatrix * vn;
     
-    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vp, 1.0);
+    gl_Position = mvpMatrix * vec4(vp, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,11 @@
+#version 330
+
+in vec3 worldPosition;
+
+uniform vec3 lightPosition;
+// shadowFarPlane je ve společných deklaracích (ShaderProgram)
+
+void main() {
+    // Lineární vzdálenost od světla v rozsahu <0,1>
+    gl_FragDepth = length(worldPosition - lightPosition) / shadowFarPlane;
+}
@@ -0,0 +1,15 @@
+#version 330
+
+layout(location=0) in vec3 vp;
+
+uniform mat4 modelMatrix;
+uniform mat4 lightSpaceMatrix;
+
+out vec3 worldPosition;
+
+void main() {
+    vec4 wp = modelMatrix * vec4(vp, 1.0);
+    worldPosition = wp.xyz;
+
+    gl_Position = lightSpaceMatrix * wp;
+}